@@ -0,0 +1,139 @@
+/**
+ * @file acct.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Per-session resource accounting: TSC time slices, sliding
+ * window counters and incrementally maintained top-K sets.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <mutex>
+#include "acct.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Monotonic clock in nanoseconds.
+ */
+static uint64_t acct_clock_ns();
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+uint64_t acct_us(const uint64_t ticks) {
+    /* Variables */
+    static std::once_flag once;
+    static uint64_t tick0;
+    static uint64_t ns0;
+    uint64_t dticks;
+    uint64_t dns;
+    /* Calibration point: the longer ago, the more exact the ratio */
+    std::call_once(once, [] {
+        tick0 = acct_ticks();
+        ns0 = acct_clock_ns();
+    });
+    dticks = acct_ticks() - tick0;
+    dns = acct_clock_ns() - ns0;
+    if ((dticks == 0) || (dns < 1000000)) {
+        return ticks / 1000; /* Not calibrated yet: assume 1 GHz */
+    }
+    return static_cast<uint64_t>((static_cast<double>(ticks) * dns) /
+                                 (static_cast<double>(dticks) * 1000));
+}
+
+void acct_add(struct acct_win *const w, const uint64_t now,
+              const uint64_t cpu, const uint64_t bytes, const uint64_t cmds) {
+    /* Variables */
+    const uint64_t epoch = now / ACCT_WINDOW_MS;
+    /* Roll the windows */
+    if (epoch != w->epoch) {
+        for (size_t k = 0; k < ACCT_KEYS; ++k) {
+            w->prev[k] = (epoch == (w->epoch + 1)) ? w->cur[k] : 0;
+            w->cur[k] = 0;
+        }
+        w->epoch = epoch;
+    }
+    w->cur[ACCT_CPU] += cpu;
+    w->cur[ACCT_BYTES] += bytes;
+    w->cur[ACCT_CMDS] += cmds;
+    w->cpu += cpu;
+}
+
+uint64_t acct_value(const struct acct_win *const w, const enum acct_key key,
+                    const uint64_t now) {
+    /* Variables */
+    const uint64_t epoch = now / ACCT_WINDOW_MS;
+    const uint64_t left = ACCT_WINDOW_MS - (now % ACCT_WINDOW_MS);
+    uint64_t cur;
+    uint64_t prev;
+    /* The window ends now: all of cur, the tail of prev */
+    if (epoch == w->epoch) {
+        cur = w->cur[key];
+        prev = w->prev[key];
+    } else if (epoch == (w->epoch + 1)) {
+        cur = 0;
+        prev = w->cur[key];
+    } else {
+        return 0;
+    }
+    return cur + static_cast<uint64_t>((static_cast<double>(prev) * left) /
+                                       ACCT_WINDOW_MS);
+}
+
+void acct_top_offer(struct acct_top *const t, const enum acct_key key,
+                    void *const owner, const struct acct_win *const w,
+                    const uint64_t now) {
+    /* Variables */
+    uint64_t value;
+    uint64_t min = UINT64_MAX;
+    size_t victim = 0;
+    /* Members are ranked when the set is read */
+    for (size_t i = 0; i < t->n; ++i) {
+        if (t->ents[i].owner == owner) {
+            return;
+        }
+    }
+    if (t->n < ACCT_TOP_K) {
+        t->ents[t->n++] = {.owner = owner, .win = w};
+        return;
+    }
+    /* Full: replace the smallest member if the newcomer beats it */
+    value = acct_value(w, key, now);
+    for (size_t i = 0; (i < t->n) && (min > 0); ++i) {
+        const uint64_t v = acct_value(t->ents[i].win, key, now);
+        if (v < min) {
+            min = v;
+            victim = i;
+        }
+    }
+    if (value > min) {
+        t->ents[victim] = {.owner = owner, .win = w};
+    }
+}
+
+void acct_top_remove(struct acct_top *const t, const void *const owner) {
+    for (size_t i = 0; i < t->n; ++i) {
+        if (t->ents[i].owner == owner) {
+            t->ents[i] = t->ents[--t->n];
+            return;
+        }
+    }
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static uint64_t acct_clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000000000) +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
@@ -0,0 +1,146 @@
+/**
+ * @file acct.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Per-session resource accounting: TSC time slices, sliding
+ * window counters and incrementally maintained top-K sets.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef ACCT_HPP
+#define ACCT_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr uint64_t ACCT_WINDOW_MS = 10000; /**< Sliding window */
+constexpr size_t ACCT_TOP_K = 16; /**< Sessions kept per key and reactor */
+
+/**
+ * @brief Accounted quantities (top-K keys).
+ */
+enum acct_key : uint8_t {
+    ACCT_CPU = 0, /**< Processing time, TSC ticks */
+    ACCT_BYTES, /**< Bytes received and sent */
+    ACCT_CMDS, /**< Commands executed */
+    ACCT_KEYS
+};
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Sliding window counters: the current and the previous window,
+ * the previous one is weighted by the part of it still in the window.
+ */
+struct acct_win {
+    uint64_t epoch = 0; /**< Window of cur (ms / ACCT_WINDOW_MS) */
+    uint64_t cur[ACCT_KEYS] = {}; /**< Current window */
+    uint64_t prev[ACCT_KEYS] = {}; /**< Previous window */
+    uint64_t cpu = 0; /**< Processing time since the start, TSC ticks */
+};
+
+/**
+ * @brief Top-K entry.
+ */
+struct acct_ent {
+    void *owner; /**< Accounted object (session) */
+    const struct acct_win *win; /**< Its counters */
+};
+
+/**
+ * @brief The K objects with the largest windowed value of one key.
+ *
+ * Offered after every update, the values are recomputed when a member
+ * has to be evicted (they decay while the object is idle).
+ */
+struct acct_top {
+    struct acct_ent ents[ACCT_TOP_K]; /**< Members, unordered */
+    size_t n = 0; /**< Number of members */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Cheap timestamp for time slices (TSC on x86, else nanoseconds).
+ */
+static inline uint64_t acct_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000000000) +
+           static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+/**
+ * @brief Converts ticks to microseconds (calibrated against the monotonic
+ * clock since the first call).
+ *
+ * @param ticks Ticks of acct_ticks().
+ * @return uint64_t Microseconds.
+ */
+uint64_t acct_us(const uint64_t ticks);
+
+/**
+ * @brief Adds to the counters of a window.
+ *
+ * @param w The counters.
+ * @param now tmr_now_ms().
+ * @param cpu Ticks.
+ * @param bytes Bytes.
+ * @param cmds Commands.
+ */
+void acct_add(struct acct_win *const w, const uint64_t now,
+              const uint64_t cpu, const uint64_t bytes, const uint64_t cmds);
+
+/**
+ * @brief Value of a key over the last ACCT_WINDOW_MS.
+ *
+ * @param w The counters.
+ * @param key The key.
+ * @param now tmr_now_ms().
+ * @return uint64_t Windowed value.
+ */
+uint64_t acct_value(const struct acct_win *const w, const enum acct_key key,
+                    const uint64_t now);
+
+/**
+ * @brief Offers an updated object to a top-K set.
+ *
+ * @param t The set.
+ * @param key Key of the set.
+ * @param owner The object.
+ * @param w Its counters.
+ * @param now tmr_now_ms().
+ */
+void acct_top_offer(struct acct_top *const t, const enum acct_key key,
+                    void *const owner, const struct acct_win *const w,
+                    const uint64_t now);
+
+/**
+ * @brief Removes an object from a top-K set (no-op if not a member).
+ *
+ * @param t The set.
+ * @param owner The object.
+ */
+void acct_top_remove(struct acct_top *const t, const void *const owner);
+
+#endif /* ACCT_HPP */
@@ -0,0 +1,956 @@
+/**
+ * @file adm.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Administrative commands (session list, statistics, top, and
+ * kill/trace/reload for the sessions of the admin listener).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <vector>
+#include "adm.hpp"
+#include "srv.hpp"
+#include "sess.hpp"
+#include "rctr.hpp"
+#include "wrk.hpp"
+#include "pgr.hpp"
+#include "prof.hpp"
+#include "rec.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief A "top" row, copied out of a reactor.
+ */
+struct adm_top_row {
+    unsigned long id; /**< Session */
+    unsigned rctr; /**< Reactor index */
+    char peer[24]; /**< Peer address */
+    uint64_t v[ACCT_KEYS]; /**< Windowed values (CPU in ticks) */
+    uint64_t total; /**< CPU since the start, ticks */
+};
+
+/**
+ * @brief Lazy "who" listing: resumes after the last listed session (the
+ * sessions of a reactor are in id order).
+ */
+struct adm_who_src : public pgr_src {
+    struct srv *srv; /**< The server */
+    size_t left; /**< Sessions still to list ("who max") */
+    unsigned rctr; /**< Reactor being listed */
+    unsigned long last; /**< Last listed session of that reactor */
+    enum rec_fmt fmt; /**< Format of the calling session */
+};
+
+/**
+ * @brief "kill" request, runs on the reactor owning the session.
+ */
+struct adm_kill : public wrk_job {
+    unsigned long id; /**< Session to close */
+};
+
+/**
+ * @brief "rate" request, runs on the reactor owning the session.
+ */
+struct adm_rate_set : public wrk_job {
+    unsigned long id; /**< Session to limit */
+    int64_t rate; /**< New sess::rate */
+};
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+/**
+ * @brief Histogram names, same order as enum mtrc_hist_id.
+ */
+static const char *const adm_hist_names[MTRC_H_MAX] = {
+    "tcp_rtt_us",
+    "tcp_rttvar_us",
+    "tcp_retrans",
+    "tcp_cwnd",
+    "tcp_unacked_b",
+    "cmd_us"
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief "who [max]" - lists sessions with their network health (admin
+ * sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int adm_who(struct cmd_call *const call);
+
+/**
+ * @brief Lists the next sessions of a "who".
+ *
+ * @param src The adm_who_src.
+ * @param out Receives the lines.
+ * @param lines Lines wanted.
+ * @return int 0 - more to come, 1 - done.
+ */
+static int adm_who_next(struct pgr_src *const src, std::string *const out,
+                        const size_t lines);
+
+/**
+ * @brief Frees an adm_who_src.
+ */
+static void adm_who_close(struct pgr_src *const src);
+
+/**
+ * @brief "stats [hist]" - counters and histogram percentiles, "hist"
+ * dumps the raw log2 buckets (admin sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int adm_stats(struct cmd_call *const call);
+
+/**
+ * @brief "config" - shows the current configuration snapshot (admin
+ * sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 outside an admin session.
+ */
+static int adm_config(struct cmd_call *const call);
+
+/**
+ * @brief "rate [[id] bytes/s|off|default]" - shows or sets the output
+ * limit of a session (the calling one without an id, another one from
+ * admin sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument or unknown session.
+ */
+static int adm_rate(struct cmd_call *const call);
+
+/**
+ * @brief "top [cpu|bytes|cmds] [max]" - the busiest sessions over the last
+ * ACCT_WINDOW_MS, merged from the top-K sets of the reactors (admin
+ * sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int adm_top(struct cmd_call *const call);
+
+/**
+ * @brief "kill <id>" - closes a session (admin sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument or unknown session.
+ */
+static int adm_kill(struct cmd_call *const call);
+
+/**
+ * @brief "trace [error|info|trace]" - shows or sets the log level (admin
+ * sessions only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int adm_trace(struct cmd_call *const call);
+
+/**
+ * @brief "reload" - reloads the config file, like SIGHUP (admin sessions
+ * only).
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int adm_reload(struct cmd_call *const call);
+
+/**
+ * @brief "prof [seconds]" - samples the CPU stacks of every thread for a
+ * while and writes folded stacks into a new PROF_FILE (admin sessions on
+ * the admin reactor, not RPC); shows the running or the last profile
+ * without arguments.
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument or failure.
+ */
+static int adm_prof(struct cmd_call *const call);
+
+/**
+ * @brief Ends a profile and writes its file (admin reactor timer).
+ *
+ * @param t srv->profend.
+ */
+static void adm_prof_end(struct tmr *const t);
+
+/**
+ * @brief Closes the session of a kill request (reactor thread).
+ *
+ * @param job The adm_kill, freed here.
+ */
+static void adm_kill_done(struct wrk_job *const job);
+
+/**
+ * @brief Sets the output limit of the session of a rate request (reactor
+ * thread).
+ *
+ * @param job The adm_rate_set, freed here.
+ */
+static void adm_rate_done(struct wrk_job *const job);
+
+/**
+ * @brief Finds the reactor owning a session: operations on the session
+ * are posted to its mailbox (rctr_post()).
+ *
+ * @param srv The server.
+ * @param id The session.
+ * @return struct rctr* The reactor, or NULL if there is no such session.
+ */
+static struct rctr *adm_owner(struct srv *const srv, const unsigned long id);
+
+/**
+ * @brief Tells whether the caller came through the admin listener, or
+ * explains why not.
+ *
+ * @param call Call context.
+ * @return bool true for an admin session.
+ */
+static bool adm_privileged(struct cmd_call *const call);
+
+/**
+ * @brief Upper bound of the bucket holding the given percentile.
+ *
+ * @param buckets MTRC_H_BUCKETS counts.
+ * @param total Sum of the counts (> 0).
+ * @param pct Percentile, 1..100.
+ * @return uint64_t Largest value of the bucket.
+ */
+static uint64_t adm_hist_pct(const uint64_t *const buckets,
+                             const uint64_t total, const unsigned pct);
+
+/**
+ * @brief Largest value of a log2 bucket.
+ */
+static uint64_t adm_hist_bound(const size_t b);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int adm_register(struct srv *const srv) {
+    if (srv_cmd_register(srv, "who", adm_who, NULL,
+                         "List sessions and their network health"
+                         " ([max], admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "stats", adm_stats, NULL,
+                         "Show counters and histograms"
+                         " ([hist] - buckets, admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "config", adm_config, NULL,
+                         "Show the configuration in effect"
+                         " (admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "rate", adm_rate, NULL,
+                         "Show or set the output rate of a session"
+                         " ([[id] bytes/s|off|default])") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "top", adm_top, NULL,
+                         "Show the busiest sessions"
+                         " ([cpu|bytes|cmds] [max], admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "kill", adm_kill, NULL,
+                         "Close a session (<id>, admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "trace", adm_trace, NULL,
+                         "Show or set the log level"
+                         " ([error|info|trace], admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "reload", adm_reload, NULL,
+                         "Reload the config file (admin listener)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "prof", adm_prof, NULL,
+                         "Profile the CPU, write folded stacks"
+                         " ([seconds], admin listener)") < 0) {
+        return (-1);
+    }
+    return 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int adm_who(struct cmd_call *const call) {
+    /* Variables */
+    struct adm_who_src *w;
+    struct rec wr;
+    size_t max = SIZE_MAX;
+    /* Arguments */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    rec_call(&wr, call);
+    if (call->argv.size() > 1) {
+        max = strtoul(std::string(call->argv[1]).c_str(), NULL, 10);
+        if (max == 0) {
+            rec_line(&wr, "error", "Usage: who [max]");
+            return (-1);
+        }
+    }
+    /* Sessions of every reactor, listed as the pager asks for them */
+    rec_head(&wr, "     ID RCTR PEER                   RTT_US  RTTVAR"
+                  " RETRANS   CWND  UNACKED");
+    w = new (std::nothrow) struct adm_who_src;
+    if (w == NULL) {
+        return (-1);
+    }
+    w->next = adm_who_next;
+    w->close = adm_who_close;
+    w->srv = call->srv;
+    w->left = max;
+    w->rctr = 0;
+    w->last = 0;
+    w->fmt = wr.fmt;
+    if (call->src != NULL) {
+        *call->src = w;
+        return 0;
+    }
+    return pgr_drain(w, call->out);
+}
+
+static int adm_who_next(struct pgr_src *const src, std::string *const out,
+                        const size_t lines) {
+    /* Variables */
+    struct adm_who_src *w = static_cast<struct adm_who_src *>(src);
+    struct rec wr;
+    size_t n = 0;
+    bool more;
+    /* Sessions after the last listed one */
+    rec_init(&wr, out, w->fmt);
+    while ((w->rctr < w->srv->nrctr) && (w->left > 0)) {
+        struct rctr *r = &w->srv->rctrs[w->rctr];
+        std::lock_guard<std::mutex> lock(r->mutex);
+        more = false;
+        for (const struct sess *s : r->sessions) {
+            if (s->id <= w->last) {
+                continue;
+            }
+            if ((n >= lines) || (w->left == 0)) {
+                more = (w->left > 0);
+                break;
+            }
+            rec_begin(&wr, "session");
+            rec_u64(&wr, "id", s->id, 7);
+            rec_u64(&wr, "rctr", r->idx, 4);
+            rec_str(&wr, "peer", s->peer, -21);
+            if (s->net_at == 0) {
+                rec_null(&wr, "rtt_us", 7);
+                rec_null(&wr, "rttvar_us", 7);
+                rec_null(&wr, "retrans", 7);
+                rec_null(&wr, "cwnd", 6);
+                rec_null(&wr, "unacked", 8);
+            } else {
+                rec_u64(&wr, "rtt_us", s->net.rtt, 7);
+                rec_u64(&wr, "rttvar_us", s->net.rttvar, 7);
+                rec_u64(&wr, "retrans", s->net.retrans, 7);
+                rec_u64(&wr, "cwnd", s->net.cwnd, 6);
+                rec_u64(&wr, "unacked", s->net.unacked, 8);
+            }
+            rec_end(&wr);
+            w->last = s->id;
+            --w->left;
+            ++n;
+        }
+        if (more) {
+            return 0;
+        }
+        ++w->rctr;
+        w->last = 0;
+    }
+    rec_begin(&wr, "total");
+    rec_label(&wr, "Sessions:");
+    rec_u64(&wr, "sessions", srv_session_count(w->srv), 0);
+    rec_end(&wr);
+    return 1;
+}
+
+static void adm_who_close(struct pgr_src *const src) {
+    delete static_cast<struct adm_who_src *>(src);
+}
+
+static int adm_stats(struct cmd_call *const call) {
+    /* Variables */
+    struct srv *srv = call->srv;
+    const bool raw = (call->argv.size() > 1);
+    uint64_t buckets[MTRC_H_BUCKETS];
+    uint64_t total;
+    struct rec wr;
+    /* Arguments */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    rec_call(&wr, call);
+    if (raw && (call->argv[1] != "hist")) {
+        rec_line(&wr, "error", "Usage: stats [hist]");
+        return (-1);
+    }
+    if (!tlnt_policy::mtrc::enabled) {
+        rec_line(&wr, "info", "Metrics are disabled in this build");
+        return 0;
+    }
+    /* Counters */
+    rec_begin(&wr, "counters");
+    rec_u64(&wr, "sessions", srv_session_count(srv), REC_PAIR);
+    rec_u64(&wr, "accepted", srv_mtrc(srv, MTRC_ACCEPTED), REC_PAIR);
+    rec_u64(&wr, "closed", srv_mtrc(srv, MTRC_CLOSED), REC_PAIR);
+    rec_u64(&wr, "commands", srv_mtrc(srv, MTRC_COMMANDS), REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "bytes_in", srv_mtrc(srv, MTRC_BYTES_IN), REC_PAIR);
+    rec_u64(&wr, "bytes_out", srv_mtrc(srv, MTRC_BYTES_OUT), REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "hibernated", srv_mtrc(srv, MTRC_HIBERNATED), REC_PAIR);
+    rec_u64(&wr, "woken", srv_mtrc(srv, MTRC_WOKEN), REC_PAIR);
+    rec_u64(&wr, "refused", srv_mtrc(srv, MTRC_REFUSED), REC_PAIR);
+    rec_u64(&wr, "dead", srv_mtrc(srv, MTRC_DEAD), REC_PAIR);
+    rec_end(&wr);
+    /* Histograms */
+    if (!raw) {
+        rec_head(&wr, "HISTOGRAM          COUNT      P50      P90"
+                      "      P99      MAX");
+    }
+    for (size_t h = 0; h < MTRC_H_MAX; ++h) {
+        srv_mtrc_hist(srv, static_cast<enum mtrc_hist_id>(h), buckets);
+        total = 0;
+        for (size_t b = 0; b < MTRC_H_BUCKETS; ++b) {
+            total += buckets[b];
+            if (raw && (buckets[b] > 0)) {
+                rec_begin(&wr, "bucket");
+                rec_str(&wr, "name", adm_hist_names[h], 0);
+                rec_u64(&wr, "le", adm_hist_bound(b), REC_ASSIGN);
+                rec_u64(&wr, "count", buckets[b], 0);
+                rec_end(&wr);
+            }
+        }
+        if (raw) {
+            continue;
+        }
+        rec_begin(&wr, "hist");
+        rec_str(&wr, "name", adm_hist_names[h], -14);
+        rec_u64(&wr, "count", total, 9);
+        if (total == 0) {
+            rec_null(&wr, "p50", 8);
+            rec_null(&wr, "p90", 8);
+            rec_null(&wr, "p99", 8);
+            rec_null(&wr, "max", 8);
+        } else {
+            rec_u64(&wr, "p50", adm_hist_pct(buckets, total, 50), 8);
+            rec_u64(&wr, "p90", adm_hist_pct(buckets, total, 90), 8);
+            rec_u64(&wr, "p99", adm_hist_pct(buckets, total, 99), 8);
+            rec_u64(&wr, "max", adm_hist_pct(buckets, total, 100), 8);
+        }
+        rec_end(&wr);
+    }
+    return 0;
+}
+
+static int adm_config(struct cmd_call *const call) {
+    /* Variables */
+    static const char *const levels[] = {"error", "info", "trace"};
+    const std::shared_ptr<const struct cfg> conf = cfg_hold(&call->srv->conf);
+    const struct cfg *c = conf.get();
+    struct srv *srv = call->srv;
+    struct rec wr;
+    /* Snapshot, a setting per text line */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    rec_call(&wr, call);
+    rec_begin(&wr, "config");
+    rec_str(&wr, "file", (srv->cfg.cfgfile != NULL) ? srv->cfg.cfgfile : "-",
+            REC_PAIR);
+    rec_break(&wr);
+    rec_str(&wr, "log_level", levels[c->log_level], REC_PAIR);
+    rec_break(&wr);
+    rec_i64(&wr, "backlog", srv->plan.backlog, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "oq_high", c->oq_high, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "oq_low", c->oq_low, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "rpc_inflight", c->rpc_inflight, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "net_period_ms", c->net_period, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "rate_session", c->rate_session, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "rate_global", c->rate_global, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "hibernate_ms", c->hibernate, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "keepalive_ms", c->keepalive, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "keepalive_probes", c->keepalive_probes, REC_PAIR);
+    rec_break(&wr);
+    rec_str(&wr, "auth", (srv->auth.lookup != NULL) ? "application" :
+                         c->auth.empty() ? "none" : c->auth.c_str(),
+            REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "auth_inflight", c->auth_inflight, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "auth_cache_ms", c->auth_cache, REC_PAIR);
+    rec_break(&wr);
+    rec_str(&wr, "script_dir", c->script_dir.empty() ? "none" :
+                               c->script_dir.c_str(), REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "reactors", srv->plan.reactors, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "workers", srv->plan.workers, REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "sessions_max", srv_sessions_max(srv), REC_PAIR);
+    rec_break(&wr);
+    rec_u64(&wr, "mem_limit", srv->plan.mem, REC_PAIR);
+    rec_break(&wr);
+    rec_str(&wr, "plan", plan_describe(&srv->plan), REC_PAIR);
+    rec_end(&wr);
+    for (const struct cfg_program &p : c->programs) {
+        rec_begin(&wr, "program");
+        rec_label(&wr, "program");
+        rec_str(&wr, "name", p.name, 0);
+        rec_str(&wr, "path", p.path, 0);
+        rec_flag(&wr, "pty", p.pty);
+        rec_flag(&wr, "raw", p.raw);
+        rec_end(&wr);
+    }
+    return 0;
+}
+
+static int adm_rate(struct cmd_call *const call) {
+    /* Variables */
+    struct srv *srv = call->srv;
+    const std::shared_ptr<const struct cfg> conf = cfg_hold(&srv->conf);
+    const struct cfg *c = conf.get();
+    unsigned long id = call->sess->id;
+    struct rctr *owner;
+    struct adm_rate_set *j;
+    std::string_view val;
+    int64_t rate;
+    char *end = NULL;
+    char line[160];
+    /* Show */
+    if (call->argv.size() == 1) {
+        rate = call->sess->rate.load(std::memory_order_relaxed);
+        snprintf(line, sizeof(line),
+                 "session %lu %lu bytes/s%s\r\nglobal %lu bytes/s\r\n",
+                 id, static_cast<unsigned long>((rate < 0) ? c->rate_session
+                                                           : rate),
+                 (rate < 0) ? " (default)" : "",
+                 static_cast<unsigned long>(c->rate_global));
+        call->out->append(line);
+        return 0;
+    }
+    /* Arguments */
+    if (call->argv.size() > 3) {
+        goto adm_rate_usage;
+    }
+    if (call->argv.size() == 3) {
+        id = strtoul(std::string(call->argv[1]).c_str(), &end, 10);
+        if ((id == 0) || (*end != '\0')) {
+            goto adm_rate_usage;
+        }
+        if ((id != call->sess->id) && !adm_privileged(call)) {
+            return (-1);
+        }
+    }
+    val = call->argv.back();
+    if (val == "off") {
+        rate = 0;
+    } else if (val == "default") {
+        rate = (-1);
+    } else {
+        rate = strtoll(std::string(val).c_str(), &end, 10);
+        if ((rate < 1) || (*end != '\0') ||
+            (static_cast<uint64_t>(rate) > SHP_RATE_MAX)) {
+            goto adm_rate_usage;
+        }
+    }
+    /* Set by the owner (the session sees it on its next flush) */
+    owner = (id == call->sess->id) ? call->sess->rctr : adm_owner(srv, id);
+    if (owner == NULL) {
+        snprintf(line, sizeof(line), "Error: no session %lu\r\n", id);
+        call->out->append(line);
+        return (-1);
+    }
+    j = new (std::nothrow) struct adm_rate_set;
+    if (j == NULL) {
+        return (-1);
+    }
+    j->run = NULL;
+    j->done = adm_rate_done;
+    j->rctr = owner;
+    j->id = id;
+    j->rate = rate;
+    rctr_post(owner, j);
+    return 0;
+
+adm_rate_usage:
+    call->out->append("Usage: rate [[id] bytes/s|off|default]\r\n");
+    return (-1);
+}
+
+static int adm_top(struct cmd_call *const call) {
+    /* Variables */
+    static const char *const keys[ACCT_KEYS] = {"cpu", "bytes", "cmds"};
+    struct srv *srv = call->srv;
+    const uint64_t now = tmr_now_ms();
+    size_t key = ACCT_CPU;
+    size_t max = 10;
+    size_t arg = 1;
+    std::vector<struct adm_top_row> rows;
+    struct rec wr;
+    /* Arguments */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    rec_call(&wr, call);
+    if ((call->argv.size() > arg) &&
+        !isdigit(static_cast<unsigned char>(call->argv[arg][0]))) {
+        for (key = 0; (key < ACCT_KEYS) && (call->argv[arg] != keys[key]);
+             ++key) {
+        }
+        if (key == ACCT_KEYS) {
+            goto adm_top_usage;
+        }
+        ++arg;
+    }
+    if (call->argv.size() > arg) {
+        max = strtoul(std::string(call->argv[arg]).c_str(), NULL, 10);
+        if ((max == 0) || (call->argv.size() > (arg + 1))) {
+            goto adm_top_usage;
+        }
+    }
+    /* At most K sessions per reactor, no walk over all sessions */
+    rows.reserve(srv->nrctr * ACCT_TOP_K);
+    for (unsigned i = 0; i < srv->nrctr; ++i) {
+        struct rctr *r = &srv->rctrs[i];
+        std::lock_guard<std::mutex> lock(r->mutex);
+        for (size_t e = 0; e < r->top[key].n; ++e) {
+            const struct sess *s =
+                static_cast<const struct sess *>(r->top[key].ents[e].owner);
+            struct adm_top_row row = {
+                .id = s->id,
+                .rctr = r->idx,
+                .peer = {},
+                .v = {},
+                .total = s->acct.cpu
+            };
+            memcpy(row.peer, s->peer, sizeof(row.peer));
+            for (size_t k = 0; k < ACCT_KEYS; ++k) {
+                row.v[k] = acct_value(&s->acct, static_cast<enum acct_key>(k),
+                                      now);
+            }
+            if (row.v[key] > 0) {
+                rows.push_back(row);
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end(),
+              [key](const struct adm_top_row &a, const struct adm_top_row &b) {
+                  return a.v[key] > b.v[key];
+              });
+    /* Table */
+    rec_begin(&wr, "window");
+    rec_label(&wr, "Last");
+    rec_u64(&wr, "seconds", ACCT_WINDOW_MS / 1000, 0);
+    rec_label(&wr, "s by");
+    rec_str(&wr, "key", keys[key], 0);
+    rec_end(&wr);
+    rec_head(&wr, "     ID RCTR PEER                    CPU_US      BYTES"
+                  "    CMDS   TOTAL_US");
+    for (size_t i = 0; (i < rows.size()) && (i < max); ++i) {
+        rec_begin(&wr, "session");
+        rec_u64(&wr, "id", rows[i].id, 7);
+        rec_u64(&wr, "rctr", rows[i].rctr, 4);
+        rec_str(&wr, "peer", rows[i].peer, -21);
+        rec_u64(&wr, "cpu_us", acct_us(rows[i].v[ACCT_CPU]), 9);
+        rec_u64(&wr, "bytes", rows[i].v[ACCT_BYTES], 10);
+        rec_u64(&wr, "cmds", rows[i].v[ACCT_CMDS], 7);
+        rec_u64(&wr, "total_us", acct_us(rows[i].total), 10);
+        rec_end(&wr);
+    }
+    return 0;
+
+adm_top_usage:
+    rec_line(&wr, "error", "Usage: top [cpu|bytes|cmds] [max]");
+    return (-1);
+}
+
+static int adm_kill(struct cmd_call *const call) {
+    /* Variables */
+    struct srv *srv = call->srv;
+    struct rctr *owner;
+    struct adm_kill *j;
+    unsigned long id;
+    char *end = NULL;
+    char line[96];
+    /* Arguments */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    if (call->argv.size() != 2) {
+        call->out->append("Usage: kill <id>\r\n");
+        return (-1);
+    }
+    id = strtoul(std::string(call->argv[1]).c_str(), &end, 10);
+    if ((id == 0) || (*end != '\0')) {
+        call->out->append("Usage: kill <id>\r\n");
+        return (-1);
+    }
+    /* Owner of the session, which closes it on its own thread */
+    owner = adm_owner(srv, id);
+    if (owner == NULL) {
+        snprintf(line, sizeof(line), "Error: no session %lu\r\n", id);
+        call->out->append(line);
+        return (-1);
+    }
+    j = new (std::nothrow) struct adm_kill;
+    if (j == NULL) {
+        return (-1);
+    }
+    j->run = NULL;
+    j->done = adm_kill_done;
+    j->rctr = owner;
+    j->id = id;
+    rctr_post(owner, j);
+    snprintf(line, sizeof(line), "Session %lu is closing\r\n", id);
+    call->out->append(line);
+    return 0;
+}
+
+static int adm_trace(struct cmd_call *const call) {
+    /* Variables */
+    static const char *const levels[] = {"error", "info", "trace"};
+    int level = LOG_ERROR;
+    /* Arguments */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    if (!tlnt_policy::log::enabled) {
+        call->out->append("Logging is disabled in this build\r\n");
+        return 0;
+    }
+    if (call->argv.size() > 2) {
+        goto adm_trace_usage;
+    }
+    /* Show */
+    if (call->argv.size() == 1) {
+        while ((level < LOG_TRACE) &&
+               tlnt_policy::log::on(static_cast<enum log_level>(level + 1))) {
+            ++level;
+        }
+        call->out->append(std::string("log_level ") + levels[level] + "\r\n");
+        return 0;
+    }
+    /* Set (until the next reload) */
+    for (level = LOG_ERROR; level <= LOG_TRACE; ++level) {
+        if (call->argv[1] == levels[level]) {
+            log_set_level(static_cast<enum log_level>(level));
+            return 0;
+        }
+    }
+
+adm_trace_usage:
+    call->out->append("Usage: trace [error|info|trace]\r\n");
+    return (-1);
+}
+
+static int adm_reload(struct cmd_call *const call) {
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    if (srv_reload(call->srv) < 0) {
+        call->out->append("Error: reload failed, the configuration in effect"
+                          " is kept\r\n");
+        return (-1);
+    }
+    call->out->append("Config reloaded\r\n");
+    return 0;
+}
+
+static int adm_prof(struct cmd_call *const call) {
+    /* Variables */
+    struct srv *srv = call->srv;
+    struct rctr *r = call->sess->rctr;
+    unsigned long seconds;
+    char *end;
+    char name[64];
+    struct tm tm;
+    time_t now;
+    /* Arguments */
+    if (!adm_privileged(call)) {
+        return (-1);
+    }
+    if (!tlnt_policy::feat::prof) {
+        call->out->append("Profiling is disabled in this build\r\n");
+        return 0;
+    }
+    if (call->sess->mode == SESS_RPC) {
+        /* The state and the timer belong to the admin reactor thread */
+        call->out->append("Error: prof needs a terminal session\r\n");
+        return (-1);
+    }
+    if (call->argv.size() > 2) {
+        goto adm_prof_usage;
+    }
+    /* Show */
+    if (call->argv.size() == 1) {
+        if (tmr_armed(&srv->profend)) {
+            call->out->append("Profiling into " + srv->profpath + "\r\n");
+        } else if (srv->proflast.empty()) {
+            call->out->append("No profile taken\r\n");
+        } else {
+            call->out->append(srv->proflast + "\r\n");
+        }
+        return 0;
+    }
+    /* Start */
+    seconds = strtoul(std::string(call->argv[1]).c_str(), &end, 10);
+    if ((*end != '\0') || (seconds == 0) || (seconds > PROF_SECONDS_MAX)) {
+        goto adm_prof_usage;
+    }
+    now = time(NULL);
+    if ((localtime_r(&now, &tm) == NULL) ||
+        (strftime(name, sizeof(name), PROF_FILE, &tm) == 0)) {
+        call->out->append("Error: cannot name the profile\r\n");
+        return (-1);
+    }
+    if constexpr (tlnt_policy::feat::prof) {
+        if (prof_start(static_cast<unsigned>(seconds)) < 0) {
+            call->out->append((errno == EBUSY) ?
+                              "Error: a profile is running\r\n" :
+                              "Error: cannot start the profiler\r\n");
+            return (-1);
+        }
+    }
+    srv->profpath.assign(name);
+    srv->profend.cb = adm_prof_end;
+    srv->profend.arg = srv;
+    tmr_arm(&r->wheel, &srv->profend, seconds * 1000);
+    call->out->append("Profiling for " + std::to_string(seconds) +
+                      " s into " + srv->profpath + "\r\n");
+    return 0;
+
+adm_prof_usage:
+    call->out->append("Usage: prof [seconds (1.." +
+                      std::to_string(PROF_SECONDS_MAX) + ")]\r\n");
+    return (-1);
+}
+
+static void adm_prof_end(struct tmr *const t) {
+    /* Variables */
+    struct srv *srv = static_cast<struct srv *>(t->arg);
+    struct prof_result res = {};
+    int result = (-1);
+    /* Write (on the admin reactor, the data reactors keep serving) */
+    if constexpr (tlnt_policy::feat::prof) {
+        result = prof_stop(srv->profpath.c_str(), &res);
+    }
+    if (result < 0) {
+        srv->proflast = "Error: cannot write " + srv->profpath;
+    } else {
+        srv->proflast = "Last profile: " + std::to_string(res.samples) +
+                        " samples (" + std::to_string(res.dropped) +
+                        " dropped) of " + std::to_string(res.threads) +
+                        " threads, " + std::to_string(res.stacks) +
+                        " stacks in " + srv->profpath;
+    }
+    log_info(srv->proflast);
+}
+
+static void adm_kill_done(struct wrk_job *const job) {
+    /* Variables */
+    struct adm_kill *j = static_cast<struct adm_kill *>(job);
+    /* Gone already if not found */
+    for (struct sess *s : j->rctr->sessions) {
+        if (s->id == j->id) {
+            log_info("Session ", s->id, " killed");
+            rctr_sess_close(s);
+            break;
+        }
+    }
+    delete j;
+}
+
+static void adm_rate_done(struct wrk_job *const job) {
+    /* Variables */
+    struct adm_rate_set *j = static_cast<struct adm_rate_set *>(job);
+    /* Gone already if not found */
+    for (struct sess *s : j->rctr->sessions) {
+        if (s->id == j->id) {
+            s->rate.store(j->rate, std::memory_order_relaxed);
+            break;
+        }
+    }
+    delete j;
+}
+
+static struct rctr *adm_owner(struct srv *const srv, const unsigned long id) {
+    /* The session lists are read under the reactor locks */
+    for (unsigned i = 0; i < srv->nrctr; ++i) {
+        struct rctr *r = &srv->rctrs[i];
+        std::lock_guard<std::mutex> lock(r->mutex);
+        for (const struct sess *s : r->sessions) {
+            if (s->id == id) {
+                return r;
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool adm_privileged(struct cmd_call *const call) {
+    if ((call->srv->adm != NULL) && (call->sess->rctr == call->srv->adm)) {
+        return true;
+    }
+    call->out->append("Error: available on the admin listener only\r\n");
+    return false;
+}
+
+static uint64_t adm_hist_pct(const uint64_t *const buckets,
+                             const uint64_t total, const unsigned pct) {
+    /* Variables */
+    const uint64_t rank = ((total * pct) + 99) / 100; /* 1-based */
+    uint64_t seen = 0;
+    /* First bucket reaching the rank */
+    for (size_t b = 0; b < MTRC_H_BUCKETS; ++b) {
+        seen += buckets[b];
+        if ((seen >= rank) && (seen > 0)) {
+            return adm_hist_bound(b);
+        }
+    }
+    return adm_hist_bound(MTRC_H_BUCKETS - 1);
+}
+
+static uint64_t adm_hist_bound(const size_t b) {
+    return (b >= 64) ? UINT64_MAX : ((uint64_t(1) << b) - 1);
+}
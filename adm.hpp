@@ -0,0 +1,33 @@
+/**
+ * @file adm.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Administrative commands (session list, statistics).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef ADM_HPP
+#define ADM_HPP
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Registers the administrative commands ("who", "stats",
+ * "config").
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+int adm_register(struct srv *const srv);
+
+#endif /* ADM_HPP */
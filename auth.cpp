@@ -0,0 +1,850 @@
+/**
+ * @file auth.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Login stage: credential backends, PBKDF2-SHA256 checks on the
+ * worker pool and a short-lived verification cache.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "auth.hpp"
+#include "parser.hpp"
+#include "rctr.hpp"
+#include "sess.hpp"
+#include "srv.hpp"
+#include "wrk.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief SHA-256 context.
+ */
+struct auth_sha {
+    uint32_t h[8]; /**< State */
+    uint64_t len; /**< Bytes hashed */
+    uint8_t buf[64]; /**< Partial block */
+    size_t n; /**< Bytes in buf */
+};
+
+/**
+ * @brief HMAC-SHA256 key: contexts with the padded key already hashed,
+ * reused by every PBKDF2 round.
+ */
+struct auth_hmac {
+    struct auth_sha in; /**< After key ^ ipad */
+    struct auth_sha out; /**< After key ^ opad */
+};
+
+/**
+ * @brief A login checked on the worker pool.
+ */
+struct auth_job : public wrk_job {
+    struct sess *sess; /**< Session logging in (referenced) */
+    std::shared_ptr<const struct cfg> conf; /**< Snapshot held for be */
+    struct auth_backend be; /**< Backend chosen at submit */
+    std::string name; /**< Entered name */
+    std::string pass; /**< Entered password, wiped after the hash */
+    std::string key; /**< Cache key of name and password */
+    bool ok; /**< Password matches */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Queues the check of a login on the worker pool.
+ *
+ * @param s The session.
+ * @param key Cache key of the entered name and password.
+ * @return int 0 - continue, >0 - close the session, -1 - error.
+ */
+static int auth_run(struct sess *const s, std::string &&key);
+
+/**
+ * @brief Looks the name up and hashes the password (worker thread).
+ *
+ * @param job The auth_job.
+ */
+static void auth_job_run(struct wrk_job *const job);
+
+/**
+ * @brief Ends a checked login and starts waiting ones (reactor thread).
+ *
+ * @param job The auth_job, freed here.
+ */
+static void auth_job_done(struct wrk_job *const job);
+
+/**
+ * @brief Starts waiting logins while hash slots are free.
+ *
+ * @param r The reactor.
+ */
+static void auth_next(struct rctr *const r);
+
+/**
+ * @brief Passes the result of a login to the parser, then flushes or
+ * closes the session.
+ *
+ * @param s The session.
+ * @param name Entered name (logged).
+ * @param ok Password matches.
+ */
+static void auth_finish(struct sess *const s, const std::string_view name,
+                        const bool ok);
+
+/**
+ * @brief Backend of the session: the application one, or the "auth"
+ * setting of the snapshot.
+ *
+ * @param srv The server.
+ * @param conf Configuration snapshot (held by the job).
+ * @param be Receives the backend.
+ * @return int 0 on success, or -1 if there is none.
+ */
+static int auth_backend_of(struct srv *const srv,
+                           const struct cfg *const conf,
+                           struct auth_backend *const be);
+
+/**
+ * @brief File backend: "name:rounds:salt_hex:hash_hex" lines, "#"
+ * comments, read on every lookup.
+ *
+ * @param user Path of the file.
+ */
+static int auth_file_lookup(void *const user, const std::string_view name,
+                            struct auth_cred *const cred);
+
+/**
+ * @brief Socket backend: a local service on a UNIX socket answers a
+ * "name\n" request with "rounds:salt_hex:hash_hex\n", or "-\n" for an
+ * unknown name.
+ *
+ * @param user Path of the socket.
+ */
+static int auth_socket_lookup(void *const user, const std::string_view name,
+                              struct auth_cred *const cred);
+
+/**
+ * @brief Parses "rounds:salt_hex:hash_hex".
+ *
+ * @param text Text.
+ * @param cred Receives the credentials.
+ * @return int 0 on success, or -1 on a wrong record.
+ */
+static int auth_cred_parse(std::string_view text,
+                           struct auth_cred *const cred);
+
+/**
+ * @brief Decodes exactly len bytes of hex.
+ *
+ * @return int 0 on success, or -1 on a wrong length or digit.
+ */
+static int auth_unhex(const std::string_view text, uint8_t *const out,
+                      const size_t len);
+
+/**
+ * @brief Cache key of a name and a password.
+ */
+static std::string auth_cache_key(const struct auth_cache *const c,
+                                  const std::string_view name,
+                                  const std::string_view pass);
+
+/**
+ * @brief Tells whether a key was verified within its lifetime.
+ */
+static bool auth_cache_hit(struct auth_cache *const c, const std::string &key,
+                           const uint64_t now);
+
+/**
+ * @brief Remembers a verified key (full cache: expired keys go first,
+ * then everything).
+ */
+static void auth_cache_put(struct auth_cache *const c, const std::string &key,
+                           const uint64_t expiry);
+
+/**
+ * @brief Compares two hashes in constant time.
+ */
+static bool auth_equal(const uint8_t *const a, const uint8_t *const b);
+
+/**
+ * @brief SHA-256 steps.
+ */
+static void auth_sha_init(struct auth_sha *const c);
+static void auth_sha_update(struct auth_sha *const c, const uint8_t *data,
+                            size_t len);
+static void auth_sha_final(struct auth_sha *const c, uint8_t *const out);
+static void auth_sha_block(uint32_t *const h, const uint8_t *const p);
+
+/**
+ * @brief Hashes a HMAC key into its inner and outer contexts.
+ */
+static void auth_hmac_init(struct auth_hmac *const k, const uint8_t *const key,
+                           const size_t len);
+
+/**
+ * @brief HMAC-SHA256 of a message with a prepared key.
+ */
+static void auth_hmac(const struct auth_hmac *const k,
+                      const uint8_t *const data, const size_t len,
+                      uint8_t *const out);
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+/**
+ * @brief SHA-256 round constants.
+ */
+static const uint32_t auth_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int auth_cache_init(struct auth_cache *const c) {
+    if (getrandom(c->secret, sizeof(c->secret), 0) !=
+        static_cast<ssize_t>(sizeof(c->secret))) {
+        log_error("Error: getrandom");
+        return (-1);
+    }
+    return 0;
+}
+
+void auth_cache_clear(struct auth_cache *const c) {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->ent.clear();
+}
+
+bool auth_required(struct srv *const srv) {
+    return (srv->auth.lookup != NULL) || !cfg_hold(&srv->conf)->auth.empty();
+}
+
+int auth_start(struct sess *const s) {
+    /* Variables */
+    struct auth_login *l = new (std::nothrow) struct auth_login;
+    if (l == NULL) {
+        return (-1);
+    }
+    /* The name comes first */
+    l->stage = AUTH_NAME;
+    l->cr = false;
+    l->tries = 0;
+    l->queued = false;
+    s->login.reset(l);
+    return 0;
+}
+
+int auth_submit(struct sess *const s) {
+    /* Variables */
+    struct auth_login *l = s->login.get();
+    struct rctr *r = s->rctr;
+    const struct cfg *conf = r->conf.get();
+    std::string key;
+    /* A client that logged in a moment ago skips the hash */
+    try {
+        key = auth_cache_key(&s->srv->authcache, l->name, l->pass);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    if ((conf->auth_cache > 0) &&
+        auth_cache_hit(&s->srv->authcache, key, tmr_now_ms())) {
+        explicit_bzero(l->pass.data(), l->pass.size());
+        l->pass.clear();
+        log_info("Login of session ", s->id, ": ", l->name, " (cached)");
+        return parser_login_done(s, true);
+    }
+    /* All hash slots of the reactor busy - wait in line */
+    if (r->authrun >= conf->auth_inflight) {
+        try {
+            l->it = r->authq.insert(r->authq.end(), s);
+        } catch (const std::bad_alloc& e) {
+            return (-1);
+        }
+        l->queued = true;
+        return 0;
+    }
+    return auth_run(s, std::move(key));
+}
+
+void auth_stop(struct sess *const s) {
+    /* Variables */
+    struct auth_login *l = s->login.get();
+    if (l == NULL) {
+        return;
+    }
+    /* Out of the line, nothing left to check */
+    if (l->queued) {
+        s->rctr->authq.erase(l->it);
+        l->queued = false;
+    }
+    explicit_bzero(l->pass.data(), l->pass.size());
+}
+
+void auth_pbkdf2(const std::string_view pass, const uint8_t *const salt,
+                 const size_t saltlen, const unsigned iter,
+                 uint8_t *const out) {
+    /* Variables */
+    struct auth_hmac k;
+    uint8_t first[AUTH_SALT_MAX + 4];
+    uint8_t u[AUTH_HASH_LEN];
+    /* U1 = HMAC(P, S || INT(1)), one output block */
+    auth_hmac_init(&k, reinterpret_cast<const uint8_t *>(pass.data()),
+                   pass.size());
+    memcpy(first, salt, saltlen);
+    first[saltlen] = 0;
+    first[saltlen + 1] = 0;
+    first[saltlen + 2] = 0;
+    first[saltlen + 3] = 1;
+    auth_hmac(&k, first, saltlen + 4, u);
+    memcpy(out, u, sizeof(u));
+    /* Un = HMAC(P, Un-1), T = U1 ^ ... ^ Un */
+    for (unsigned i = 1; i < iter; ++i) {
+        auth_hmac(&k, u, sizeof(u), u);
+        for (size_t b = 0; b < sizeof(u); ++b) {
+            out[b] ^= u[b];
+        }
+    }
+    explicit_bzero(&k, sizeof(k));
+    explicit_bzero(u, sizeof(u));
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int auth_run(struct sess *const s, std::string &&key) {
+    /* Variables */
+    struct auth_login *l = s->login.get();
+    struct auth_job *j = new (std::nothrow) struct auth_job;
+    if (j == NULL) {
+        return (-1);
+    }
+    /* Job */
+    j->conf = s->rctr->conf; /* be may point into it */
+    if (auth_backend_of(s->srv, j->conf.get(), &j->be) < 0) {
+        delete j;
+        return (-1);
+    }
+    try {
+        j->name = l->name;
+        j->pass = l->pass;
+    } catch (const std::bad_alloc& e) {
+        delete j;
+        return (-1);
+    }
+    explicit_bzero(l->pass.data(), l->pass.size());
+    l->pass.clear();
+    j->run = auth_job_run;
+    j->done = auth_job_done;
+    j->rctr = s->rctr;
+    j->sess = s;
+    j->key = std::move(key);
+    j->ok = false;
+    /* The session stays allocated until auth_job_done() */
+    ++s->refs;
+    ++s->rctr->authrun;
+    if (wrk_submit(&s->srv->workers, j) < 0) {
+        --s->refs;
+        --s->rctr->authrun;
+        explicit_bzero(j->pass.data(), j->pass.size());
+        delete j;
+        return (sess_write(s, "Error: server is stopping\r\n") < 0) ? (-1)
+                                                                     : 1;
+    }
+    return 0;
+}
+
+static void auth_job_run(struct wrk_job *const job) {
+    /* Variables */
+    struct auth_job *j = static_cast<struct auth_job *>(job);
+    struct auth_cred cred;
+    uint8_t hash[AUTH_HASH_LEN];
+    int found;
+    /* Look up, then hash (an unknown name costs the same) */
+    found = j->be.lookup(j->be.user, j->name, &cred);
+    if (found < 0) {
+        log_error("Error: credential lookup of ", j->name);
+    } else if (found > 0) {
+        memset(cred.salt, 0, sizeof(cred.salt));
+        auth_pbkdf2(j->pass, cred.salt, 16, AUTH_ITER_DUMMY, hash);
+    } else {
+        auth_pbkdf2(j->pass, cred.salt, cred.saltlen, cred.iter, hash);
+        j->ok = auth_equal(hash, cred.hash);
+    }
+    explicit_bzero(j->pass.data(), j->pass.size());
+    explicit_bzero(hash, sizeof(hash));
+}
+
+static void auth_job_done(struct wrk_job *const job) {
+    /* Variables */
+    struct auth_job *j = static_cast<struct auth_job *>(job);
+    struct sess *s = j->sess;
+    struct rctr *r = j->rctr;
+    const uint64_t ttl = r->conf->auth_cache;
+    /* Remember success, answer unless the client is gone */
+    --s->refs;
+    --r->authrun;
+    if (j->ok && (ttl > 0)) {
+        auth_cache_put(&s->srv->authcache, j->key, tmr_now_ms() + ttl);
+    }
+    if (!s->closing) {
+        auth_finish(s, j->name, j->ok);
+    }
+    delete j;
+    auth_next(r);
+}
+
+static void auth_next(struct rctr *const r) {
+    /* Variables */
+    const unsigned cap = r->conf->auth_inflight;
+    struct sess *s;
+    int result;
+    /* Waiting logins in arrival order (cached ones take no slot) */
+    while ((r->authrun < cap) && !r->authq.empty()) {
+        s = r->authq.front();
+        r->authq.pop_front();
+        s->login->queued = false;
+        result = auth_submit(s);
+        if ((result < 0) || ((rctr_sess_flush(s) == 0) && (result > 0))) {
+            rctr_sess_close(s);
+        }
+    }
+}
+
+static void auth_finish(struct sess *const s, const std::string_view name,
+                        const bool ok) {
+    /* Variables */
+    int result;
+    /* Prompt, another try, or the close */
+    log_info("Login of session ", s->id, ": ", name,
+             ok ? " accepted" : " refused");
+    result = parser_login_done(s, ok);
+    if ((result < 0) || ((rctr_sess_flush(s) == 0) && (result > 0))) {
+        rctr_sess_close(s);
+    }
+}
+
+static int auth_backend_of(struct srv *const srv,
+                           const struct cfg *const conf,
+                           struct auth_backend *const be) {
+    /* Variables */
+    const std::string_view spec(conf->auth);
+    /* The application backend wins over the setting */
+    if (srv->auth.lookup != NULL) {
+        *be = srv->auth;
+        return 0;
+    }
+    if (spec.starts_with("file:")) {
+        be->lookup = auth_file_lookup;
+        be->user = const_cast<char *>(conf->auth.c_str() + 5);
+        return 0;
+    }
+    if (spec.starts_with("socket:")) {
+        be->lookup = auth_socket_lookup;
+        be->user = const_cast<char *>(conf->auth.c_str() + 7);
+        return 0;
+    }
+    return (-1);
+}
+
+static int auth_file_lookup(void *const user, const std::string_view name,
+                            struct auth_cred *const cred) {
+    /* Variables */
+    const char *path = static_cast<const char *>(user);
+    std::ifstream file(path);
+    std::string line;
+    size_t colon;
+    /* First record of the name */
+    if (!file) {
+        log_error("Error: cannot open ", path);
+        return (-1);
+    }
+    while (std::getline(file, line)) {
+        std::string_view rec(line);
+        if (rec.ends_with('\r')) {
+            rec.remove_suffix(1);
+        }
+        colon = rec.find(':');
+        if (rec.empty() || (rec[0] == '#') ||
+            (colon == std::string_view::npos) ||
+            (rec.substr(0, colon) != name)) {
+            continue;
+        }
+        if (auth_cred_parse(rec.substr(colon + 1), cred) < 0) {
+            log_error("Error: wrong record of ", name, " in ", path);
+            return (-1);
+        }
+        return 0;
+    }
+    return 1;
+}
+
+static int auth_socket_lookup(void *const user, const std::string_view name,
+                              struct auth_cred *const cred) {
+    /* Variables */
+    const char *path = static_cast<const char *>(user);
+    const struct timeval tv = {.tv_sec = AUTH_SOCKET_TIMEOUT, .tv_usec = 0};
+    struct sockaddr_un addr = {};
+    std::string req;
+    char reply[256];
+    size_t len = 0;
+    ssize_t n;
+    int fd;
+    int result = (-1);
+    /* Connect (bounded waits, a stuck service refuses logins) */
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        log_error("Error: socket path too long ", path);
+        return (-1);
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return (-1);
+    }
+    if ((setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) ||
+        (setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0) ||
+        (connect(fd, reinterpret_cast<struct sockaddr *>(&addr),
+                 sizeof(addr)) < 0)) {
+        log_error("Error: credential service ", path, ": ", strerror(errno));
+        goto auth_socket_lookup_close;
+    }
+    /* "name\n" -> one line */
+    try {
+        req.assign(name).push_back('\n');
+    } catch (const std::bad_alloc& e) {
+        goto auth_socket_lookup_close;
+    }
+    if (send(fd, req.data(), req.size(), MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(req.size())) {
+        goto auth_socket_lookup_close;
+    }
+    while ((len < sizeof(reply)) &&
+           (memchr(reply, '\n', len) == NULL)) {
+        n = recv(fd, reply + len, sizeof(reply) - len, 0);
+        if (n <= 0) {
+            break;
+        }
+        len += static_cast<size_t>(n);
+    }
+    {
+        std::string_view text(reply, len);
+        const size_t eol = text.find('\n');
+        if (eol == std::string_view::npos) {
+            log_error("Error: no reply of the credential service ", path);
+            goto auth_socket_lookup_close;
+        }
+        text = text.substr(0, eol);
+        if (text.ends_with('\r')) {
+            text.remove_suffix(1);
+        }
+        if (text == "-") {
+            result = 1;
+        } else if (auth_cred_parse(text, cred) == 0) {
+            result = 0;
+        } else {
+            log_error("Error: wrong reply of the credential service ", path);
+        }
+    }
+
+auth_socket_lookup_close:
+    close(fd);
+    return result;
+}
+
+static int auth_cred_parse(std::string_view text,
+                           struct auth_cred *const cred) {
+    /* Variables */
+    const size_t c1 = text.find(':');
+    const size_t c2 = text.find(':', c1 + 1);
+    std::string rounds;
+    char *end;
+    unsigned long iter;
+    /* rounds:salt:hash */
+    if ((c1 == std::string_view::npos) || (c2 == std::string_view::npos)) {
+        return (-1);
+    }
+    rounds.assign(text.substr(0, c1));
+    iter = strtoul(rounds.c_str(), &end, 10);
+    if (rounds.empty() || (*end != '\0') || (iter == 0) ||
+        (iter > AUTH_ITER_MAX)) {
+        return (-1);
+    }
+    cred->iter = static_cast<unsigned>(iter);
+    cred->saltlen = (c2 - c1 - 1) / 2;
+    if ((cred->saltlen > AUTH_SALT_MAX) ||
+        (auth_unhex(text.substr(c1 + 1, c2 - c1 - 1), cred->salt,
+                    cred->saltlen) < 0) ||
+        (auth_unhex(text.substr(c2 + 1), cred->hash, AUTH_HASH_LEN) < 0)) {
+        return (-1);
+    }
+    return 0;
+}
+
+static int auth_unhex(const std::string_view text, uint8_t *const out,
+                      const size_t len) {
+    /* Variables */
+    auto digit = [](const char ch) {
+        return ((ch >= '0') && (ch <= '9')) ? (ch - '0') :
+               ((ch >= 'a') && (ch <= 'f')) ? (ch - 'a' + 10) :
+               ((ch >= 'A') && (ch <= 'F')) ? (ch - 'A' + 10) : (-1);
+    };
+    int hi;
+    int lo;
+    if (text.size() != (len * 2)) {
+        return (-1);
+    }
+    /* Pairs of digits */
+    for (size_t i = 0; i < len; ++i) {
+        hi = digit(text[2 * i]);
+        lo = digit(text[2 * i + 1]);
+        if ((hi < 0) || (lo < 0)) {
+            return (-1);
+        }
+        out[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return 0;
+}
+
+static std::string auth_cache_key(const struct auth_cache *const c,
+                                  const std::string_view name,
+                                  const std::string_view pass) {
+    /* Variables */
+    struct auth_hmac k;
+    struct auth_sha in;
+    std::string key(AUTH_HASH_LEN, '\0');
+    const uint8_t sep = 0;
+    /* HMAC(secret, name '\0' password) */
+    auth_hmac_init(&k, c->secret, sizeof(c->secret));
+    in = k.in;
+    auth_sha_update(&in, reinterpret_cast<const uint8_t *>(name.data()),
+                    name.size());
+    auth_sha_update(&in, &sep, 1);
+    auth_sha_update(&in, reinterpret_cast<const uint8_t *>(pass.data()),
+                    pass.size());
+    auth_sha_final(&in, reinterpret_cast<uint8_t *>(key.data()));
+    auth_hmac(&k, reinterpret_cast<const uint8_t *>(key.data()), key.size(),
+              reinterpret_cast<uint8_t *>(key.data()));
+    explicit_bzero(&in, sizeof(in));
+    return key;
+}
+
+static bool auth_cache_hit(struct auth_cache *const c, const std::string &key,
+                           const uint64_t now) {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    auto it = c->ent.find(key);
+    if (it == c->ent.end()) {
+        return false;
+    }
+    if (it->second <= now) {
+        c->ent.erase(it);
+        return false;
+    }
+    return true;
+}
+
+static void auth_cache_put(struct auth_cache *const c, const std::string &key,
+                           const uint64_t expiry) {
+    /* Variables */
+    const uint64_t now = tmr_now_ms();
+    std::lock_guard<std::mutex> lock(c->mutex);
+    /* Make room */
+    if (c->ent.size() >= AUTH_CACHE_MAX) {
+        std::erase_if(c->ent, [now](const auto &e) {
+            return e.second <= now;
+        });
+        if (c->ent.size() >= AUTH_CACHE_MAX) {
+            c->ent.clear();
+        }
+    }
+    try {
+        c->ent[key] = expiry;
+    } catch (const std::bad_alloc& e) {
+        /* Not cached, the next login hashes again */
+    }
+}
+
+static bool auth_equal(const uint8_t *const a, const uint8_t *const b) {
+    /* Variables */
+    uint8_t diff = 0;
+    /* Every byte, whatever differs first */
+    for (size_t i = 0; i < AUTH_HASH_LEN; ++i) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static void auth_sha_init(struct auth_sha *const c) {
+    c->h[0] = 0x6a09e667;
+    c->h[1] = 0xbb67ae85;
+    c->h[2] = 0x3c6ef372;
+    c->h[3] = 0xa54ff53a;
+    c->h[4] = 0x510e527f;
+    c->h[5] = 0x9b05688c;
+    c->h[6] = 0x1f83d9ab;
+    c->h[7] = 0x5be0cd19;
+    c->len = 0;
+    c->n = 0;
+}
+
+static void auth_sha_update(struct auth_sha *const c, const uint8_t *data,
+                            size_t len) {
+    /* Variables */
+    size_t take;
+    c->len += len;
+    /* Fill the partial block, then whole blocks straight from data */
+    if (c->n > 0) {
+        take = std::min(len, sizeof(c->buf) - c->n);
+        memcpy(c->buf + c->n, data, take);
+        c->n += take;
+        data += take;
+        len -= take;
+        if (c->n < sizeof(c->buf)) {
+            return;
+        }
+        auth_sha_block(c->h, c->buf);
+        c->n = 0;
+    }
+    for (; len >= sizeof(c->buf); data += 64, len -= 64) {
+        auth_sha_block(c->h, data);
+    }
+    memcpy(c->buf, data, len);
+    c->n = len;
+}
+
+static void auth_sha_final(struct auth_sha *const c, uint8_t *const out) {
+    /* Variables */
+    const uint64_t bits = c->len * 8;
+    /* 0x80, zeros, big endian length in bits */
+    c->buf[c->n++] = 0x80;
+    if (c->n > 56) {
+        memset(c->buf + c->n, 0, sizeof(c->buf) - c->n);
+        auth_sha_block(c->h, c->buf);
+        c->n = 0;
+    }
+    memset(c->buf + c->n, 0, 56 - c->n);
+    for (int i = 0; i < 8; ++i) {
+        c->buf[56 + i] = static_cast<uint8_t>(bits >> (56 - (8 * i)));
+    }
+    auth_sha_block(c->h, c->buf);
+    for (int i = 0; i < 8; ++i) {
+        out[4 * i] = static_cast<uint8_t>(c->h[i] >> 24);
+        out[4 * i + 1] = static_cast<uint8_t>(c->h[i] >> 16);
+        out[4 * i + 2] = static_cast<uint8_t>(c->h[i] >> 8);
+        out[4 * i + 3] = static_cast<uint8_t>(c->h[i]);
+    }
+}
+
+static void auth_sha_block(uint32_t *const h, const uint8_t *const p) {
+    /* Variables */
+    uint32_t w[64];
+    uint32_t v[8];
+    uint32_t t1;
+    uint32_t t2;
+    /* Message schedule */
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (static_cast<uint32_t>(p[4 * i]) << 24) |
+               (static_cast<uint32_t>(p[4 * i + 1]) << 16) |
+               (static_cast<uint32_t>(p[4 * i + 2]) << 8) |
+               static_cast<uint32_t>(p[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        const uint32_t s0 = std::rotr(w[i - 15], 7) ^
+                            std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = std::rotr(w[i - 2], 17) ^
+                            std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    /* 64 rounds */
+    memcpy(v, h, sizeof(v));
+    for (int i = 0; i < 64; ++i) {
+        t1 = v[7] + (std::rotr(v[4], 6) ^ std::rotr(v[4], 11) ^
+                     std::rotr(v[4], 25)) +
+             ((v[4] & v[5]) ^ (~v[4] & v[6])) + auth_k[i] + w[i];
+        t2 = (std::rotr(v[0], 2) ^ std::rotr(v[0], 13) ^
+              std::rotr(v[0], 22)) +
+             ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = v[4];
+        v[4] = v[3] + t1;
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = v[0];
+        v[0] = t1 + t2;
+    }
+    for (int i = 0; i < 8; ++i) {
+        h[i] += v[i];
+    }
+}
+
+static void auth_hmac_init(struct auth_hmac *const k, const uint8_t *const key,
+                           const size_t len) {
+    /* Variables */
+    uint8_t block[64] = {};
+    uint8_t pad[64];
+    /* Keys longer than a block are hashed first */
+    if (len > sizeof(block)) {
+        auth_sha_init(&k->in);
+        auth_sha_update(&k->in, key, len);
+        auth_sha_final(&k->in, block);
+    } else {
+        memcpy(block, key, len);
+    }
+    for (size_t i = 0; i < sizeof(pad); ++i) {
+        pad[i] = block[i] ^ 0x36;
+    }
+    auth_sha_init(&k->in);
+    auth_sha_update(&k->in, pad, sizeof(pad));
+    for (size_t i = 0; i < sizeof(pad); ++i) {
+        pad[i] = block[i] ^ 0x5c;
+    }
+    auth_sha_init(&k->out);
+    auth_sha_update(&k->out, pad, sizeof(pad));
+    explicit_bzero(block, sizeof(block));
+    explicit_bzero(pad, sizeof(pad));
+}
+
+static void auth_hmac(const struct auth_hmac *const k,
+                      const uint8_t *const data, const size_t len,
+                      uint8_t *const out) {
+    /* Variables */
+    struct auth_sha c = k->in;
+    uint8_t inner[AUTH_HASH_LEN];
+    /* H(key ^ opad || H(key ^ ipad || data)) */
+    auth_sha_update(&c, data, len);
+    auth_sha_final(&c, inner);
+    c = k->out;
+    auth_sha_update(&c, inner, sizeof(inner));
+    auth_sha_final(&c, out);
+}
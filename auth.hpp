@@ -0,0 +1,175 @@
+/**
+ * @file auth.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Login stage: credential backends, PBKDF2-SHA256 checks on the
+ * worker pool and a short-lived verification cache.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef AUTH_HPP
+#define AUTH_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr unsigned AUTH_TRIES = 3; /**< Failed logins before the close */
+constexpr size_t AUTH_LINE_MAX = 128; /**< Longest name or password */
+constexpr size_t AUTH_HASH_LEN = 32; /**< PBKDF2-SHA256 output, bytes */
+constexpr size_t AUTH_SALT_MAX = 64; /**< Longest salt, bytes */
+constexpr unsigned AUTH_ITER_MAX = 10000000; /**< Most PBKDF2 rounds */
+constexpr unsigned AUTH_ITER_DUMMY = 100000; /**< Rounds hashed for an
+                                                  unknown name */
+constexpr unsigned AUTH_INFLIGHT = 2; /**< Default of auth_inflight */
+constexpr uint64_t AUTH_CACHE_TTL = 30 * 1000; /**< Default of
+                                                    auth_cache_ms */
+constexpr size_t AUTH_CACHE_MAX = 4096; /**< Cached verifications */
+constexpr int AUTH_SOCKET_TIMEOUT = 2; /**< Credential service reply, s */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct sess;
+
+/**
+ * @brief Stored credentials of a name.
+ */
+struct auth_cred {
+    unsigned iter; /**< PBKDF2 rounds */
+    size_t saltlen; /**< Salt bytes */
+    uint8_t salt[AUTH_SALT_MAX]; /**< Salt */
+    uint8_t hash[AUTH_HASH_LEN]; /**< PBKDF2-HMAC-SHA256(password, salt) */
+};
+
+/**
+ * @brief Credential backend.
+ *
+ * lookup runs on a worker thread and may block: it returns 0 with cred
+ * filled, 1 for an unknown name, or -1 on failure (refused as well).
+ */
+struct auth_backend {
+    int (*lookup)(void *const user, const std::string_view name,
+                  struct auth_cred *const cred); /**< Finds a name */
+    void *user; /**< Passed back to lookup */
+};
+
+/**
+ * @brief Stage of a login.
+ */
+enum auth_stage : uint8_t {
+    AUTH_NAME = 0, /**< Reading the name (echoed) */
+    AUTH_PASS, /**< Reading the password (not echoed) */
+    AUTH_CHECK /**< Waiting for a hash slot or the worker */
+};
+
+/**
+ * @brief Login of a session (sess::login, set until it succeeds).
+ */
+struct auth_login {
+    enum auth_stage stage; /**< Stage */
+    bool cr; /**< Last key was '\r' (its '\n' is skipped) */
+    unsigned tries; /**< Failed attempts */
+    std::string name; /**< Entered name */
+    std::string pass; /**< Entered password, wiped once checked */
+    bool queued; /**< Waiting in rctr->authq */
+    std::list<struct sess *>::iterator it; /**< Position in rctr->authq */
+};
+
+/**
+ * @brief Successful verifications of the last auth_cache_ms.
+ *
+ * Keyed by HMAC-SHA256(secret, name '\0' password): a reconnecting
+ * client costs one fast hash, and the cache never holds a password or
+ * anything that checks one offline without the in-memory secret.
+ */
+struct auth_cache {
+    std::mutex mutex; /**< Protects ent */
+    std::unordered_map<std::string, uint64_t> ent; /**< Key -> expiry,
+                                                        tmr_now_ms() */
+    uint8_t secret[AUTH_HASH_LEN]; /**< Random key of the process */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Initializes the verification cache with a random secret.
+ *
+ * @param c The cache.
+ * @return int 0 on success, or -1 on failure (no random source).
+ */
+int auth_cache_init(struct auth_cache *const c);
+
+/**
+ * @brief Forgets every cached verification (credentials may have
+ * changed, done on reload).
+ *
+ * @param c The cache.
+ */
+void auth_cache_clear(struct auth_cache *const c);
+
+/**
+ * @brief Tells whether sessions must log in: an application backend is
+ * set or the "auth" setting names one.
+ *
+ * @param srv The server.
+ * @return bool true if a login is required.
+ */
+bool auth_required(struct srv *const srv);
+
+/**
+ * @brief Starts the login of a new session and queues "login: ".
+ *
+ * @param s The session.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int auth_start(struct sess *const s);
+
+/**
+ * @brief Checks the entered name and password: a cached verification
+ * completes at once, otherwise the hash runs on the worker pool (at
+ * most auth_inflight per reactor, the others wait in line).
+ *
+ * The result comes through parser_login_done().
+ *
+ * @param s The session (stage AUTH_CHECK).
+ * @return int 0 - continue, >0 - close the session, -1 - error.
+ */
+int auth_submit(struct sess *const s);
+
+/**
+ * @brief Drops a waiting login (session close).
+ *
+ * @param s The session.
+ */
+void auth_stop(struct sess *const s);
+
+/**
+ * @brief PBKDF2-HMAC-SHA256 with a AUTH_HASH_LEN output.
+ *
+ * @param pass Password.
+ * @param salt Salt.
+ * @param saltlen Salt bytes (<= AUTH_SALT_MAX).
+ * @param iter Rounds.
+ * @param out Receives the derived key.
+ */
+void auth_pbkdf2(const std::string_view pass, const uint8_t *const salt,
+                 const size_t saltlen, const unsigned iter,
+                 uint8_t *const out);
+
+#endif /* AUTH_HPP */
@@ -0,0 +1,640 @@
+/**
+ * @file bench.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Input path benchmark: replays client bytes through the parser
+ * FSM and the commands, with hardware counters per byte and per command;
+ * then the output encoding of command text, the rendering of records and
+ * the messaging rate of the reactor mailboxes.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "srv.hpp"
+#include "sess.hpp"
+#include "rctr.hpp"
+#include "parser.hpp"
+#include "hwc.hpp"
+#include "rec.hpp"
+#include "mbox.hpp"
+
+//==============================================================================
+// Definitions
+//==============================================================================
+constexpr size_t BENCH_OQ_MAX = 64 * 1024; /**< Queued output dropped above
+                                                (nothing is sent) */
+constexpr size_t BENCH_ROUNDS = 1000; /**< Rounds of the built-in trace */
+constexpr size_t BENCH_TEXT = 256 * 1024; /**< Command text encoded per
+                                               pass */
+constexpr size_t BENCH_RECORDS = 2048; /**< "who" records rendered per
+                                            pass */
+constexpr size_t BENCH_MSGS = 1 << 20; /**< Messages per mailbox phase */
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief Benchmark parameters (command line).
+ */
+struct bench_config {
+    const char *replay; /**< Client bytes to replay, NULL - built-in trace */
+    size_t chunk; /**< Bytes per read, 0 - phases "keys" (1) and "paste" */
+    unsigned iter; /**< Passes over the trace per phase */
+};
+
+/**
+ * @brief A session driven directly by the benchmark thread: a reactor
+ * that never runs its loop, so nothing but the input path is measured.
+ */
+struct bench_env {
+    struct srv *srv; /**< Server (no listener, no reactor threads) */
+    struct rctr *rctr; /**< Reactor of the session */
+    struct sess *sess; /**< The session */
+    int peer; /**< Client end of the session socket */
+    uint64_t commands; /**< Lines executed (on_command) */
+};
+
+/**
+ * @brief A message of the mailbox phases.
+ */
+struct bench_msg : public mbox_msg {
+    struct bench_msg *next; /**< Link of the locked list (baseline) */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Parses the command line.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments.
+ * @param cfg Receives the parameters.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int bench_args(int argc, char **argv, struct bench_config *const cfg);
+
+/**
+ * @brief Built-in trace: typed commands with edits, history recall and
+ * unknown commands, Enter as "\r\n" and "\r".
+ *
+ * @return std::string Client bytes.
+ */
+static std::string bench_trace();
+
+/**
+ * @brief Creates the server, the reactor and the session.
+ *
+ * @param env Receives the environment.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int bench_env_open(struct bench_env *const env);
+
+/**
+ * @brief Closes the session and frees the environment.
+ *
+ * @param env The environment.
+ */
+static void bench_env_close(struct bench_env *const env);
+
+/**
+ * @brief Feeds the trace in reads of the given size and reports the
+ * time and the counters of the phase.
+ *
+ * @param env The environment.
+ * @param h Counters.
+ * @param name Phase name.
+ * @param input Client bytes.
+ * @param chunk Bytes per read.
+ * @param iter Passes over the input.
+ * @return int 0 on success, or -1 if the trace closes the session.
+ */
+static int bench_phase(struct bench_env *const env, struct hwc *const h,
+                       const char *const name, const std::string &input,
+                       const size_t chunk, const unsigned iter);
+
+/**
+ * @brief Queues command text through the output encoding (sess_text) and
+ * reports the time and the counters per byte.
+ *
+ * @param env The environment.
+ * @param h Counters.
+ * @param name Phase name.
+ * @param text Command output.
+ * @param iter Passes over the text.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+static int bench_encode(struct bench_env *const env, struct hwc *const h,
+                        const char *const name, const std::string &text,
+                        const unsigned iter);
+
+/**
+ * @brief Renders "who" records into one output buffer (kept across the
+ * passes, as a session reuses its own), queues them through the output
+ * encoding and reports the time and the counters per output byte.
+ *
+ * @param env The environment.
+ * @param h Counters.
+ * @param name Phase name.
+ * @param fmt Rendering.
+ * @param iter Passes.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+static int bench_records(struct bench_env *const env, struct hwc *const h,
+                         const char *const name, const enum rec_fmt fmt,
+                         const unsigned iter);
+
+/**
+ * @brief Posts BENCH_MSGS messages from producer threads to this thread,
+ * woken through an eventfd as a reactor is, and reports the rate and the
+ * wakeups: through a mailbox (mbox.hpp), or through a mutex protected
+ * list with a wakeup per message (the reactor completions before it).
+ *
+ * @param name Phase name.
+ * @param producers Producer threads.
+ * @param lock Mutex baseline instead of the mailbox.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int bench_mailbox(const char *const name, const unsigned producers,
+                         const bool lock);
+
+/**
+ * @brief Prints the result line of a phase: key=value pairs, "-" for a
+ * counter that is not available.
+ */
+static void bench_report(const char *const name, const size_t chunk,
+                         const uint64_t bytes, const uint64_t cmds,
+                         const uint64_t ns,
+                         const struct hwc_sample *const sample);
+
+/**
+ * @brief on_command callback: counts executed lines.
+ */
+static void bench_on_command(struct srv *const srv, struct sess *const s,
+                             const std::string_view line, void *user);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int main(int argc, char **argv) {
+    /* Variables */
+    struct bench_config cfg = {
+        .replay = NULL,
+        .chunk = 0,
+        .iter = 20
+    };
+    struct bench_env env = {};
+    struct hwc h;
+    std::string input;
+    std::string avail;
+    int failed = 0;
+    /* Setup */
+    if (bench_args(argc, argv, &cfg) < 0) {
+        std::cout << "Usage: telnet_bench [--replay FILE] [--chunk BYTES]"
+                     " [--iter N]" << std::endl;
+        return 2;
+    }
+    if (cfg.replay != NULL) {
+        std::ifstream file(cfg.replay, std::ios::binary);
+        std::ostringstream text;
+        text << file.rdbuf();
+        if (!file || (text.tellp() <= 0)) {
+            std::cout << "Error: cannot read " << cfg.replay << std::endl;
+            return 1;
+        }
+        input = text.str();
+    } else {
+        input = bench_trace();
+    }
+    log_set_level(LOG_ERROR);
+    /* Counters: the benchmark runs without them, reported as "-" */
+    if (hwc_open(&h) < 0) {
+        std::cout << "hwc=none error=\"" << strerror(errno) << "\""
+                  << std::endl;
+    } else {
+        for (int i = 0; i < HWC_MAX; ++i) {
+            if (h.fd[i] >= 0) {
+                avail.append(avail.empty() ? "" : ",")
+                     .append(hwc_name(static_cast<enum hwc_id>(i)));
+            }
+        }
+        std::cout << "hwc=" << avail << std::endl;
+    }
+    if (bench_env_open(&env) < 0) {
+        std::cout << "Error: session setup" << std::endl;
+        hwc_close(&h);
+        return 1;
+    }
+    /* Phases: keystrokes as typed, then the same bytes pasted */
+    if (cfg.chunk != 0) {
+        failed = bench_phase(&env, &h, "replay", input, cfg.chunk, cfg.iter);
+    } else if ((bench_phase(&env, &h, "keys", input, 1, cfg.iter) < 0) ||
+               (bench_phase(&env, &h, "paste", input, sizeof(env.rctr->rbuf),
+                            cfg.iter) < 0)) {
+        failed = 1;
+    }
+    /* Output encoding: "\n" text (converted) and "\r\n" text (fast path) */
+    if (failed == 0) {
+        std::string text;
+        std::string crlf;
+        for (unsigned n = 0; text.size() < BENCH_TEXT; ++n) {
+            const std::string line = "  " + std::to_string(n) +
+                " 10.0.0.1:52000 rtt 120us cwnd 10 unacked 0 retrans 0";
+            text.append(line).append("\n");
+            crlf.append(line).append("\r\n");
+        }
+        if ((bench_encode(&env, &h, "encode_lf", text, cfg.iter) < 0) ||
+            (bench_encode(&env, &h, "encode_crlf", crlf, cfg.iter) < 0)) {
+            failed = 1;
+        }
+    }
+    /* Records: aligned text, JSON lines */
+    if ((failed == 0) &&
+        ((bench_records(&env, &h, "records_text", REC_TEXT, cfg.iter) < 0) ||
+         (bench_records(&env, &h, "records_json", REC_JSON, cfg.iter) < 0))) {
+        failed = 1;
+    }
+    /* Cross-thread messages: one and four producers */
+    if ((failed == 0) &&
+        ((bench_mailbox("mbox_1", 1, false) < 0) ||
+         (bench_mailbox("mbox_4", 4, false) < 0) ||
+         (bench_mailbox("lock_1", 1, true) < 0) ||
+         (bench_mailbox("lock_4", 4, true) < 0))) {
+        failed = 1;
+    }
+    bench_env_close(&env);
+    hwc_close(&h);
+    return (failed != 0) ? 1 : 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int bench_args(int argc, char **argv, struct bench_config *const cfg) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char *val = ((i + 1) < argc) ? argv[i + 1] : NULL;
+        if (val == NULL) {
+            return (-1);
+        }
+        if (arg == "--replay") {
+            cfg->replay = val;
+        } else if (arg == "--chunk") {
+            cfg->chunk = strtoul(val, NULL, 10);
+        } else if (arg == "--iter") {
+            cfg->iter = static_cast<unsigned>(strtoul(val, NULL, 10));
+        } else {
+            return (-1);
+        }
+        ++i;
+    }
+    return (cfg->iter > 0) ? 0 : (-1);
+}
+
+static std::string bench_trace() {
+    /* Variables */
+    std::string trace;
+    /* A session of an operator */
+    for (size_t i = 0; i < BENCH_ROUNDS; ++i) {
+        trace.append("config\r\n");
+        trace.append("Pinata\r");
+        trace.append("show interfaces brief\r\n");
+        trace.append("confg\x7f\x7fig\r\n"); /* Typo, fixed */
+        trace.append("\x1b[A\x1b[A\r"); /* Recalled */
+        trace.append("\r\n"); /* Empty line */
+    }
+    return trace;
+}
+
+static int bench_env_open(struct bench_env *const env) {
+    /* Variables */
+    struct srv_config srvcfg = {};
+    const struct srv_callbacks cbs = {
+        .on_connect = NULL,
+        .on_disconnect = NULL,
+        .on_command = bench_on_command,
+        .user = &env->commands
+    };
+    struct trns *t;
+    int sv[2];
+    /* Server and a reactor of its own (never started) */
+    env->peer = (-1);
+    env->srv = srv_create(&srvcfg, &cbs);
+    if (env->srv == NULL) {
+        return (-1);
+    }
+    env->rctr = new (std::nothrow) struct rctr;
+    if ((env->rctr == NULL) || (rctr_init(env->rctr, env->srv, 0) < 0)) {
+        delete env->rctr;
+        srv_destroy(env->srv);
+        return (-1);
+    }
+    /* Session over a socket pair (any transport policy) */
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) {
+        bench_env_close(env);
+        return (-1);
+    }
+    env->peer = sv[1];
+    t = trns_socket_create(sv[0]);
+    if (t == NULL) {
+        close(sv[0]);
+        bench_env_close(env);
+        return (-1);
+    }
+    env->sess = rctr_sess_open(env->rctr, t);
+    if (env->sess == NULL) {
+        bench_env_close(env);
+        return (-1);
+    }
+    env->sess->mode = SESS_TEXT;
+    return 0;
+}
+
+static void bench_env_close(struct bench_env *const env) {
+    if (env->sess != NULL) {
+        rctr_sess_close(env->sess);
+    }
+    if (env->peer >= 0) {
+        close(env->peer);
+    }
+    rctr_fini(env->rctr);
+    delete env->rctr;
+    srv_destroy(env->srv);
+}
+
+static int bench_phase(struct bench_env *const env, struct hwc *const h,
+                       const char *const name, const std::string &input,
+                       const size_t chunk, const unsigned iter) {
+    /* Variables */
+    struct sess *s = env->sess;
+    const uint64_t commands = env->commands;
+    const uint64_t bytes = static_cast<uint64_t>(input.size()) * iter;
+    struct hwc_sample sample;
+    uint64_t cmds;
+    uint64_t ns;
+    size_t len;
+    int result = 0;
+    /* Measure: parsing, commands and output queueing, no syscalls */
+    const auto start = std::chrono::steady_clock::now();
+    hwc_start(h);
+    for (unsigned n = 0; (n < iter) && (result == 0); ++n) {
+        for (size_t pos = 0; pos < input.size(); pos += len) {
+            len = std::min(chunk, input.size() - pos);
+            result = parser_feed(s, input.data() + pos, len);
+            if (result != 0) {
+                break;
+            }
+            if (sess_queued(s) > BENCH_OQ_MAX) {
+                oq_clear(&s->oq[OQ_INTERACTIVE], &env->rctr->chunks);
+                oq_clear(&s->oq[OQ_BULK], &env->rctr->chunks);
+            }
+        }
+    }
+    hwc_stop(h, &sample);
+    ns = static_cast<uint64_t>(std::chrono::duration_cast<
+        std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                  start).count());
+    oq_clear(&s->oq[OQ_INTERACTIVE], &env->rctr->chunks);
+    oq_clear(&s->oq[OQ_BULK], &env->rctr->chunks);
+    if (result != 0) {
+        std::cout << "Error: the input closes the session" << std::endl;
+        return (-1);
+    }
+    cmds = env->commands - commands;
+    bench_report(name, chunk, bytes, cmds, ns, &sample);
+    return 0;
+}
+
+static int bench_encode(struct bench_env *const env, struct hwc *const h,
+                        const char *const name, const std::string &text,
+                        const unsigned iter) {
+    /* Variables */
+    struct sess *s = env->sess;
+    const uint64_t bytes = static_cast<uint64_t>(text.size()) * iter;
+    struct hwc_sample sample;
+    uint64_t ns;
+    int result = 0;
+    /* Measure: scan and copy into pooled chunks */
+    const auto start = std::chrono::steady_clock::now();
+    hwc_start(h);
+    for (unsigned n = 0; (n < iter) && (result == 0); ++n) {
+        result = sess_text(s, text);
+        oq_clear(&s->oq[OQ_BULK], &env->rctr->chunks);
+    }
+    hwc_stop(h, &sample);
+    ns = static_cast<uint64_t>(std::chrono::duration_cast<
+        std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                  start).count());
+    if (result != 0) {
+        std::cout << "Error: out of memory" << std::endl;
+        return (-1);
+    }
+    bench_report(name, text.size(), bytes, 0, ns, &sample);
+    return 0;
+}
+
+static int bench_records(struct bench_env *const env, struct hwc *const h,
+                         const char *const name, const enum rec_fmt fmt,
+                         const unsigned iter) {
+    /* Variables */
+    struct sess *s = env->sess;
+    struct hwc_sample sample;
+    struct rec wr;
+    std::string out;
+    uint64_t bytes = 0;
+    uint64_t ns;
+    int result = 0;
+    /* Measure: render, then scan and copy into pooled chunks */
+    const auto start = std::chrono::steady_clock::now();
+    hwc_start(h);
+    for (unsigned n = 0; (n < iter) && (result == 0); ++n) {
+        out.clear();
+        rec_init(&wr, &out, fmt);
+        for (size_t i = 0; i < BENCH_RECORDS; ++i) {
+            rec_begin(&wr, "session");
+            rec_u64(&wr, "id", i + 1, 7);
+            rec_u64(&wr, "rctr", i % 4, 4);
+            rec_str(&wr, "peer", "10.0.0.1:52000", -21);
+            rec_u64(&wr, "rtt_us", 120 + i % 50, 7);
+            rec_u64(&wr, "rttvar_us", 30, 7);
+            rec_u64(&wr, "retrans", 0, 7);
+            rec_u64(&wr, "cwnd", 10, 6);
+            rec_u64(&wr, "unacked", 0, 8);
+            rec_end(&wr);
+        }
+        bytes += out.size();
+        result = sess_text(s, out);
+        oq_clear(&s->oq[OQ_BULK], &env->rctr->chunks);
+    }
+    hwc_stop(h, &sample);
+    ns = static_cast<uint64_t>(std::chrono::duration_cast<
+        std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                  start).count());
+    if (result != 0) {
+        std::cout << "Error: out of memory" << std::endl;
+        return (-1);
+    }
+    bench_report(name, out.size(), bytes, 0, ns, &sample);
+    return 0;
+}
+
+static int bench_mailbox(const char *const name, const unsigned producers,
+                         const bool lock) {
+    /* Variables */
+    struct bench_msg *const msgs = new (std::nothrow)
+                                   struct bench_msg[BENCH_MSGS];
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> wakeups(0);
+    std::mutex mutex;
+    struct bench_msg *list = NULL;
+    struct bench_msg *taken;
+    struct mbox m;
+    uint64_t got = 0;
+    uint64_t cnt;
+    uint64_t ns;
+    int efd;
+    /* Setup */
+    if (msgs == NULL) {
+        std::cout << "Error: out of memory" << std::endl;
+        return (-1);
+    }
+    efd = eventfd(0, EFD_CLOEXEC);
+    if (efd < 0) {
+        std::cout << "Error: eventfd" << std::endl;
+        delete[] msgs;
+        return (-1);
+    }
+    mbox_init(&m);
+    const auto start = std::chrono::steady_clock::now();
+    /* Producers: every producers-th message each */
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            const uint64_t one = 1;
+            bool wake = true;
+            for (size_t i = p; i < BENCH_MSGS; i += producers) {
+                if (lock) {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    msgs[i].next = list;
+                    list = &msgs[i];
+                } else {
+                    wake = mbox_push(&m, &msgs[i]);
+                }
+                if (wake) {
+                    wakeups.fetch_add(1, std::memory_order_relaxed);
+                    if (write(efd, &one, sizeof(one)) < 0) {
+                        /* Counter full: the consumer is woken anyway */
+                    }
+                }
+            }
+        });
+    }
+    /* Consumer: wait, arm, drain */
+    while (got < BENCH_MSGS) {
+        if (read(efd, &cnt, sizeof(cnt)) < 0) {
+            break;
+        }
+        if (lock) {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                taken = list;
+                list = NULL;
+            }
+            for (; taken != NULL; taken = taken->next) {
+                ++got;
+            }
+            continue;
+        }
+        mbox_arm(&m);
+        while (mbox_pop(&m) != NULL) {
+            ++got;
+        }
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    ns = static_cast<uint64_t>(std::chrono::duration_cast<
+        std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                  start).count());
+    close(efd);
+    delete[] msgs;
+    if (got != BENCH_MSGS) {
+        std::cout << "Error: " << got << " of " << BENCH_MSGS
+                  << " messages received" << std::endl;
+        return (-1);
+    }
+    /* One line of key=value pairs */
+    std::cout << std::fixed << std::setprecision(3)
+              << "phase=" << name << " producers=" << producers
+              << " messages=" << got << " ns=" << ns
+              << " ns_per_msg=" << (static_cast<double>(ns) / got)
+              << " msgs_per_s=" << (static_cast<double>(got) * 1e9 / ns)
+              << " wakeups=" << wakeups.load()
+              << " msgs_per_wakeup=" << (static_cast<double>(got) /
+                                         std::max<uint64_t>(wakeups, 1))
+              << std::endl;
+    return 0;
+}
+
+static void bench_report(const char *const name, const size_t chunk,
+                         const uint64_t bytes, const uint64_t cmds,
+                         const uint64_t ns,
+                         const struct hwc_sample *const sample) {
+    /* One line of key=value pairs, "-" - counter not available */
+    std::cout << std::fixed << std::setprecision(3)
+              << "phase=" << name << " chunk=" << chunk << " bytes=" << bytes
+              << " commands=" << cmds << " ns=" << ns
+              << " ns_per_byte=" << (static_cast<double>(ns) / bytes)
+              << " ns_per_cmd="
+              << ((cmds > 0) ? (static_cast<double>(ns) / cmds) : 0.0);
+    for (int i = 0; i < HWC_MAX; ++i) {
+        const char *key = hwc_name(static_cast<enum hwc_id>(i));
+        const double v = static_cast<double>(sample->v[i]);
+        if (!sample->valid[i]) {
+            std::cout << " " << key << "=- " << key << "_per_byte=- "
+                      << key << "_per_cmd=-";
+            continue;
+        }
+        std::cout << " " << key << "=" << sample->v[i]
+                  << " " << key << "_per_byte=" << (v / bytes)
+                  << " " << key << "_per_cmd="
+                  << ((cmds > 0) ? (v / cmds) : 0.0);
+    }
+    if (sample->valid[HWC_CYCLES] && sample->valid[HWC_INSTRUCTIONS] &&
+        (sample->v[HWC_CYCLES] > 0)) {
+        std::cout << " ipc=" << (static_cast<double>(
+                                     sample->v[HWC_INSTRUCTIONS]) /
+                                 sample->v[HWC_CYCLES]);
+    } else {
+        std::cout << " ipc=-";
+    }
+    std::cout << std::endl;
+}
+
+static void bench_on_command(struct srv *const, struct sess *const,
+                             const std::string_view, void *user) {
+    ++*static_cast<uint64_t *>(user);
+}
@@ -0,0 +1,330 @@
+/**
+ * @file cfg.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Runtime configuration: file parser and immutable snapshots.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string_view>
+#include "cfg.hpp"
+#include "auth.hpp"
+#include "plan.hpp"
+#include "rctr.hpp"
+#include "rpc.hpp"
+#include "shp.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Sets one key of a configuration.
+ *
+ * @param c The configuration.
+ * @param key Key.
+ * @param val Value.
+ * @return int 0 on success, or -1 on an unknown key or a wrong value.
+ */
+static int cfg_set(struct cfg *const c, const std::string_view key,
+                   const std::string &val);
+
+/**
+ * @brief Parses an unsigned number.
+ *
+ * @param val Text.
+ * @param min Smallest accepted value.
+ * @param max Largest accepted value.
+ * @param num Receives the number.
+ * @return int 0 on success, or -1 on a wrong value.
+ */
+static int cfg_num(const std::string &val, const uint64_t min,
+                   const uint64_t max, uint64_t *const num);
+
+/**
+ * @brief Adds (or replaces) a program: "NAME PATH [pty] [raw]".
+ *
+ * @param c The configuration.
+ * @param val The value.
+ * @return int 0 on success, or -1 on a wrong value.
+ */
+static int cfg_program(struct cfg *const c, const std::string &val);
+
+/**
+ * @brief Trims spaces and tabs at both ends.
+ */
+static std::string_view cfg_trim(std::string_view str);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void cfg_defaults(struct cfg *const c) {
+    c->log_level = LOG_INFO;
+    c->backlog = 0;
+    c->oq_high = RCTR_OQ_HIGH;
+    c->oq_low = RCTR_OQ_LOW;
+    c->rpc_inflight = RPC_INFLIGHT_MAX;
+    c->net_period = RCTR_NET_PERIOD;
+    c->rate_session = 0;
+    c->rate_global = 0;
+    c->hibernate = RCTR_HIB_IDLE;
+    c->keepalive = RCTR_ALIVE_IDLE;
+    c->keepalive_probes = RCTR_ALIVE_PROBES;
+    c->auth.clear();
+    c->auth_inflight = AUTH_INFLIGHT;
+    c->auth_cache = AUTH_CACHE_TTL;
+    c->script_dir.clear();
+    c->programs.clear();
+    c->reactors = 0;
+    c->workers = 0;
+    c->sessions_max = 0;
+    c->mem_limit = 0;
+}
+
+int cfg_parse(const char *const path, struct cfg *const c,
+              std::string *const err) {
+    /* Variables */
+    std::ifstream file(path);
+    std::string line;
+    struct cfg next = *c;
+    unsigned lineno = 0;
+    size_t eq;
+    /* Read */
+    if (!file) {
+        *err = std::string("cannot open ") + path;
+        return (-1);
+    }
+    while (std::getline(file, line)) {
+        ++lineno;
+        std::string_view text(line);
+        text = cfg_trim(text.substr(0, text.find('#')));
+        if (text.empty()) {
+            continue;
+        }
+        eq = text.find('=');
+        if ((eq == std::string_view::npos) ||
+            (cfg_set(&next, cfg_trim(text.substr(0, eq)),
+                     std::string(cfg_trim(text.substr(eq + 1)))) < 0)) {
+            *err = std::string(path) + ":" + std::to_string(lineno) +
+                   ": wrong setting " + std::string(text);
+            return (-1);
+        }
+    }
+    if (next.oq_low >= next.oq_high) {
+        *err = std::string(path) + ": oq_low must be below oq_high";
+        return (-1);
+    }
+    *c = next;
+    return 0;
+}
+
+int cfg_publish(struct cfg_store *const st, const struct cfg *const c) {
+    /* Variables */
+    std::shared_ptr<const struct cfg> snap;
+    try {
+        snap = std::make_shared<const struct cfg>(*c);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    /* Swap, the old snapshot lives on with the readers holding it */
+    std::lock_guard<std::mutex> lock(st->mutex);
+    st->cur.store(std::move(snap), std::memory_order_release);
+    st->gen.fetch_add(1, std::memory_order_release);
+    return 0;
+}
+
+void cfg_fini(struct cfg_store *const st) {
+    std::lock_guard<std::mutex> lock(st->mutex);
+    st->cur.store(std::shared_ptr<const struct cfg>());
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int cfg_set(struct cfg *const c, const std::string_view key,
+                   const std::string &val) {
+    /* Variables */
+    uint64_t num;
+    /* Keys */
+    if (key == "log_level") {
+        if (val == "error") {
+            c->log_level = LOG_ERROR;
+        } else if (val == "info") {
+            c->log_level = LOG_INFO;
+        } else if (val == "trace") {
+            c->log_level = LOG_TRACE;
+        } else {
+            return (-1);
+        }
+        return 0;
+    }
+    if (key == "backlog") {
+        if (cfg_num(val, 1, 65535, &num) < 0) {
+            return (-1);
+        }
+        c->backlog = static_cast<int>(num);
+    } else if (key == "oq_high") {
+        if (cfg_num(val, OQ_CHUNK_SIZE, UINT32_MAX, &num) < 0) {
+            return (-1);
+        }
+        c->oq_high = num;
+    } else if (key == "oq_low") {
+        if (cfg_num(val, 0, UINT32_MAX, &num) < 0) {
+            return (-1);
+        }
+        c->oq_low = num;
+    } else if (key == "rpc_inflight") {
+        if (cfg_num(val, 1, 1u << 20, &num) < 0) {
+            return (-1);
+        }
+        c->rpc_inflight = static_cast<unsigned>(num);
+    } else if (key == "net_period_ms") {
+        if (cfg_num(val, TMR_TICK_MS, 3600 * 1000, &num) < 0) {
+            return (-1);
+        }
+        c->net_period = num;
+    } else if (key == "rate_session") {
+        if (cfg_num(val, 0, SHP_RATE_MAX, &num) < 0) {
+            return (-1);
+        }
+        c->rate_session = num;
+    } else if (key == "rate_global") {
+        if (cfg_num(val, 0, SHP_RATE_MAX, &num) < 0) {
+            return (-1);
+        }
+        c->rate_global = num;
+    } else if (key == "hibernate_ms") {
+        if ((cfg_num(val, 0, UINT32_MAX, &num) < 0) ||
+            ((num != 0) && (num < RCTR_HIB_TICK))) {
+            return (-1);
+        }
+        c->hibernate = num;
+    } else if (key == "keepalive_ms") {
+        if ((cfg_num(val, 0, UINT32_MAX, &num) < 0) ||
+            ((num != 0) && (num < RCTR_ALIVE_TICK))) {
+            return (-1);
+        }
+        c->keepalive = num;
+    } else if (key == "keepalive_probes") {
+        if (cfg_num(val, 1, 100, &num) < 0) {
+            return (-1);
+        }
+        c->keepalive_probes = static_cast<unsigned>(num);
+    } else if (key == "auth") {
+        if (val == "none") {
+            c->auth.clear();
+        } else if (!tlnt_policy::feat::auth) {
+            return (-1); /* No login stage in this build */
+        } else if ((val.starts_with("file:") && (val.size() > 5)) ||
+                   (val.starts_with("socket:") && (val.size() > 7))) {
+            c->auth = val;
+        } else {
+            return (-1);
+        }
+    } else if (key == "auth_inflight") {
+        if (cfg_num(val, 1, 1024, &num) < 0) {
+            return (-1);
+        }
+        c->auth_inflight = static_cast<unsigned>(num);
+    } else if (key == "auth_cache_ms") {
+        if (cfg_num(val, 0, 24 * 3600 * 1000, &num) < 0) {
+            return (-1);
+        }
+        c->auth_cache = num;
+    } else if (key == "script_dir") {
+        if (val == "none") {
+            c->script_dir.clear();
+        } else if (val[0] == '/') {
+            c->script_dir = val;
+        } else {
+            return (-1);
+        }
+    } else if (key == "program") {
+        return tlnt_policy::feat::proc ? cfg_program(c, val) : (-1);
+    } else if ((key == "reactors") || (key == "workers")) {
+        if (cfg_num(val, 0, 1024, &num) < 0) {
+            return (-1);
+        }
+        ((key == "reactors") ? c->reactors : c->workers) =
+            static_cast<unsigned>(num);
+    } else if (key == "sessions_max") {
+        if (cfg_num(val, 0, 1u << 24, &num) < 0) {
+            return (-1);
+        }
+        c->sessions_max = static_cast<unsigned>(num);
+    } else if (key == "mem_limit") {
+        if ((cfg_num(val, 0, UINT64_MAX, &num) < 0) ||
+            ((num != 0) && (num < PLAN_BASE))) {
+            return (-1);
+        }
+        c->mem_limit = num;
+    } else {
+        return (-1);
+    }
+    return 0;
+}
+
+static int cfg_num(const std::string &val, const uint64_t min,
+                   const uint64_t max, uint64_t *const num) {
+    /* Variables */
+    char *end = NULL;
+    /* Digits only */
+    if (val.empty() || (val[0] < '0') || (val[0] > '9')) {
+        return (-1);
+    }
+    *num = strtoull(val.c_str(), &end, 10);
+    if ((*end != '\0') || (*num < min) || (*num > max)) {
+        return (-1);
+    }
+    return 0;
+}
+
+static int cfg_program(struct cfg *const c, const std::string &val) {
+    /* Variables */
+    std::istringstream in(val);
+    struct cfg_program prog = { .name = "", .path = "", .pty = false,
+                                .raw = false };
+    std::string word;
+    /* Name, absolute path, flags */
+    if (!(in >> prog.name >> prog.path) || (prog.path[0] != '/')) {
+        return (-1);
+    }
+    while (in >> word) {
+        if (word == "pty") {
+            prog.pty = true;
+        } else if (word == "raw") {
+            prog.raw = true;
+        } else {
+            return (-1);
+        }
+    }
+    for (struct cfg_program &p : c->programs) {
+        if (p.name == prog.name) {
+            p = prog;
+            return 0;
+        }
+    }
+    c->programs.push_back(prog);
+    return 0;
+}
+
+static std::string_view cfg_trim(std::string_view str) {
+    while (!str.empty() && ((str.front() == ' ') || (str.front() == '\t'))) {
+        str.remove_prefix(1);
+    }
+    while (!str.empty() && ((str.back() == ' ') || (str.back() == '\t') ||
+                            (str.back() == '\r'))) {
+        str.remove_suffix(1);
+    }
+    return str;
+}
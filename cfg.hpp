@@ -0,0 +1,148 @@
+/**
+ * @file cfg.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Runtime configuration: file parser and immutable snapshots.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef CFG_HPP
+#define CFG_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "policy.hpp"
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief A program run as a command (proc.hpp).
+ */
+struct cfg_program {
+    std::string name; /**< Command name */
+    std::string path; /**< Executable */
+    bool pty; /**< Runs on a pseudo terminal (interactive programs) */
+    bool raw; /**< Output goes out unencoded (pipes: spliced to the
+                   socket when nothing else is queued) */
+};
+
+/**
+ * @brief Tunables (one immutable snapshot per load).
+ *
+ * File format: "key = value" lines, "#" starts a comment, keys that are
+ * not in the file keep their defaults.
+ */
+struct cfg {
+    enum log_level log_level; /**< log_level = error | info | trace */
+    int backlog; /**< backlog - listen queue of the listener (0 - planned,
+                      plan.hpp) */
+    size_t oq_high; /**< oq_high - stop reading a session above, bytes */
+    size_t oq_low; /**< oq_low - resume reading below, bytes */
+    unsigned rpc_inflight; /**< rpc_inflight - RPC requests per session */
+    uint64_t net_period; /**< net_period_ms - TCP_INFO sample period */
+    uint64_t rate_session; /**< rate_session - output of a session, bytes/s
+                                (0 - unlimited), "rate" changes one */
+    uint64_t rate_global; /**< rate_global - output of the server, bytes/s
+                               (0 - unlimited) */
+    uint64_t hibernate; /**< hibernate_ms - idle time before a text session
+                             packs its line state (0 - never) */
+    uint64_t keepalive; /**< keepalive_ms - quiet time before a TCP text
+                             session is probed (0 - never) */
+    unsigned keepalive_probes; /**< keepalive_probes - unanswered probes
+                                    before the session is closed */
+    std::string auth; /**< auth = none | file:PATH | socket:PATH - login
+                           credentials (empty - no login) */
+    unsigned auth_inflight; /**< auth_inflight - login hashes on the
+                                 workers per reactor */
+    uint64_t auth_cache; /**< auth_cache_ms - lifetime of a verified login
+                              (0 - no cache) */
+    std::string script_dir; /**< script_dir = none | PATH - directory of
+                                 the "source" scripts (empty - none) */
+    std::vector<struct cfg_program> programs; /**< program = NAME PATH
+                                                   [pty] [raw], one line
+                                                   per program */
+    unsigned reactors; /**< reactors - reactor threads, read on start
+                            (0 - planned) */
+    unsigned workers; /**< workers - worker threads, read on start
+                           (0 - planned) */
+    unsigned sessions_max; /**< sessions_max - most sessions, new clients
+                                beyond are refused (0 - planned) */
+    uint64_t mem_limit; /**< mem_limit - memory the plan fits into, bytes,
+                             read on start (0 - the cgroup limit) */
+};
+
+/**
+ * @brief Published configuration.
+ *
+ * Snapshots are reference counted: the store holds the current one, a
+ * reactor pins the one it saw when its loop iteration began (rctr::conf,
+ * re-pinned only when gen moved) and work outside a reactor (commands,
+ * login jobs, a reload) holds its own reference. A replaced snapshot is
+ * freed with its last holder.
+ */
+struct cfg_store {
+    std::atomic<std::shared_ptr<const struct cfg>> cur; /**< Current
+                                                             snapshot */
+    std::atomic<uint64_t> gen = 0; /**< Publications so far */
+    std::mutex mutex; /**< Serializes publishers */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Fills a configuration with the built-in defaults.
+ *
+ * @param c The configuration.
+ */
+void cfg_defaults(struct cfg *const c);
+
+/**
+ * @brief Reads a configuration file over the values already in c.
+ *
+ * @param path Path of the file.
+ * @param c The configuration (unchanged on failure).
+ * @param err Receives the reason of a failure.
+ * @return int 0 on success, or -1 on failure.
+ */
+int cfg_parse(const char *const path, struct cfg *const c,
+              std::string *const err);
+
+/**
+ * @brief Publishes a copy of a configuration as the current snapshot.
+ *
+ * @param st The store.
+ * @param c The configuration.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int cfg_publish(struct cfg_store *const st, const struct cfg *const c);
+
+/**
+ * @brief Drops the current snapshot (freed with its last holder).
+ *
+ * @param st The store.
+ */
+void cfg_fini(struct cfg_store *const st);
+
+/**
+ * @brief Current snapshot, alive while the reference is held (any
+ * thread; a reactor reads its pinned rctr::conf instead).
+ */
+static inline std::shared_ptr<const struct cfg>
+cfg_hold(const struct cfg_store *const st) {
+    return st->cur.load(std::memory_order_acquire);
+}
+
+#endif /* CFG_HPP */
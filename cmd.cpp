@@ -0,0 +1,217 @@
+/**
+ * @file cmd.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Command registry and built-in commands.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <iostream>
+#include <mutex>
+#include "cmd.hpp"
+#include "rec.hpp"
+#include "sess.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief "help" - prints the usage hint and the list of commands.
+ *
+ * @param call Call context, call->user is the registry.
+ * @return int Always 0.
+ */
+static int cmd_help(struct cmd_call *const call);
+
+/**
+ * @brief "Pinata" - the classic.
+ *
+ * @param call Call context.
+ * @return int Always 0.
+ */
+static int cmd_pinata(struct cmd_call *const call);
+
+/**
+ * @brief "format [text|json]" - shows or sets how the calling session
+ * gets records (commands written with rec.hpp).
+ *
+ * @param call Call context.
+ * @return int 0 on success, -1 on a wrong argument.
+ */
+static int cmd_format(struct cmd_call *const call);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int cmd_register(struct cmd_registry *const reg, const std::string_view name,
+                 const cmd_handler handler, void *const user,
+                 const std::string_view help) {
+    /* Assertion */
+    if ((reg == NULL) || (handler == NULL) || name.empty()) {
+        std::cout << "Error: wrong command registration" << std::endl;
+        return (-1);
+    }
+    /* Register */
+    std::unique_lock<std::shared_mutex> lock(reg->mutex);
+    try {
+        reg->cmds[std::string(name)] = {
+            .handler = handler,
+            .user = user,
+            .help = std::string(help)
+        };
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    return 0;
+}
+
+int cmd_unregister(struct cmd_registry *const reg,
+                   const std::string_view name) {
+    std::unique_lock<std::shared_mutex> lock(reg->mutex);
+    auto fcmd = reg->cmds.find(name);
+    if (fcmd == reg->cmds.end()) {
+        return (-1);
+    }
+    reg->cmds.erase(fcmd);
+    return 0;
+}
+
+int cmd_register_builtins(struct cmd_registry *const reg) {
+    if (cmd_register(reg, "help", cmd_help, reg,
+                     "Show this help") < 0) {
+        return (-1);
+    }
+    if (cmd_register(reg, "Pinata", cmd_pinata, NULL,
+                     "Ask for a drink") < 0) {
+        return (-1);
+    }
+    if (cmd_register(reg, "format", cmd_format, NULL,
+                     "Output of records: format [text|json]") < 0) {
+        return (-1);
+    }
+    return 0;
+}
+
+void cmd_split(const std::string_view line,
+               std::vector<std::string_view> *const argv) {
+    /* Variables */
+    size_t pos = 0;
+    size_t end;
+    /* Split into words */
+    argv->clear();
+    while (pos < line.size()) {
+        if (line[pos] == ' ') {
+            ++pos;
+            continue;
+        }
+        end = line.find(' ', pos);
+        if (end == std::string_view::npos) {
+            end = line.size();
+        }
+        argv->push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+}
+
+bool cmd_exists(struct cmd_registry *const reg, const std::string_view name) {
+    std::shared_lock<std::shared_mutex> lock(reg->mutex);
+    return reg->cmds.find(name) != reg->cmds.end();
+}
+
+int cmd_run(struct cmd_registry *const reg, struct cmd_call *const call,
+            const std::string_view line) {
+    /* Variables */
+    struct cmd_entry entry = {};
+    /* Assertion */
+    if (call->argv.empty()) {
+        return 0;
+    }
+    /* Lookup (the handler runs without the lock) */
+    {
+        std::shared_lock<std::shared_mutex> lock(reg->mutex);
+        auto fcmd = reg->cmds.find(call->argv[0]);
+        if (fcmd != reg->cmds.end()) {
+            entry = fcmd->second;
+        }
+    }
+    if (entry.handler == NULL) {
+        call->out->append("Received command: ");
+        call->out->append(line);
+        call->out->append("\r\n");
+        return 0;
+    }
+    call->user = entry.user;
+    return entry.handler(call);
+}
+
+int cmd_exec(struct cmd_registry *const reg, struct cmd_call *const call,
+             const std::string_view line) {
+    cmd_split(line, &call->argv);
+    return cmd_run(reg, call, line);
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int cmd_help(struct cmd_call *const call) {
+    /* Variables */
+    struct cmd_registry *reg = static_cast<struct cmd_registry *>(call->user);
+    /* Usage */
+    call->out->append("Base Telnet Server \r\n");
+    call->out->append("Use ARROW_UP or ARROW_DOWN for restore command \r\n");
+    /* Commands */
+    std::shared_lock<std::shared_mutex> lock(reg->mutex);
+    for (const auto &[name, entry] : reg->cmds) {
+        call->out->append("  " + name);
+        if (!entry.help.empty()) {
+            call->out->append(" - " + entry.help);
+        }
+        call->out->append("\r\n");
+    }
+    return 0;
+}
+
+static int cmd_pinata(struct cmd_call *const call) {
+    call->out->append("Tequila! \r\n");
+    return 0;
+}
+
+static int cmd_format(struct cmd_call *const call) {
+    /* Variables */
+    static const char *const names[] = {"text", "json"};
+    struct rec wr;
+    enum rec_fmt fmt;
+    /* Arguments */
+    if ((call->sess == NULL) || (call->argv.size() > 2)) {
+        goto cmd_format_usage;
+    }
+    if (call->argv.size() == 2) {
+        if (call->argv[1] == names[REC_TEXT]) {
+            fmt = REC_TEXT;
+        } else if (call->argv[1] == names[REC_JSON]) {
+            fmt = REC_JSON;
+        } else {
+            goto cmd_format_usage;
+        }
+        call->sess->fmt.store(fmt, std::memory_order_relaxed);
+    }
+    /* The format in effect, in itself */
+    rec_call(&wr, call);
+    rec_begin(&wr, "format");
+    rec_label(&wr, "Format:");
+    rec_str(&wr, "format", names[wr.fmt], 0);
+    rec_end(&wr);
+    return 0;
+
+cmd_format_usage:
+    rec_call(&wr, call);
+    rec_line(&wr, "error", "Usage: format [text|json]");
+    return (-1);
+}
@@ -0,0 +1,143 @@
+/**
+ * @file cmd.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Command registry and built-in commands.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef CMD_HPP
+#define CMD_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <shared_mutex>
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct sess;
+struct pgr_src;
+
+/**
+ * @brief Arguments and output of a single command invocation.
+ */
+struct cmd_call {
+    struct srv *srv; /**< Server executing the command */
+    struct sess *sess; /**< Calling session */
+    std::vector<std::string_view> argv; /**< argv[0] is the command name */
+    std::string *out; /**< Output text (lines end with "\r\n") */
+    struct pgr_src **src; /**< A paging caller takes the rest of a long
+                               output as a producer here (pgr.hpp),
+                               NULL - everything goes to out */
+    void *user; /**< User pointer given at registration */
+};
+
+/**
+ * @brief Command handler.
+ *
+ * @return int 0 on success, <0 on command error, >0 closes the session.
+ */
+typedef int (*cmd_handler)(struct cmd_call *const call);
+
+/**
+ * @brief Registered command.
+ */
+struct cmd_entry {
+    cmd_handler handler; /**< Handler function */
+    void *user; /**< Passed back in cmd_call::user */
+    std::string help; /**< One line description */
+};
+
+/**
+ * @brief Command registry (thread-safe, many readers / rare writers).
+ */
+struct cmd_registry {
+    std::shared_mutex mutex;
+    std::map<std::string, struct cmd_entry, std::less<>> cmds;
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Registers (or replaces) a command.
+ *
+ * @param reg The registry.
+ * @param name Command name (first word of the input line).
+ * @param handler Handler function.
+ * @param user User pointer passed back to the handler.
+ * @param help One line description shown by "help".
+ * @return int 0 on success, or -1 on failure.
+ */
+int cmd_register(struct cmd_registry *const reg, const std::string_view name,
+                 const cmd_handler handler, void *const user,
+                 const std::string_view help);
+
+/**
+ * @brief Removes a command from the registry.
+ *
+ * @return int 0 on success, or -1 if the command is unknown.
+ */
+int cmd_unregister(struct cmd_registry *const reg,
+                   const std::string_view name);
+
+/**
+ * @brief Registers the built-in commands ("help", "Pinata").
+ *
+ * @param reg The registry.
+ * @return int 0 on success, or -1 on failure.
+ */
+int cmd_register_builtins(struct cmd_registry *const reg);
+
+/**
+ * @brief Splits a line into space separated words.
+ *
+ * @param line The input line.
+ * @param argv Receives the words (views into line).
+ */
+void cmd_split(const std::string_view line,
+               std::vector<std::string_view> *const argv);
+
+/**
+ * @brief Tells whether a command is registered.
+ */
+bool cmd_exists(struct cmd_registry *const reg, const std::string_view name);
+
+/**
+ * @brief Runs the command named by call->argv[0] (argv already split).
+ *
+ * Unknown commands are echoed back as "Received command: <line>".
+ *
+ * @param reg The registry.
+ * @param call Call context (srv, sess, argv and out must be set).
+ * @param line The input line.
+ * @return int Handler result (see cmd_handler).
+ */
+int cmd_run(struct cmd_registry *const reg, struct cmd_call *const call,
+            const std::string_view line);
+
+/**
+ * @brief Splits a line into words and runs the matching command.
+ *
+ * Unknown commands are echoed back as "Received command: <line>".
+ *
+ * @param reg The registry.
+ * @param call Call context (srv, sess and out must be set).
+ * @param line The input line.
+ * @return int Handler result (see cmd_handler).
+ */
+int cmd_exec(struct cmd_registry *const reg, struct cmd_call *const call,
+             const std::string_view line);
+
+#endif /* CMD_HPP */
@@ -0,0 +1,86 @@
+/**
+ * @file enc.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Output encoding of text sessions: bare LF to CRLF and IAC
+ * doubling, scanned 16 bytes at a time.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <bit>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "enc.hpp"
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+size_t enc_scan(const char *const data, size_t from, const size_t len,
+                const unsigned flags) {
+#ifdef __SSE2__
+    /* Variables */
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i iac = _mm_set1_epi8(static_cast<char>(0xff));
+    const bool dbl = (flags & ENC_IAC) != 0;
+    __m128i v;
+    __m128i m;
+    unsigned bits;
+    /* 16 bytes per compare, the first hit from the mask */
+    for (; (from + 16) <= len; from += 16) {
+        v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + from));
+        m = _mm_cmpeq_epi8(v, lf);
+        if (dbl) {
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, iac));
+        }
+        bits = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (bits != 0) {
+            return from + std::countr_zero(bits);
+        }
+    }
+#endif
+    /* Tail (or everything without SSE2) */
+    for (; from < len; ++from) {
+        if ((data[from] == '\n') ||
+            (((flags & ENC_IAC) != 0) && (data[from] == '\xff'))) {
+            return from;
+        }
+    }
+    return len;
+}
+
+int enc_append(struct oq *const q, oq_arena *const a, const char *const data,
+               const size_t len, const unsigned flags) {
+    /* Variables */
+    size_t run = 0; /**< Start of the bytes not queued yet */
+    size_t pos = 0;
+    bool cr;
+    /* Scan, copy unchanged runs, replace the hits */
+    while ((pos = enc_scan(data, pos, len, flags)) < len) {
+        if (data[pos] == '\n') {
+            cr = (pos > 0) ? (data[pos - 1] == '\r') :
+                 ((q->tail != NULL) && (q->tail->wr > q->tail->rd) &&
+                  (q->tail->data[q->tail->wr - 1] == '\r'));
+            if (cr || ((flags & ENC_CRLF) == 0)) {
+                ++pos; /* Already a line end, stays in the run */
+                continue;
+            }
+            if ((oq_append(q, a, data + run, pos - run) < 0) ||
+                (oq_append(q, a, "\r\n", 2) < 0)) {
+                return (-1);
+            }
+        } else if ((oq_append(q, a, data + run, pos - run) < 0) ||
+                   (oq_append(q, a, "\xff\xff", 2) < 0)) {
+            return (-1);
+        }
+        run = ++pos;
+    }
+    return oq_append(q, a, data + run, len - run);
+}
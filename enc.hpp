@@ -0,0 +1,60 @@
+/**
+ * @file enc.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Output encoding of text sessions: bare LF to CRLF and IAC
+ * doubling, scanned 16 bytes at a time.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef ENC_HPP
+#define ENC_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include "oq.hpp"
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr unsigned ENC_CRLF = 1 << 0; /**< "\n" not after "\r" -> "\r\n" */
+constexpr unsigned ENC_IAC = 1 << 1; /**< 0xFF -> IAC IAC (Telnet data) */
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Finds the first byte the encoding may change: '\n' (always) or
+ * 0xFF (with ENC_IAC).
+ *
+ * @param data Bytes.
+ * @param from Start offset.
+ * @param len Number of bytes.
+ * @param flags ENC_* flags.
+ * @return size_t Offset of the byte, or len if there is none.
+ */
+size_t enc_scan(const char *const data, size_t from, const size_t len,
+                const unsigned flags);
+
+/**
+ * @brief Encodes bytes into an output queue: runs that need no change
+ * are copied as they are (all of data in the common case, one copy).
+ *
+ * @param q The queue ("\r" at its tail counts for a leading "\n").
+ * @param a Chunk allocator.
+ * @param data Bytes.
+ * @param len Number of bytes.
+ * @param flags ENC_* flags.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int enc_append(struct oq *const q, oq_arena *const a, const char *const data,
+               const size_t len, const unsigned flags);
+
+#endif /* ENC_HPP */
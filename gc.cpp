@@ -13,7 +13,6 @@
 //==============================================================================
 // Includes
 //==============================================================================
-#include <iostream>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -22,6 +21,7 @@
 #include <unistd.h>
 #include <cstdlib>
 #include <sys/socket.h>
+#include "policy.hpp"
 
 //==============================================================================
 // Static Variables
@@ -48,7 +48,7 @@ void gc_register_socket(const int socket) {
     /* Mutex */
     std::lock_guard<std::mutex> lock(gc_mutex);
     /* Register Socket */
-    std::cout << "Register: socket " << socket << std::endl;
+    log_info("Register: socket ", socket);
     sockets.push_back(socket);
 }
 
@@ -58,18 +58,18 @@ void gc_unregister_socket(const int socket) {
     /* Unregister Socket */
     auto fsocket = std::find(sockets.begin(), sockets.end(), socket);
     if (fsocket != sockets.end()) {
-        std::cout << "Unregister: socket " << socket << std::endl;
+        log_info("Unregister: socket ", socket);
         sockets.erase(fsocket);
         shutdown(socket, SHUT_RDWR);
         close(socket);
-        std::cout << "Client disconnected" << std::endl;
+        log_info("Client disconnected");
     }
 }
 
 void gc_cleanup() {
     gc_cleanup_clients();
     std::this_thread::sleep_for(std::chrono::seconds(5));
-    std::cout << "Cleanup Success" << std::endl;
+    log_info("Cleanup Success");
 }
 
 //==============================================================================
@@ -82,9 +82,9 @@ static void gc_cleanup_clients() {
     if (sockets.size() == 0) {
         return;
     }
-    std::cout << "Cleanup All Clients" << std::endl;
+    log_info("Cleanup All Clients");
     for (int socket : sockets) {
-        std::cout << "Close: socket " << socket << std::endl;
+        log_info("Close: socket ", socket);
         shutdown(socket, SHUT_RDWR);
         close(socket);
     }
@@ -0,0 +1,142 @@
+/**
+ * @file hwc.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Hardware performance counters of the calling thread
+ * (perf_event_open), for benchmarks.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "hwc.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief A counter as read(2) returns it (PERF_FORMAT_TOTAL_TIME_*).
+ */
+struct hwc_read {
+    uint64_t value; /**< Count while scheduled */
+    uint64_t enabled; /**< Time enabled, ns */
+    uint64_t running; /**< Time actually counting, ns */
+};
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+/**
+ * @brief Event of every counter (type, config) and its report name.
+ */
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char *name;
+} hwc_events[HWC_MAX] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses"},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+     "l1d_misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "llc_misses"}
+};
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int hwc_open(struct hwc *const h) {
+    /* Variables */
+    struct perf_event_attr attr;
+    int first = 0;
+    int n = 0;
+    /* One group, led by the first event the host has */
+    h->leader = (-1);
+    for (int i = 0; i < HWC_MAX; ++i) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = hwc_events[i].type;
+        attr.config = hwc_events[i].config;
+        attr.disabled = (h->leader < 0) ? 1 : 0; /* Members follow */
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        h->fd[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0,
+                                            -1, h->leader,
+                                            PERF_FLAG_FD_CLOEXEC));
+        if (h->fd[i] < 0) {
+            first = (first == 0) ? errno : first;
+            continue;
+        }
+        if (h->leader < 0) {
+            h->leader = h->fd[i];
+        }
+        ++n;
+    }
+    if (n == 0) {
+        errno = first;
+        return (-1);
+    }
+    return n;
+}
+
+void hwc_start(struct hwc *const h) {
+    if (h->leader < 0) {
+        return;
+    }
+    ioctl(h->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(h->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void hwc_stop(struct hwc *const h, struct hwc_sample *const sample) {
+    /* Variables */
+    struct hwc_read rd;
+    /* Stop the group, then read every member */
+    if (h->leader >= 0) {
+        ioctl(h->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+    for (int i = 0; i < HWC_MAX; ++i) {
+        sample->v[i] = 0;
+        sample->valid[i] = false;
+        if ((h->fd[i] < 0) ||
+            (read(h->fd[i], &rd, sizeof(rd)) != sizeof(rd)) ||
+            (rd.running == 0)) {
+            continue;
+        }
+        /* Multiplexed with other users of the PMU: scale up */
+        sample->v[i] = (rd.running < rd.enabled) ?
+            static_cast<uint64_t>(static_cast<double>(rd.value) *
+                                  static_cast<double>(rd.enabled) /
+                                  static_cast<double>(rd.running)) :
+            rd.value;
+        sample->valid[i] = true;
+    }
+}
+
+void hwc_close(struct hwc *const h) {
+    for (int i = 0; i < HWC_MAX; ++i) {
+        if (h->fd[i] >= 0) {
+            close(h->fd[i]);
+            h->fd[i] = (-1);
+        }
+    }
+    h->leader = (-1);
+}
+
+const char *hwc_name(const enum hwc_id id) {
+    return hwc_events[id].name;
+}
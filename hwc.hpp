@@ -0,0 +1,94 @@
+/**
+ * @file hwc.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Hardware performance counters of the calling thread
+ * (perf_event_open), for benchmarks.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef HWC_HPP
+#define HWC_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Counted events.
+ */
+enum hwc_id {
+    HWC_CYCLES = 0, /**< CPU cycles */
+    HWC_INSTRUCTIONS, /**< Retired instructions */
+    HWC_BRANCH_MISSES, /**< Mispredicted branches */
+    HWC_L1D_MISSES, /**< L1 data cache read misses */
+    HWC_LLC_MISSES, /**< Last level cache misses */
+    HWC_MAX
+};
+
+/**
+ * @brief Counter group of a thread (user space only, so it works with
+ * the default perf_event_paranoid).
+ */
+struct hwc {
+    int fd[HWC_MAX]; /**< Counters, -1 - not available on this host */
+    int leader; /**< Group leader (one of fd), -1 - no counters at all */
+};
+
+/**
+ * @brief Counts of one measured phase.
+ */
+struct hwc_sample {
+    uint64_t v[HWC_MAX]; /**< Counts (scaled if the group was multiplexed) */
+    bool valid[HWC_MAX]; /**< The counter is available and was scheduled */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Opens the counters of the calling thread (stopped); missing
+ * events are skipped.
+ *
+ * @param h Receives the group.
+ * @return int Number of available counters, or -1 if there is none
+ * (errno of the first failure).
+ */
+int hwc_open(struct hwc *const h);
+
+/**
+ * @brief Resets and starts the counters (no-op without counters).
+ *
+ * @param h The group.
+ */
+void hwc_start(struct hwc *const h);
+
+/**
+ * @brief Stops the counters and reads them.
+ *
+ * @param h The group.
+ * @param sample Receives the counts (all invalid without counters).
+ */
+void hwc_stop(struct hwc *const h, struct hwc_sample *const sample);
+
+/**
+ * @brief Closes the counters.
+ *
+ * @param h The group.
+ */
+void hwc_close(struct hwc *const h);
+
+/**
+ * @brief Name of a counter for reports ("cycles", "l1d_misses", ...).
+ */
+const char *hwc_name(const enum hwc_id id);
+
+#endif /* HWC_HPP */
@@ -0,0 +1,74 @@
+/**
+ * @file io.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief I/O readiness backends (epoll, poll) for the reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef IO_HPP
+#define IO_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <poll.h>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr uint32_t IO_IN = 0x1; /**< Readable */
+constexpr uint32_t IO_OUT = 0x2; /**< Writable */
+constexpr uint32_t IO_ERR = 0x4; /**< Error or hang up */
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief A ready descriptor reported by a backend.
+ */
+struct io_event {
+    void *ptr; /**< Pointer registered with the descriptor */
+    uint32_t events; /**< IO_IN | IO_OUT | IO_ERR */
+};
+
+/**
+ * @brief epoll(7) backend, O(ready) per wait (data center builds).
+ */
+struct io_epoll {
+    int epfd = (-1); /**< epoll instance */
+
+    int init();
+    void fini();
+    int add(const int fd, const uint32_t events, void *const ptr);
+    int mod(const int fd, const uint32_t events, void *const ptr);
+    int del(const int fd);
+    int wait(struct io_event *const evs, const int max, const int timeout);
+};
+
+/**
+ * @brief poll(2) backend, O(registered) per wait, no extra kernel
+ * object (small embedded builds with a handful of sessions).
+ */
+struct io_poll {
+    std::vector<struct pollfd> fds; /**< Registered descriptors */
+    std::vector<void *> ptrs; /**< Pointers, same index as fds */
+    std::unordered_map<int, size_t> index; /**< fd -> index in fds */
+
+    int init();
+    void fini();
+    int add(const int fd, const uint32_t events, void *const ptr);
+    int mod(const int fd, const uint32_t events, void *const ptr);
+    int del(const int fd);
+    int wait(struct io_event *const evs, const int max, const int timeout);
+};
+
+#endif /* IO_HPP */
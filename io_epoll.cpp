@@ -0,0 +1,102 @@
+/**
+ * @file io_epoll.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief epoll(7) readiness backend.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "io.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Converts IO_* flags into epoll events.
+ */
+static uint32_t io_to_epoll(const uint32_t events);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int io_epoll::init() {
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    return (epfd < 0) ? (-1) : 0;
+}
+
+void io_epoll::fini() {
+    if (epfd >= 0) {
+        close(epfd);
+        epfd = (-1);
+    }
+}
+
+int io_epoll::add(const int fd, const uint32_t events, void *const ptr) {
+    struct epoll_event ev = {};
+    ev.events = io_to_epoll(events);
+    ev.data.ptr = ptr;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+int io_epoll::mod(const int fd, const uint32_t events, void *const ptr) {
+    struct epoll_event ev = {};
+    ev.events = io_to_epoll(events);
+    ev.data.ptr = ptr;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+int io_epoll::del(const int fd) {
+    return epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int io_epoll::wait(struct io_event *const evs, const int max,
+                   const int timeout) {
+    /* Variables */
+    struct epoll_event eevs[256];
+    int n;
+    /* Wait */
+    n = epoll_wait(epfd, eevs, std::min(max, 256), timeout);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : (-1);
+    }
+    for (int i = 0; i < n; ++i) {
+        evs[i].ptr = eevs[i].data.ptr;
+        evs[i].events = 0;
+        if (eevs[i].events & EPOLLIN) {
+            evs[i].events |= IO_IN;
+        }
+        if (eevs[i].events & EPOLLOUT) {
+            evs[i].events |= IO_OUT;
+        }
+        if (eevs[i].events & (EPOLLERR | EPOLLHUP)) {
+            evs[i].events |= IO_ERR;
+        }
+    }
+    return n;
+}
+
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static uint32_t io_to_epoll(const uint32_t events) {
+    uint32_t ev = 0;
+    if (events & IO_IN) {
+        ev |= EPOLLIN;
+    }
+    if (events & IO_OUT) {
+        ev |= EPOLLOUT;
+    }
+    return ev;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file io_poll.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief poll(2) readiness backend.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cerrno>
+#include "io.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Converts IO_* flags into poll events.
+ */
+static short io_to_poll(const uint32_t events);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int io_poll::init() {
+    fds.clear();
+    ptrs.clear();
+    index.clear();
+    return 0;
+}
+
+void io_poll::fini() {
+    init();
+}
+
+int io_poll::add(const int fd, const uint32_t events, void *const ptr) {
+    if (index.count(fd) != 0) {
+        errno = EEXIST;
+        return (-1);
+    }
+    try {
+        fds.push_back({.fd = fd, .events = io_to_poll(events), .revents = 0});
+        ptrs.push_back(ptr);
+        index[fd] = fds.size() - 1;
+    } catch (const std::bad_alloc& e) {
+        errno = ENOMEM;
+        return (-1);
+    }
+    return 0;
+}
+
+int io_poll::mod(const int fd, const uint32_t events, void *const ptr) {
+    auto fidx = index.find(fd);
+    if (fidx == index.end()) {
+        errno = ENOENT;
+        return (-1);
+    }
+    fds[fidx->second].events = io_to_poll(events);
+    ptrs[fidx->second] = ptr;
+    return 0;
+}
+
+int io_poll::del(const int fd) {
+    /* Variables */
+    auto fidx = index.find(fd);
+    size_t i;
+    /* Swap with the last one */
+    if (fidx == index.end()) {
+        errno = ENOENT;
+        return (-1);
+    }
+    i = fidx->second;
+    index.erase(fidx);
+    if (i != (fds.size() - 1)) {
+        fds[i] = fds.back();
+        ptrs[i] = ptrs.back();
+        index[fds[i].fd] = i;
+    }
+    fds.pop_back();
+    ptrs.pop_back();
+    return 0;
+}
+
+int io_poll::wait(struct io_event *const evs, const int max,
+                  const int timeout) {
+    /* Variables */
+    int n;
+    int cnt = 0;
+    /* Wait */
+    n = poll(fds.data(), fds.size(), timeout);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : (-1);
+    }
+    for (size_t i = 0; (i < fds.size()) && (cnt < max) && (n > 0); ++i) {
+        if (fds[i].revents == 0) {
+            continue;
+        }
+        --n;
+        evs[cnt].ptr = ptrs[i];
+        evs[cnt].events = 0;
+        if (fds[i].revents & POLLIN) {
+            evs[cnt].events |= IO_IN;
+        }
+        if (fds[i].revents & POLLOUT) {
+            evs[cnt].events |= IO_OUT;
+        }
+        if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            evs[cnt].events |= IO_ERR;
+        }
+        ++cnt;
+    }
+    return cnt;
+}
+
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static short io_to_poll(const uint32_t events) {
+    short ev = 0;
+    if (events & IO_IN) {
+        ev |= POLLIN;
+    }
+    if (events & IO_OUT) {
+        ev |= POLLOUT;
+    }
+    return ev;
+}
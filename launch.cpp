@@ -0,0 +1,245 @@
+/**
+ * @file launch.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Socket activation launcher: holds the listener and passes it to
+ * the server (LISTEN_FDS/LISTEN_PID), optionally on the first connection
+ * and again after every exit of the server.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <iostream>
+#include <string>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "tlnt.hpp"
+#include "tmr.hpp"
+#include "policy.hpp"
+
+//==============================================================================
+// Definitions
+//==============================================================================
+constexpr int LAUNCH_FD = 3; /**< Passed socket (LISTEN_FDS start) */
+constexpr unsigned LAUNCH_RESPAWN_MS = 1000; /**< Min lifetime of a server
+                                                  restarted without delay */
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief Launcher parameters (command line).
+ */
+struct launch_config {
+    in_port_t port; /**< Port to listen on */
+    int backlog; /**< Listen queue, holds clients while the server starts */
+    bool lazy; /**< Start the server on the first connection */
+    bool restart; /**< Start the server again after it exits */
+    char **argv; /**< Server command line */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Parses the command line.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments.
+ * @param cfg Receives the parameters.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int launch_args(int argc, char **argv, struct launch_config *const cfg);
+
+/**
+ * @brief Starts the server with the listener as fd 3.
+ *
+ * @param cfg Parameters.
+ * @param lfd Listening socket.
+ * @param mask Signal mask to restore in the server.
+ * @return pid_t Server process, or -1 on failure.
+ */
+static pid_t launch_spawn(const struct launch_config *const cfg, const int lfd,
+                          const sigset_t *const mask);
+
+/**
+ * @brief Waits until the listener has a pending connection or a signal
+ * arrives.
+ *
+ * @param lfd Listening socket.
+ * @param sigfd signalfd.
+ * @return int 0 - connection pending, 1 - signal pending (or failure).
+ */
+static int launch_wait_client(const int lfd, const int sigfd);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int main(int argc, char **argv) {
+    /* Variables */
+    struct launch_config cfg = {
+        .port = 2323,
+        .backlog = 128,
+        .lazy = false,
+        .restart = false,
+        .argv = NULL
+    };
+    sigset_t sigset;
+    sigset_t oldset;
+    struct signalfd_siginfo si;
+    pid_t child = (-1);
+    uint64_t started = 0;
+    bool stopping = false;
+    int status = 0;
+    int lfd;
+    int sigfd;
+    /* Setup */
+    if (launch_args(argc, argv, &cfg) < 0) {
+        std::cout << "Usage: telnet_launch [--port PORT] [--backlog N]"
+                     " [--lazy] [--restart] -- SERVER [ARGS...]" << std::endl;
+        return 2;
+    }
+    sigemptyset(&sigset);
+    sigaddset(&sigset, SIGINT);
+    sigaddset(&sigset, SIGTERM);
+    sigaddset(&sigset, SIGHUP);
+    sigaddset(&sigset, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &sigset, &oldset) < 0) {
+        return 1;
+    }
+    sigfd = signalfd(-1, &sigset, SFD_CLOEXEC);
+    lfd = tlnt_init_srv(cfg.port, cfg.backlog, INADDR_ANY);
+    if ((sigfd < 0) || (lfd < 0)) {
+        std::cout << "Error: listener on port " << cfg.port << std::endl;
+        return 1;
+    }
+    fcntl(lfd, F_SETFD, FD_CLOEXEC);
+    /* Supervise: the kernel queues clients while no server runs */
+    for (;;) {
+        /* Start the server (lazily: once a client is queued) */
+        if ((child < 0) && !stopping &&
+            (!cfg.lazy || (launch_wait_client(lfd, sigfd) == 0))) {
+            child = launch_spawn(&cfg, lfd, &oldset);
+            if (child < 0) {
+                status = 1;
+                break;
+            }
+            started = tmr_now_ms();
+        }
+        if (read(sigfd, &si, sizeof(si)) != sizeof(si)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (si.ssi_signo != SIGCHLD) {
+            /* Stop or reload: the server decides */
+            stopping = stopping || (si.ssi_signo != SIGHUP);
+            if (child > 0) {
+                kill(child, static_cast<int>(si.ssi_signo));
+            } else if (stopping) {
+                break;
+            }
+            continue;
+        }
+        /* The server exited */
+        if ((child < 0) || (waitpid(child, &status, WNOHANG) != child)) {
+            continue;
+        }
+        child = (-1);
+        status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+        std::cout << "telnet_launch: server exited with " << status
+                  << std::endl;
+        if (stopping || !cfg.restart) {
+            break;
+        }
+        if (tmr_now_ms() - started < LAUNCH_RESPAWN_MS) {
+            usleep(LAUNCH_RESPAWN_MS * 1000); /* Crash loop brake */
+        }
+    }
+    close(lfd);
+    close(sigfd);
+    return status;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int launch_args(int argc, char **argv, struct launch_config *const cfg) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char *val = ((i + 1) < argc) ? argv[i + 1] : NULL;
+        if (arg == "--") {
+            cfg->argv = &argv[i + 1];
+            return (val != NULL) ? 0 : (-1);
+        }
+        if (arg == "--lazy") {
+            cfg->lazy = true;
+            continue;
+        }
+        if (arg == "--restart") {
+            cfg->restart = true;
+            continue;
+        }
+        if (val == NULL) {
+            return (-1);
+        }
+        if (arg == "--port") {
+            cfg->port = static_cast<in_port_t>(strtoul(val, NULL, 10));
+        } else if (arg == "--backlog") {
+            cfg->backlog = static_cast<int>(strtol(val, NULL, 10));
+        } else {
+            return (-1);
+        }
+        ++i;
+    }
+    return (-1);
+}
+
+static pid_t launch_spawn(const struct launch_config *const cfg, const int lfd,
+                          const sigset_t *const mask) {
+    /* Variables */
+    const pid_t pid = fork();
+    /* Parent */
+    if (pid != 0) {
+        return pid;
+    }
+    /* Server: the listener becomes fd 3, without close-on-exec */
+    if (lfd == LAUNCH_FD) {
+        fcntl(lfd, F_SETFD, 0);
+    } else if (dup2(lfd, LAUNCH_FD) < 0) {
+        _exit(127);
+    }
+    setenv("LISTEN_FDS", "1", 1);
+    setenv("LISTEN_PID", std::to_string(getpid()).c_str(), 1);
+    sigprocmask(SIG_SETMASK, mask, NULL);
+    execvp(cfg->argv[0], cfg->argv);
+    std::cerr << "Error: exec " << cfg->argv[0] << std::endl;
+    _exit(127);
+}
+
+static int launch_wait_client(const int lfd, const int sigfd) {
+    /* Variables */
+    struct pollfd fds[2] = {
+        {.fd = lfd, .events = POLLIN, .revents = 0},
+        {.fd = sigfd, .events = POLLIN, .revents = 0}
+    };
+    int rc;
+    /* Wait (signals first: a stop wins over a queued client) */
+    do {
+        rc = poll(fds, 2, -1);
+    } while ((rc < 0) && (errno == EINTR));
+    return ((fds[1].revents != 0) || (fds[0].revents == 0)) ? 1 : 0;
+}
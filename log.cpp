@@ -0,0 +1,42 @@
+/**
+ * @file log.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Serialized standard output logger (log_stdout policy) and fatal
+ * errors to the standard error.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <iostream>
+#include <mutex>
+#include "policy.hpp"
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+static std::mutex log_mutex; /**< One message at a time */
+
+//==============================================================================
+// Global Variables
+//==============================================================================
+std::atomic<int> log_stdout::level(LOG_INFO);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void log_stdout::write(const enum log_level, const std::string &msg) {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::cout << msg << std::endl;
+}
+
+void log_fatal_write(const std::string &msg) {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::cerr << msg << std::endl;
+}
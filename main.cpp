@@ -2,7 +2,7 @@
  * @file main.cpp
  * @author Konstantin Kamyshanov (kkamyshanov)
  * @brief The Main.
- * @version 0.1.1
+ * @version 0.2.0
  * @date 2025-05-17
  *
  * @copyright Copyright (c) 2025
@@ -14,78 +14,48 @@
 //==============================================================================
 // Includes
 //==============================================================================
-#include <iostream>
-#include <thread>
-#include <unistd.h>
-#include "tlnt.hpp"
-#include "parser.hpp"
+#include "srv.hpp"
 #include "gc.hpp"
 
-//==============================================================================
-// Static Variables
-//==============================================================================
-static volatile int srvsocket = (-1); /**< Server socket (listening) */
-static volatile int signal_exit = (-1); /**< Server socket (listening) */
-
-//==============================================================================
-// Static Function Declarations
-//==============================================================================
-/**
- * @brief Signal handler function.
- * 
- * This function is called when a signal (such as SIGINT, SIGTERM, or SIGHUP)
- * is received.
- * It sets a global flag indicating the program should terminate,
- * and closes the server socket to unblock any blocking calls like accept().
- * 
- * @param signum The signal number received by the program.
- */
-static void signal_handler(int signum);
-
 //==============================================================================
 // Global Function Definitions
 //==============================================================================
-int main() {
-    /* TODO: Mutex Logger for Threading */
+int main(int argc, char **argv) {
     /* Telnet Configurations */
     constexpr in_port_t TELNET_PORT = 2323;
+    constexpr const char *ADMIN_PATH = "telnet_admin.sock";
     constexpr int LISTEN_QUEUE = 5;
     /* Variables */
-    int clntsocket; /**< Client socket (accepted connection) */
-    /* Signals Handlers */
-    signal(SIGINT, signal_handler); /* Ctrl+C */
-    signal(SIGTERM, signal_handler); /* kill <pid> */
-    signal(SIGHUP, signal_handler); /* close terminal */
-    /* signal(SIGQUIT, signal_handler); mem dump */
-    /* Init socket */
-    srvsocket = tlnt_init_srv(TELNET_PORT, LISTEN_QUEUE);
-    if (srvsocket < 0) {
-        std::cout << "Error: tlnt_init_srv" << std::endl;
+    const struct srv_config cfg = {
+        .port = TELNET_PORT,
+        .lqueue = LISTEN_QUEUE,
+        .cfgfile = (argc > 1) ? argv[1] : NULL, /* telnet_server [config] */
+        .signals = true, /* SIGINT/SIGTERM stop, SIGHUP reloads cfgfile */
+        .inherit = true, /* LISTEN_FDS from a supervisor (telnet_launch) */
+        .admport = 0, /* Opt-in: local TCP admin listener */
+        .admpath = ADMIN_PATH /* Admin sessions on a reactor of their own,
+                                 owner only socket in the working dir */
+    };
+    struct srv *srv; /**< Telnet server */
+    int signal_exit; /**< Received signal */
+    /* Init Server */
+    srv = srv_create(&cfg, NULL);
+    if (srv == NULL) {
+        log_fatal("Error: srv_create");
         return 1;
     }
-    /* Client Threading */
-    for (;signal_exit == (-1);) {
-        clntsocket = tlnt_accept_clnt(srvsocket);
-        if (clntsocket >= 0) {
-            gc_register_socket(clntsocket);
-            std::thread(parser_handler, clntsocket).detach();
-        }
+    if (srv_start(srv) < 0) {
+        log_fatal("Error: srv_start");
+        srv_destroy(srv);
+        return 1;
     }
-    std::cout << " - Get signal_exit: " << signal_exit << std::endl;
-    std::cout << "Finish the Telnet Server " << std::endl;
+    /* Signals are consumed by the event loop, wait for a stop */
+    signal_exit = srv_wait(srv);
+    log_info(" - Get signal_exit: ", signal_exit);
+    log_info("Finish the Telnet Server ");
     /* Cleanup */
+    srv_stop(srv);
+    srv_destroy(srv);
     gc_cleanup();
     return 0;
 }
-
-//==============================================================================
-// Static Function Definitions
-//==============================================================================
-static void signal_handler(int signum) {
-    if ((srvsocket >= 0)) {
-        shutdown(srvsocket, SHUT_RDWR);
-        close(srvsocket); /* wake up for client accept() */
-        srvsocket = (-1);
-    }
-    signal_exit = signum;
-}
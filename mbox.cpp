@@ -0,0 +1,96 @@
+/**
+ * @file mbox.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Lock-free multi-producer single-consumer mailbox (intrusive
+ * Vyukov queue) with batched wakeups of the consumer.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include "mbox.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Links a message after the newest one.
+ *
+ * Between the exchange and the store the queue is cut: the consumer
+ * sees the messages up to the previous one only.
+ */
+static void mbox_link(struct mbox *const m, struct mbox_msg *const msg);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void mbox_init(struct mbox *const m) {
+    m->stub.link.store(NULL, std::memory_order_relaxed);
+    m->head.store(&m->stub, std::memory_order_relaxed);
+    m->tail = &m->stub;
+    m->woken.store(false, std::memory_order_relaxed);
+}
+
+bool mbox_push(struct mbox *const m, struct mbox_msg *const msg) {
+    mbox_link(m, msg);
+    return mbox_signal(m);
+}
+
+bool mbox_signal(struct mbox *const m) {
+    /* Ordered with mbox_arm() on the flag: either the consumer is woken
+     * already and its drain sees the message, or this call wakes it */
+    return !m->woken.exchange(true, std::memory_order_acq_rel);
+}
+
+void mbox_arm(struct mbox *const m) {
+    m->woken.exchange(false, std::memory_order_acq_rel);
+}
+
+struct mbox_msg *mbox_pop(struct mbox *const m) {
+    /* Variables */
+    struct mbox_msg *tail = m->tail;
+    struct mbox_msg *next = tail->link.load(std::memory_order_acquire);
+    /* Step over the stub */
+    if (tail == &m->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        m->tail = next;
+        tail = next;
+        next = next->link.load(std::memory_order_acquire);
+    }
+    if (next != NULL) {
+        m->tail = next;
+        return tail;
+    }
+    /* tail is the last message linked: a post is half done, or the stub
+     * goes behind it so that it can be taken */
+    if (tail != m->head.load(std::memory_order_acquire)) {
+        return NULL;
+    }
+    mbox_link(m, &m->stub);
+    next = tail->link.load(std::memory_order_acquire);
+    if (next != NULL) {
+        m->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void mbox_link(struct mbox *const m, struct mbox_msg *const msg) {
+    /* Variables */
+    struct mbox_msg *prev;
+    /* Claim the head, then link the previous newest */
+    msg->link.store(NULL, std::memory_order_relaxed);
+    prev = m->head.exchange(msg, std::memory_order_acq_rel);
+    prev->link.store(msg, std::memory_order_release);
+}
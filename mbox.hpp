@@ -0,0 +1,90 @@
+/**
+ * @file mbox.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Lock-free multi-producer single-consumer mailbox (intrusive
+ * Vyukov queue) with batched wakeups of the consumer.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef MBOX_HPP
+#define MBOX_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <atomic>
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Message link, embedded (as a base) into the message.
+ */
+struct mbox_msg {
+    std::atomic<struct mbox_msg *> link; /**< Next newer message */
+};
+
+/**
+ * @brief Mailbox: any thread posts, one thread takes, in posting order.
+ *
+ * A post is one exchange and one store; the consumer wakeup (an eventfd
+ * write by the caller) is asked for only by the first post after the
+ * consumer armed, so a burst of posts costs a single wakeup.
+ */
+struct mbox {
+    std::atomic<struct mbox_msg *> head; /**< Newest message (producers) */
+    struct mbox_msg *tail; /**< Oldest message (consumer) */
+    struct mbox_msg stub; /**< Placeholder keeping the queue non-empty */
+    std::atomic<bool> woken; /**< A wakeup is pending since the last arm */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Initializes an empty mailbox (before it is shared).
+ *
+ * @param m The mailbox.
+ */
+void mbox_init(struct mbox *const m);
+
+/**
+ * @brief Posts a message (any thread).
+ *
+ * @param m The mailbox.
+ * @param msg The message, owned by the consumer until taken.
+ * @return bool true if the caller has to wake the consumer.
+ */
+bool mbox_push(struct mbox *const m, struct mbox_msg *const msg);
+
+/**
+ * @brief Asks for a wakeup without a message (work queued elsewhere).
+ *
+ * @param m The mailbox.
+ * @return bool true if the caller has to wake the consumer.
+ */
+bool mbox_signal(struct mbox *const m);
+
+/**
+ * @brief Consumer: accepts wakeups again; called once woken, before the
+ * mailbox is drained, so a post racing the drain wakes it once more.
+ *
+ * @param m The mailbox.
+ */
+void mbox_arm(struct mbox *const m);
+
+/**
+ * @brief Consumer: takes the oldest message.
+ *
+ * @param m The mailbox.
+ * @return struct mbox_msg* The message, or NULL if there is none (or the
+ * next one is half posted: its producer asks for a wakeup after it).
+ */
+struct mbox_msg *mbox_pop(struct mbox *const m);
+
+#endif /* MBOX_HPP */
@@ -0,0 +1,348 @@
+/**
+ * @file mux.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Logical channels multiplexed over one connection.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <arpa/inet.h>
+#include "mux.hpp"
+#include "sess.hpp"
+#include "rctr.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief Virtual transport of a channel: output becomes DATA frames of
+ * the connection, input arrives through mux_feed().
+ */
+struct mux_chan : public trns {
+    struct sess *parent; /**< Session of the connection */
+    struct sess *sess; /**< Session of the channel */
+    uint32_t id; /**< Channel number */
+    uint32_t txcredit; /**< DATA bytes the client still accepts */
+    uint32_t rxwindow; /**< DATA bytes the client may still send */
+    uint32_t owed; /**< Consumed input not credited back yet */
+    bool peerclosed; /**< MUX_CLOSE received, do not echo it */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Handles one complete frame.
+ *
+ * @return int 0 on success, <0 on error, >0 to close the connection.
+ */
+static int mux_frame(struct sess *const s, const uint32_t id,
+                     const uint8_t type, const std::string_view payload);
+
+/**
+ * @brief Opens a channel and starts its session.
+ *
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+static int mux_open(struct sess *const s, const uint32_t id);
+
+/**
+ * @brief Queues a frame on the connection.
+ *
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+static int mux_send_frame(struct sess *const s, const uint32_t id,
+                          const enum mux_type type,
+                          const std::string_view payload);
+
+static ssize_t mux_chan_recv(struct trns *const t, void *buf,
+                             const size_t len);
+static ssize_t mux_chan_send(struct trns *const t, const void *buf,
+                             const size_t len);
+static void mux_chan_shutdown(struct trns *const t);
+static int mux_chan_nonblock(struct trns *const t);
+static void mux_chan_destroy(struct trns *const t);
+
+/**
+ * @brief Credits consumed input back to the client unless the channel
+ * output is backpressured (no IO_IN interest).
+ */
+static int mux_chan_interest(struct trns *const t, const uint32_t events);
+
+/**
+ * @brief Reads a big endian 32-bit value.
+ */
+static uint32_t mux_get32(const char *const p);
+
+/**
+ * @brief Writes a big endian 32-bit value.
+ */
+static void mux_put32(char *const p, const uint32_t v);
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+static const struct trns_ops mux_chan_ops = {
+    .recv = mux_chan_recv,
+    .send = mux_chan_send,
+    .shutdown = mux_chan_shutdown,
+    .nonblock = mux_chan_nonblock,
+    .destroy = mux_chan_destroy,
+    .interest = mux_chan_interest
+};
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int mux_start(struct sess *const s) {
+    try {
+        s->mux = std::make_unique<struct mux>();
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    s->mux->closing = false;
+    s->mode = SESS_MUX;
+    log_info("Channel mode: ", s->id);
+    return 0;
+}
+
+int mux_feed(struct sess *const s, const char *data, const size_t len) {
+    /* Variables */
+    size_t pos = 0;
+    uint32_t size;
+    const char *p;
+    int result;
+    /* Frames */
+    try {
+        s->buf.append(data, len);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    while (!s->closing && ((s->buf.size() - pos) >= MUX_HDR)) {
+        p = s->buf.data() + pos;
+        size = mux_get32(p + 5);
+        if (size > MUX_FRAME_MAX) {
+            log_error("Error: channel frame of ", size, " bytes");
+            return 1;
+        }
+        if ((s->buf.size() - pos - MUX_HDR) < size) {
+            break;
+        }
+        result = mux_frame(s, mux_get32(p), static_cast<uint8_t>(p[4]),
+                           std::string_view(p + MUX_HDR, size));
+        if (result != 0) {
+            return result;
+        }
+        pos += MUX_HDR + size;
+    }
+    s->buf.erase(0, pos);
+    return 0;
+}
+
+void mux_close(struct sess *const s) {
+    /* Channels do not touch the table from now on */
+    s->mux->closing = true;
+    for (auto &[id, c] : s->mux->chans) {
+        rctr_sess_close(c->sess);
+    }
+    s->mux->chans.clear();
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int mux_frame(struct sess *const s, const uint32_t id,
+                     const uint8_t type, const std::string_view payload) {
+    /* Variables */
+    auto fchan = s->mux->chans.find(id);
+    struct mux_chan *c = (fchan != s->mux->chans.end()) ? fchan->second : NULL;
+    int result;
+    /* Frames of closed channels may still be in flight, skip them */
+    switch (type) {
+    case MUX_OPEN:
+        if (c != NULL) {
+            log_error("Error: channel ", id, " is already open");
+            return 1;
+        }
+        if (s->mux->chans.size() >= MUX_CHANS_MAX) {
+            return mux_send_frame(s, id, MUX_CLOSE, {});
+        }
+        return mux_open(s, id);
+    case MUX_DATA:
+        if (c == NULL) {
+            return 0;
+        }
+        if (payload.size() > c->rxwindow) {
+            log_error("Error: channel ", id, " overran its credit");
+            return 1;
+        }
+        c->rxwindow -= payload.size();
+        c->owed += payload.size();
+        c->sess->active_at = tmr_now_ms();
+        result = parser_feed(c->sess, payload.data(), payload.size());
+        if (result < 0) {
+            log_error("Error: parser_fsm");
+        }
+        if ((rctr_sess_flush(c->sess) == 0) && (result != 0)) {
+            rctr_sess_close(c->sess);
+        }
+        return 0;
+    case MUX_CLOSE:
+        if (c != NULL) {
+            c->peerclosed = true;
+            rctr_sess_close(c->sess);
+        }
+        return 0;
+    case MUX_CREDIT:
+        if ((c == NULL) || (payload.size() != 4)) {
+            return 0;
+        }
+        c->txcredit += std::min(mux_get32(payload.data()),
+                                UINT32_MAX - c->txcredit);
+        rctr_sess_flush(c->sess);
+        return 0;
+    default:
+        log_error("Error: channel frame type ", static_cast<unsigned>(type));
+        return 1;
+    }
+}
+
+static int mux_open(struct sess *const s, const uint32_t id) {
+    /* Variables */
+    struct mux_chan *c = new (std::nothrow) struct mux_chan;
+    struct sess *cs;
+    if (c == NULL) {
+        return (-1);
+    }
+    c->ops = &mux_chan_ops;
+    c->fd = (-1);
+    c->parent = s;
+    c->sess = NULL;
+    c->id = id;
+    c->txcredit = MUX_WINDOW;
+    c->rxwindow = MUX_WINDOW;
+    c->owed = 0;
+    c->peerclosed = false;
+    try {
+        s->mux->chans[id] = c;
+    } catch (const std::bad_alloc& e) {
+        delete c;
+        return (-1);
+    }
+    /* Session of the channel (destroys c and answers MUX_CLOSE on failure) */
+    cs = rctr_sess_open(s->rctr, c);
+    if (cs == NULL) {
+        return 0;
+    }
+    c->sess = cs;
+    cs->mode = SESS_TEXT;
+    cs->parent = s;
+    std::lock_guard<std::mutex> lock(s->rctr->mutex);
+    snprintf(cs->peer, sizeof(cs->peer), "mux:%lu/%u", s->id, id);
+    return 0;
+}
+
+static int mux_send_frame(struct sess *const s, const uint32_t id,
+                          const enum mux_type type,
+                          const std::string_view payload) {
+    /* Variables */
+    char hdr[MUX_HDR];
+    /* Frame */
+    mux_put32(hdr, id);
+    hdr[4] = static_cast<char>(type);
+    mux_put32(hdr + 5, static_cast<uint32_t>(payload.size()));
+    if (sess_write(s, hdr, sizeof(hdr)) < 0) {
+        return (-1);
+    }
+    return sess_write(s, payload);
+}
+
+static ssize_t mux_chan_recv(struct trns *const, void *, const size_t) {
+    errno = EAGAIN; /* Input is pushed by mux_feed() */
+    return (-1);
+}
+
+static ssize_t mux_chan_send(struct trns *const t, const void *buf,
+                             const size_t len) {
+    /* Variables */
+    struct mux_chan *c = static_cast<struct mux_chan *>(t);
+    size_t n = std::min<size_t>(len, std::min(c->txcredit, MUX_FRAME_MAX));
+    /* Connection gone or client not reading */
+    if (c->parent->closing) {
+        errno = EPIPE;
+        return (-1);
+    }
+    if (n == 0) {
+        errno = EAGAIN;
+        return (-1);
+    }
+    if (mux_send_frame(c->parent, c->id, MUX_DATA,
+                       std::string_view(static_cast<const char *>(buf), n)) < 0) {
+        errno = ENOMEM;
+        return (-1);
+    }
+    c->txcredit -= n;
+    return static_cast<ssize_t>(n);
+}
+
+static void mux_chan_shutdown(struct trns *const) {}
+
+static int mux_chan_nonblock(struct trns *const) {
+    return 0;
+}
+
+static void mux_chan_destroy(struct trns *const t) {
+    /* Variables */
+    struct mux_chan *c = static_cast<struct mux_chan *>(t);
+    struct sess *s = c->parent;
+    /* Tell the client, unless it asked or the connection goes away */
+    if (!s->mux->closing) {
+        if (!c->peerclosed) {
+            mux_send_frame(s, c->id, MUX_CLOSE, {});
+        }
+        s->mux->chans.erase(c->id);
+    }
+    delete c;
+}
+
+static int mux_chan_interest(struct trns *const t, const uint32_t events) {
+    /* Variables */
+    struct mux_chan *c = static_cast<struct mux_chan *>(t);
+    char credit[4];
+    /* Credit back in batches while the channel keeps up */
+    if (!(events & IO_IN) || (c->owed < (MUX_WINDOW / 4)) ||
+        c->parent->closing) {
+        return 0;
+    }
+    mux_put32(credit, c->owed);
+    if (mux_send_frame(c->parent, c->id, MUX_CREDIT,
+                       std::string_view(credit, sizeof(credit))) < 0) {
+        return (-1);
+    }
+    c->rxwindow += c->owed;
+    c->owed = 0;
+    return 0;
+}
+
+static uint32_t mux_get32(const char *const p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return ntohl(v);
+}
+
+static void mux_put32(char *const p, const uint32_t v) {
+    const uint32_t n = htonl(v);
+    memcpy(p, &n, sizeof(n));
+}
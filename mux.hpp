@@ -0,0 +1,101 @@
+/**
+ * @file mux.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Logical channels multiplexed over one connection.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ * A client switches its connection to channel mode by sending MUX_MAGIC
+ * as the very first bytes; the server answers with MUX_MAGIC (after the
+ * prompt already sent). From then on the connection carries frames, all
+ * integers big endian:
+ *
+ *   u32 channel | u8 type | u32 length | length bytes of payload
+ *
+ *   MUX_OPEN    starts a session on a new channel (no payload)
+ *   MUX_DATA    session input (client) or output (server)
+ *   MUX_CLOSE   ends the session of a channel (no payload)
+ *   MUX_CREDIT  u32 payload: the peer may send that many more DATA bytes
+ *
+ * Every channel is a full session (FSM, line buffer, history, output
+ * queue) and each direction of it starts with MUX_WINDOW bytes of credit.
+ * The server withholds credit from a channel whose client does not read
+ * its output, so one busy channel never stalls the others.
+ */
+
+#ifndef MUX_HPP
+#define MUX_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr std::string_view MUX_MAGIC("\0TLMUX1\n", 8); /**< Mode switch */
+constexpr size_t MUX_HDR = 9; /**< channel, type, length */
+constexpr uint32_t MUX_WINDOW = 64 * 1024; /**< Initial credit */
+constexpr uint32_t MUX_FRAME_MAX = 16 * 1024; /**< DATA payload limit */
+constexpr size_t MUX_CHANS_MAX = 1024; /**< Channels per connection */
+
+/**
+ * @brief Frame types.
+ */
+enum mux_type : uint8_t {
+    MUX_OPEN = 1,
+    MUX_DATA = 2,
+    MUX_CLOSE = 3,
+    MUX_CREDIT = 4
+};
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct sess;
+struct mux_chan;
+
+/**
+ * @brief Channel table of a multiplexed connection (reactor thread).
+ */
+struct mux {
+    std::unordered_map<uint32_t, struct mux_chan *> chans; /**< Open */
+    bool closing; /**< Connection is closing its channels */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Switches a session to channel mode (magic received).
+ *
+ * @param s The session.
+ * @return int 0 on success, or -1 on failure.
+ */
+int mux_start(struct sess *const s);
+
+/**
+ * @brief Feeds received frames of a connection in channel mode.
+ *
+ * @param s The session of the connection.
+ * @param data Received bytes.
+ * @param len Number of bytes.
+ * @return int 0 on success, <0 on error, >0 to close the connection.
+ */
+int mux_feed(struct sess *const s, const char *data, const size_t len);
+
+/**
+ * @brief Closes all channels of a closing connection.
+ *
+ * @param s The session of the connection.
+ */
+void mux_close(struct sess *const s);
+
+#endif /* MUX_HPP */
@@ -0,0 +1,137 @@
+/**
+ * @file oq.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Session output queue made of pooled chunks.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "oq.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Unlinks and frees the head chunk.
+ *
+ * @param q The queue.
+ * @param a Chunk allocator.
+ */
+static void oq_pop(struct oq *const q, oq_arena *const a);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int oq_append(struct oq *const q, oq_arena *const a,
+              const char *data, size_t len) {
+    /* Variables */
+    struct oq_chunk *c;
+    size_t n;
+    /* Fill the tail, then new chunks */
+    while (len > 0) {
+        c = q->tail;
+        if ((c == NULL) || (c->wr == sizeof(c->data))) {
+            c = static_cast<struct oq_chunk *>(tlnt_policy::alloc::get(a));
+            if (c == NULL) {
+                return (-1);
+            }
+            c->next = NULL;
+            c->rd = 0;
+            c->wr = 0;
+            if (q->tail != NULL) {
+                q->tail->next = c;
+            } else {
+                q->head = c;
+            }
+            q->tail = c;
+        }
+        n = std::min(len, sizeof(c->data) - c->wr);
+        memcpy(c->data + c->wr, data, n);
+        c->wr += n;
+        q->bytes += n;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int oq_send(struct oq *const q, oq_arena *const a, struct trns *const t,
+            size_t limit) {
+    /* Variables */
+    struct oq_chunk *c;
+    ssize_t n;
+    /* Send chunk by chunk */
+    while ((c = q->head) != NULL) {
+        if (c->rd == c->wr) {
+            oq_pop(q, a);
+            continue;
+        }
+        if (limit == 0) {
+            return 2;
+        }
+        n = trns_send(t, c->data + c->rd,
+                      std::min<size_t>(c->wr - c->rd, limit));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return 1;
+            }
+            return (-1);
+        }
+        c->rd += n;
+        q->bytes -= n;
+        q->mid = (c->data[c->rd - 1] != '\n');
+        limit -= (limit != SIZE_MAX) ? static_cast<size_t>(n) : 0;
+    }
+    q->mid = false; /* Drained: the next byte starts a new write */
+    return 0;
+}
+
+size_t oq_line(const struct oq *const q) {
+    /* Variables */
+    size_t len = 0;
+    const char *nl;
+    /* Scan up to the first line end */
+    for (const struct oq_chunk *c = q->head; c != NULL; c = c->next) {
+        nl = static_cast<const char *>(memchr(c->data + c->rd, '\n',
+                                              c->wr - c->rd));
+        if (nl != NULL) {
+            return len + static_cast<size_t>(nl - (c->data + c->rd)) + 1;
+        }
+        len += c->wr - c->rd;
+    }
+    return len;
+}
+
+void oq_clear(struct oq *const q, oq_arena *const a) {
+    while (q->head != NULL) {
+        oq_pop(q, a);
+    }
+    q->bytes = 0;
+    q->mid = false;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void oq_pop(struct oq *const q, oq_arena *const a) {
+    struct oq_chunk *c = q->head;
+    q->bytes -= (c->wr - c->rd);
+    q->head = c->next;
+    if (q->head == NULL) {
+        q->tail = NULL;
+    }
+    tlnt_policy::alloc::put(a, c);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file oq.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Session output queue made of pooled chunks.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef OQ_HPP
+#define OQ_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include "policy.hpp"
+#include "trns.hpp"
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr size_t OQ_CHUNK_SIZE = 4096; /**< Chunk size (pool block size) */
+
+/**
+ * @brief Output classes of a session, flushed in this order.
+ */
+enum oq_class : uint8_t {
+    OQ_INTERACTIVE = 0, /**< Echo and line edits */
+    OQ_BULK, /**< Command output (and the prompt that ends it), frames */
+    OQ_CLASSES
+};
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Output chunk, data[rd..wr) is pending.
+ */
+struct oq_chunk {
+    struct oq_chunk *next; /**< Next chunk in the queue */
+    uint32_t rd; /**< Read (send) offset */
+    uint32_t wr; /**< Write (append) offset */
+    char data[OQ_CHUNK_SIZE - sizeof(void *) - (2 * sizeof(uint32_t))];
+};
+
+/**
+ * @brief FIFO of output chunks.
+ */
+struct oq {
+    struct oq_chunk *head = NULL; /**< Oldest chunk (sent first) */
+    struct oq_chunk *tail = NULL; /**< Newest chunk (appended to) */
+    size_t bytes = 0; /**< Pending bytes */
+    bool mid = false; /**< Sending stopped inside a line (the last sent
+                           byte was no line end, bytes are pending) */
+};
+
+/**
+ * @brief Chunk allocator of the build (see tlnt_policy::alloc).
+ */
+using oq_arena = tlnt_policy::alloc::arena;
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Appends bytes to the queue.
+ *
+ * @param q The queue.
+ * @param a Chunk allocator.
+ * @param data Bytes to append.
+ * @param len Number of bytes.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int oq_append(struct oq *const q, oq_arena *const a,
+              const char *data, size_t len);
+
+/**
+ * @brief Sends pending bytes until the queue is empty, the transport
+ * would block or the limit is reached. Sent chunks are returned to the
+ * allocator.
+ *
+ * @param q The queue.
+ * @param a Chunk allocator.
+ * @param t Transport (blocking or non-blocking).
+ * @param limit Bytes that may be sent (SIZE_MAX - no limit).
+ * @return int 0 - queue is empty, 1 - would block, 2 - limit reached,
+ * -1 - transport error.
+ */
+int oq_send(struct oq *const q, oq_arena *const a, struct trns *const t,
+            size_t limit);
+
+/**
+ * @brief Pending bytes up to and including the first line end.
+ *
+ * @param q The queue.
+ * @return size_t Length of the first pending line (all pending bytes
+ * without a line end).
+ */
+size_t oq_line(const struct oq *const q);
+
+/**
+ * @brief Drops all pending bytes and returns the chunks.
+ *
+ * @param q The queue.
+ * @param a Chunk allocator.
+ */
+void oq_clear(struct oq *const q, oq_arena *const a);
+
+#endif /* OQ_HPP */
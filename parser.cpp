@@ -2,7 +2,7 @@
  * @file parser.cpp
  * @author Konstantin Kamyshanov (kkamyshanov)
  * @brief Raw Telnet Data Parser.
- * @version 0.1.0
+ * @version 0.2.0
  * @date 2025-05-17
  *
  * @copyright Copyright (c) 2025
@@ -13,14 +13,16 @@
 //==============================================================================
 // Includes
 //==============================================================================
-#include <iostream>
-#include <unistd.h>
-#include <thread>
-#include <chrono>
-#include <format>
-#include "tlnt.hpp"
+#include <string>
+#include <vector>
 #include "parser.hpp"
-#include "gc.hpp"
+#include "auth.hpp"
+#include "sess.hpp"
+#include "srv.hpp"
+#include "pgr.hpp"
+#include "proc.hpp"
+#include "tlnt.hpp"
+#include "wtch.hpp"
 
 //==============================================================================
 // Structures
@@ -31,40 +33,15 @@
  * Contains socket and buffer-related settings used during input parsing.
  */
 struct parse_config {
-    const int clntsocket; /**< Client socket descriptor */
+    struct sess *const sess; /**< Session being parsed */
     std::string *const buf; /**< Pointer to the start of the input buffer */
     const std::string_view *prompt; /**< Prompt string displayed to the user */
-    std::vector<std::string> *const history; /**< Command history */
-};
-
-/**
- * @brief Parser state data used during Telnet session processing.
- *
- * Holds mutable parsing state, function pointers and buffer positions.
- */
-struct parse_data {
-    void *func; /**< Generic pointer to the current parser state function */
-    char symb;  /**< Last read character (symbol) from input */
-    unsigned short history_index; /**< Current index (command history) */
+    tlnt_policy::hist::store *const history; /**< Command history */
 };
 
 //==============================================================================
 // Static Function Declarations
 //==============================================================================
-/**
- * @brief Starts the parser finite state machine (FSM) for a Telnet session.
- *
- * This function initializes and runs the command parsing logic using a
- * finite state machine (FSM) approach. It is responsible for managing
- * the session’s input loop: receiving data from the client socket,
- * displaying the prompt, and feeding data into the FSM core logic.
- *
- * @param clntsocket The client socket file descriptor to read input from.
- * @param prompt A pointer to the prompt string to display to the client.
- * @return int Returns >=0 on normal termination, or <0 error code.
- */
-static int parser_fsm(const int clntsocket, const std::string_view *prompt);
-
 /**
  * @brief Core state machine logic for parsing client input.
  *
@@ -80,6 +57,27 @@ static int parser_fsm(const int clntsocket, const std::string_view *prompt);
 static int parser_fsm_main(const struct parse_config *const prscfg,
                            struct parse_data *const prsdata);
 
+/**
+ * @brief Reads the name and the password of a login (the password is
+ * not echoed), Enter on the password submits them.
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_login(const struct parse_config *const prscfg,
+                            struct parse_data *const prsdata);
+
+/**
+ * @brief Drops input while a login is checked (Ctrl + C/D still close).
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_login_wait(const struct parse_config *const prscfg,
+                                 struct parse_data *const prsdata);
+
 /**
  * @brief Skips `\n` following a carriage return `\r` from Windows clients.
  *
@@ -129,88 +127,325 @@ static int parser_fsm_arrow_check(const struct parse_config *const prscfg,
 static int parser_fsm_arrow(const struct parse_config *const prscfg,
                             struct parse_data *const prsdata);
 
+/**
+ * @brief Handles the keys of a paged output (--More--).
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_more(const struct parse_config *const prscfg,
+                           struct parse_data *const prsdata);
+
+/**
+ * @brief Waits for the key that stops a watched command ("watch").
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_watch(const struct parse_config *const prscfg,
+                            struct parse_data *const prsdata);
+
+/**
+ * @brief Passes keys to the program running in the foreground.
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_proc(const struct parse_config *const prscfg,
+                           struct parse_data *const prsdata);
+
+/**
+ * @brief Reads the command following IAC: option negotiation,
+ * subnegotiation or a single byte command (ignored).
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_iac(const struct parse_config *const prscfg,
+                          struct parse_data *const prsdata);
+
+/**
+ * @brief Skips the option of IAC WILL/WONT/DO/DONT (only NAWS is asked
+ * for, its answer comes as a subnegotiation).
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_iac_opt(const struct parse_config *const prscfg,
+                              struct parse_data *const prsdata);
+
+/**
+ * @brief Reads the option of IAC SB.
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_sb_opt(const struct parse_config *const prscfg,
+                             struct parse_data *const prsdata);
+
+/**
+ * @brief Collects subnegotiation data up to IAC SE (IAC IAC is a 255
+ * data byte) and applies NAWS.
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_sb(const struct parse_config *const prscfg,
+                         struct parse_data *const prsdata);
+
+/**
+ * @brief Byte after IAC inside a subnegotiation.
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ * @return int Returns >=0 on normal termination, or <0 error code.
+ */
+static int parser_fsm_sb_iac(const struct parse_config *const prscfg,
+                             struct parse_data *const prsdata);
+
+/**
+ * @brief Returns to line editing, or to the login, pager, watch or
+ * program if one is active.
+ *
+ * @param prscfg Parsing configuration structure (e.g., socket, buffer limits).
+ * @param prsdata Parsing state and data (e.g., buffer pointer, current char).
+ */
+static void parser_fsm_resume(const struct parse_config *const prscfg,
+                              struct parse_data *const prsdata);
+
 //==============================================================================
-// Global Function Definitions
+// Static Variables
 //==============================================================================
-void parser_handler(int clntsocket) {
-    /* Telnet Session Configurations */
-    /* TODO: constexpr unsigned short HISTORY_INDEX_MAX = 10; */
-    constexpr std::string_view PROMPT("> ", 2);
-    /* Assertion */
-    if (clntsocket < 0) {
-        std::cout << "Error: wrong socket value" << std::endl;
-        return;
-    }
-    /* Parser Handler */
-    if (parser_fsm(clntsocket, &PROMPT) < 0) {
-        std::cout << "Error: parser_fsm" << std::endl;
-    }
-    /* Free Buffers and Close Client Socket */
-    gc_unregister_socket(clntsocket);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    std::cout << "Stop Parser Socket: " << clntsocket << std::endl;
-}
+/* TODO: constexpr unsigned short HISTORY_INDEX_MAX = 10; */
+static constexpr std::string_view PROMPT("> ", 2); /**< Session prompt */
+static constexpr char DO_NAWS[] = {
+    static_cast<char>(TLNT_IAC), static_cast<char>(TLNT_DO),
+    static_cast<char>(TLNT_OPT_NAWS)
+}; /**< Asks a terminal for its size */
+static constexpr std::string_view LOGIN("login: "); /**< Name prompt */
+static constexpr std::string_view PASSWORD("Password: "); /**< Password
+                                                               prompt */
+static constexpr std::string_view LOGIN_INCORRECT("Login incorrect\r\n");
 
 //==============================================================================
-// Static Function Definitions
+// Global Function Definitions
 //==============================================================================
-static int parser_fsm(const int clntsocket, const std::string_view *prompt) {
+int parser_start(struct sess *const s) {
     /* Assertion */
-    if (clntsocket < 0) {
-        std::cout << "Error: wrong socket value" << std::endl;
+    if (s == NULL) {
+        log_error("Error: session == NULL");
+        return (-1);
+    }
+    /* Init FSM */
+    s->prsdata = {
+        .func = reinterpret_cast<void *>(parser_fsm_main),
+        .symb = 0,
+        .history_index = 0,
+        .opt = 0,
+        .sblen = 0,
+        .sb = {}
+    };
+    /* Reserve memory */
+    try {
+        s->buf.reserve(256);
+    } catch (const std::bad_alloc& e) {
         return (-1);
     }
-    if (prompt == NULL) {
-        std::cout << "Error: prompt == NULL" << std::endl;
+    /* Terminal size for the pager (network terminals only) */
+    if (s->tcp && (sess_echo(s, DO_NAWS, sizeof(DO_NAWS)) < 0)) {
+        return (-1);
+    }
+    /* Login stage first when credentials are configured */
+    if constexpr (tlnt_policy::feat::auth) {
+        if (auth_required(s->srv)) {
+            if (auth_start(s) < 0) {
+                return (-1);
+            }
+            s->prsdata.func = reinterpret_cast<void *>(parser_fsm_login);
+            return sess_echo(s, LOGIN);
+        }
+    } else if (s->srv->auth.lookup != NULL) {
+        return (-1); /* A backend without the login stage: no sessions */
+    }
+    /* Welcome Message */
+    return sess_echo(s, PROMPT);
+}
+
+int parser_feed(struct sess *const s, const char *data, const size_t len) {
+    /* Assertion */
+    if ((s == NULL) || (data == NULL)) {
+        log_error("Error: parser_feed arguments == NULL");
         return (-1);
     }
     /* Variables */
-    std::vector<std::string> history_commands;
-    std::string buf;
     const struct parse_config prscfg = {
-        .clntsocket = clntsocket,
-        .buf = &buf,
-        .prompt = prompt,
-        .history = &history_commands
-    };
-    struct parse_data prsdata = {
-        .func = reinterpret_cast<void *>(parser_fsm_main),
-        .history_index = 0
+        .sess = s,
+        .buf = &s->buf,
+        .prompt = &PROMPT,
+        .history = &s->history
     };
+    struct parse_data *const prsdata = &s->prsdata;
     int result = 0;
-    /* Reserve memory */
-    prscfg.buf->reserve(256);
-    /* Welcome Message */
-    if (send(prscfg.clntsocket, prscfg.prompt->data(),
-             prscfg.prompt->size(), 0) <
-        static_cast<ssize_t>(prscfg.prompt->size())) {
-        std::cout << "Error: session send failed" << std::endl;
+    /* A hibernated session gets its line state back first */
+    if (sess_wake(s) < 0) {
         return (-1);
     }
     /* Parser */
-    for (;;) {
-        if (recv(clntsocket, &prsdata.symb, 1, 0) < 1) {
-            break;
-        }
-        if (isprint(prsdata.symb)) {
-            std::cout << "SMB: " << prsdata.symb;
+    for (size_t i = 0; i < len; ++i) {
+        prsdata->symb = data[i];
+        if (isprint(prsdata->symb)) {
+            log_trace("SMB: ", prsdata->symb,
+                      " CODE: ", static_cast<short>(prsdata->symb));
+        } else {
+            log_trace(" CODE: ", static_cast<short>(prsdata->symb));
         }
-        std::cout << " CODE: " << static_cast<short>(prsdata.symb) << std::endl;
         result = reinterpret_cast
         <int (*)(const struct parse_config *const, struct parse_data *const)>
-        (prsdata.func)(&prscfg, &prsdata);
+        (prsdata->func)(&prscfg, prsdata);
         if (result != 0) {
             break;
         }
     }
-    history_commands.clear();
-    buf.clear();
     return result;
 }
 
+int parser_login_done(struct sess *const s, const bool ok) {
+    /* Variables */
+    struct auth_login *l = s->login.get();
+    /* Logged in: the session prompt */
+    if (ok) {
+        s->prsdata.func = l->cr ?
+            reinterpret_cast<void *>(parser_fsm_carriage_windows) :
+            reinterpret_cast<void *>(parser_fsm_main);
+        s->login.reset();
+        return sess_echo(s, PROMPT);
+    }
+    /* Another try, or the close */
+    if (sess_echo(s, LOGIN_INCORRECT) < 0) {
+        return (-1);
+    }
+    if (++l->tries >= AUTH_TRIES) {
+        return 1;
+    }
+    l->stage = AUTH_NAME;
+    l->name.clear();
+    s->prsdata.func = reinterpret_cast<void *>(parser_fsm_login);
+    if (sess_echo(s, "\r\n", 2) < 0) {
+        return (-1);
+    }
+    return sess_echo(s, LOGIN);
+}
+
+int parser_prompt(struct sess *const s) {
+    /* A Telnet command in progress resumes to line editing by itself */
+    if (s->prsdata.func == reinterpret_cast<void *>(parser_fsm_proc)) {
+        s->prsdata.func = reinterpret_cast<void *>(parser_fsm_main);
+    }
+    return sess_write(s, PROMPT);
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int parser_fsm_login(const struct parse_config *const prscfg,
+                            struct parse_data *const prsdata) {
+    /* Variables */
+    struct sess *s = prscfg->sess;
+    struct auth_login *l = s->login.get();
+    const bool name = (l->stage == AUTH_NAME);
+    std::string *field = name ? &l->name : &l->pass;
+    const bool cr = l->cr;
+    l->cr = (prsdata->symb == '\r');
+    switch (prsdata->symb) {
+    /* CNTRL + C, CNTRL + D */
+    case '\x03':
+    case '\x04':
+        return 1;
+
+    case '\n':
+    case '\0':
+        if (cr) {
+            break; /* Second half of Enter */
+        }
+        [[fallthrough]];
+    case '\r':
+        if (sess_echo(s, "\r\n", 2) < 0) {
+            return (-1);
+        }
+        if (name) {
+            if (l->name.empty()) {
+                return (sess_echo(s, LOGIN) < 0) ? (-1) : 0;
+            }
+            l->stage = AUTH_PASS;
+            return (sess_echo(s, PASSWORD) < 0) ? (-1) : 0;
+        }
+        /* The result may come at once (cached) and move the FSM on */
+        l->stage = AUTH_CHECK;
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_login_wait);
+        if constexpr (tlnt_policy::feat::auth) {
+            return auth_submit(s);
+        }
+        return (-1); /* No login stage in this build */
+
+    case '\xff': /* IAC */
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac);
+        break;
+
+    case '\b':
+    case '\x7F': /* Delete */
+        if (!field->empty()) {
+            field->pop_back();
+            if (name && (sess_echo(s, "\b \b", 3) < 0)) {
+                return (-1);
+            }
+        }
+        break;
+
+    default:
+        if (isprint(prsdata->symb) && (field->size() < AUTH_LINE_MAX)) {
+            try {
+                field->push_back(prsdata->symb);
+            } catch (const std::bad_alloc& e) {
+                return (-1);
+            }
+            if (name && (sess_echo(s, &prsdata->symb, 1) < 0)) {
+                return (-1);
+            }
+        }
+        break;
+    }
+    return 0;
+}
+
+static int parser_fsm_login_wait(const struct parse_config *const prscfg,
+                                 struct parse_data *const prsdata) {
+    prscfg->sess->login->cr = false;
+    switch (prsdata->symb) {
+    case '\x03':
+    case '\x04':
+        return 1;
+
+    case '\xff': /* IAC */
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac);
+        break;
+
+    default:
+        break; /* Typed ahead of the result */
+    }
+    return 0;
+}
+
 static int parser_fsm_main(const struct parse_config *const prscfg,
                            struct parse_data *const prsdata)
 {
+    int paged = 1; /**< pgr_start() result, 1 - not paging */
     switch (prsdata->symb) {
     /* CNTRL + C */
     case '\x03':
@@ -220,52 +455,79 @@ static int parser_fsm_main(const struct parse_config *const prscfg,
         break;
     case '\r':
         prsdata->func = reinterpret_cast<void *>(parser_fsm_carriage_windows);
+        [[fallthrough]];
     case '\n':
-        if (send(prscfg->clntsocket, "\r\n", 2, 0) < 2) {
-            std::cout << "Error: session send failed" << std::endl;
+        if (sess_echo(prscfg->sess, "\r\n", 2) < 0) {
             return (-1);
         }
 
         if (!(prscfg->buf->empty())) {
             std::string line;
-            /* TODO: Command Parser (New Module) */
-            if (*prscfg->buf == "help") {
-                line += "Base Telnet Server \r\n";
-                line += "Use ARROW_UP or ARROW_DOWN for restore command \r\n";
-            } else if (*prscfg->buf == "Pinata") {
-                line += "Tequila! \r\n";
-            } else {
-                line += "Received command: " + *prscfg->buf + "\r\n";
-            }
-            if (send(prscfg->clntsocket, line.c_str(),
-                     line.size(), 0) < static_cast<ssize_t>(line.size())) {
-                std::cout << "Error: session send failed" << std::endl;
+            struct pgr_src *src = NULL;
+            const bool pager = tlnt_policy::feat::pager &&
+                               (prscfg->sess->rows > 0);
+            int result = srv_exec(prscfg->sess->srv, prscfg->sess,
+                                  *prscfg->buf, &line, pager ? &src : NULL);
+            /* A terminal of known size gets long output screen by screen */
+            if (pager) {
+                if constexpr (tlnt_policy::feat::pager) {
+                    paged = pgr_start(prscfg->sess, std::move(line), src);
+                }
+                if (paged < 0) {
+                    return (-1);
+                }
+            } else if (sess_text(prscfg->sess, line) < 0) {
                 return (-1);
             }
+            if (result > 0) {
+                return result; /* Command closes the Client */
+            }
             if ((prscfg->history->size() > 0)
                 && (prsdata->history_index != prscfg->history->size())) {
                 prscfg->history->pop_back();
                 prsdata->history_index = prscfg->history->size();
             }
-            /* TODO: Ring Buffer */
-            try {
-                prscfg->history->push_back(*prscfg->buf);   
-            } catch (const std::bad_alloc& e) {
-                return (-1);
+            /* History store policy: drop the oldest beyond the limit */
+            if constexpr (tlnt_policy::hist::limit > 0) {
+                try {
+                    prscfg->history->push_back(*prscfg->buf);
+                } catch (const std::bad_alloc& e) {
+                    return (-1);
+                }
+                while (prscfg->history->size() > tlnt_policy::hist::limit) {
+                    prscfg->history->erase(prscfg->history->begin());
+                }
             }
-            
+
             prscfg->buf->clear();
-            ++prsdata->history_index;
+            prsdata->history_index = prscfg->history->size();
         }
 
-        if (send(prscfg->clntsocket, prscfg->prompt->data(),
-                 prscfg->prompt->size(), 0) <
-                 static_cast<ssize_t>(prscfg->prompt->size())) {
-            std::cout << "Error: session send failed" << std::endl;
+        /* The prompt follows the command output (the last page), the
+         * key that stops a watch or the end of a program */
+        if (tlnt_policy::feat::proc && (prscfg->sess->proc != NULL)) {
+            prscfg->sess->proc->cr = (prsdata->func == reinterpret_cast<void *>(
+                                          parser_fsm_carriage_windows));
+            prsdata->func = reinterpret_cast<void *>(parser_fsm_proc);
+            break;
+        }
+        if (tlnt_policy::feat::watch && (prscfg->sess->watch != NULL)) {
+            prsdata->func = reinterpret_cast<void *>(parser_fsm_watch);
+            break;
+        }
+        if (tlnt_policy::feat::pager && (paged == 0)) {
+            prsdata->func = reinterpret_cast<void *>(parser_fsm_more);
+            break;
+        }
+        if (sess_write(prscfg->sess, *prscfg->prompt) < 0) {
             return (-1);
         }
         break;
 
+    case '\xff': /* IAC */
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac);
+        break;
+
     case '\x1b':
         prsdata->func = reinterpret_cast<void *>(parser_fsm_arrow_check);
         break;
@@ -274,7 +536,7 @@ static int parser_fsm_main(const struct parse_config *const prscfg,
     case '\x7F': /* Delete */
         if (prscfg->buf->size() != 0) {
             prscfg->buf->pop_back();
-            if (send(prscfg->clntsocket, "\b \b", 3, 0) < 3) {
+            if (sess_echo(prscfg->sess, "\b \b", 3) < 0) {
                 return (-1);
             }
         }
@@ -287,7 +549,7 @@ static int parser_fsm_main(const struct parse_config *const prscfg,
             } catch (const std::bad_alloc& e) {
                 return (-1);
             }
-            if (send(prscfg->clntsocket, &prsdata->symb, 1, 0) < 1) {
+            if (sess_echo(prscfg->sess, &prsdata->symb, 1) < 0) {
                 return (-1);
             }
         }
@@ -305,7 +567,7 @@ static int parser_fsm_carriage_windows(const struct parse_config *const prscfg,
          * Upon receiving the “Enter” command,
          * an extra character from Windows systems is ignored.
          */
-        std::cout << "Ignore an extra character from Windows" << std::endl;
+        log_trace("Ignore an extra character from Windows");
         break;
 
     default:
@@ -334,7 +596,7 @@ static int parser_fsm_arrow(const struct parse_config *const prscfg,
                             struct parse_data *const prsdata) {
     switch (prsdata->symb) {
     case 'A':
-        std::cout << "Arrow UP" << std::endl;
+        log_trace("Arrow UP");
         if (prsdata->history_index > 0) {
             if (prsdata->history_index == prscfg->history->size()) {
                 prscfg->history->push_back(*prscfg->buf);
@@ -342,43 +604,39 @@ static int parser_fsm_arrow(const struct parse_config *const prscfg,
             --prsdata->history_index;
             std::string cmd = (*prscfg->history)[prsdata->history_index];
             std::string line = "\r\033[K" + std::string(*prscfg->prompt) + cmd;
-            if (send(prscfg->clntsocket, line.c_str(),
-                     line.size(), 0) < static_cast<ssize_t>(line.size())) {
-                std::cout << "Error: session send failed" << std::endl;
+            if (sess_echo(prscfg->sess, line) < 0) {
                 return (-1);
             }
             *prscfg->buf = cmd;
-            std::cout << "Arrow UP - " << cmd << std::endl;
+            log_trace("Arrow UP - ", cmd);
         }
         break;
 
     case 'B':
-        std::cout << "Arrow DOWN" << std::endl;
+        log_trace("Arrow DOWN");
         if (prsdata->history_index < prscfg->history->size()) {
             ++prsdata->history_index;
             std::string cmd = (*prscfg->history)[prsdata->history_index];
             std::string line = "\r\033[K" + std::string(*prscfg->prompt) + cmd;
-            if (send(prscfg->clntsocket, line.c_str(),
-                     line.size(), 0) < static_cast<ssize_t>(line.size())) {
-                std::cout << "Error: session send failed" << std::endl;
+            if (sess_echo(prscfg->sess, line) < 0) {
                 return (-1);
             }
             *prscfg->buf = cmd;
             if (prsdata->history_index == (prscfg->history->size() - 1)) {
                 prscfg->history->pop_back();
             }
-            std::cout << "Arrow DOWN - " << cmd << std::endl;
+            log_trace("Arrow DOWN - ", cmd);
         }
         break;
 
     case 'C':
         /* TODO: Arrow Right */
-        std::cout << "Arrow RIGHT" << std::endl;
+        log_trace("Arrow RIGHT");
         break;
     
     case 'D':
         /* TODO: Arrow Left */
-        std::cout << "Arrow LEFT" << std::endl;
+        log_trace("Arrow LEFT");
         break;
 
     default:
@@ -388,3 +646,172 @@ static int parser_fsm_arrow(const struct parse_config *const prscfg,
     }
     return 0;
 }
+
+static int parser_fsm_more(const struct parse_config *const prscfg,
+                           struct parse_data *const prsdata) {
+    /* Variables */
+    int result;
+    /* Telnet commands may arrive while paging */
+    if (prsdata->symb == '\xff') {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac);
+        return 0;
+    }
+    if constexpr (tlnt_policy::feat::pager) {
+        result = pgr_key(prscfg->sess, prsdata->symb);
+    } else {
+        result = 1; /* Not built: never paging */
+    }
+    if (result < 0) {
+        return (-1);
+    }
+    if (result > 0) {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_main);
+        if (sess_write(prscfg->sess, *prscfg->prompt) < 0) {
+            return (-1);
+        }
+    }
+    return 0;
+}
+
+static int parser_fsm_watch(const struct parse_config *const prscfg,
+                            struct parse_data *const prsdata) {
+    /* Variables */
+    int result;
+    /* Telnet commands (a new window size) may arrive while watching */
+    if (prsdata->symb == '\xff') {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac);
+        return 0;
+    }
+    if constexpr (tlnt_policy::feat::watch) {
+        result = wtch_key(prscfg->sess, prsdata->symb);
+    } else {
+        result = 1; /* Not built: never watching */
+    }
+    if (result < 0) {
+        return (-1);
+    }
+    if (result > 0) {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_main);
+        if (sess_write(prscfg->sess, *prscfg->prompt) < 0) {
+            return (-1);
+        }
+    }
+    return 0;
+}
+
+static int parser_fsm_proc(const struct parse_config *const prscfg,
+                           struct parse_data *const prsdata) {
+    /* Telnet commands (a new window size) may arrive while it runs */
+    if (prsdata->symb == '\xff') {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac);
+        return 0;
+    }
+    if constexpr (tlnt_policy::feat::proc) {
+        return proc_key(prscfg->sess, prsdata->symb);
+    }
+    return 0; /* Not built: never running */
+}
+
+static int parser_fsm_iac(const struct parse_config *const prscfg,
+                          struct parse_data *const prsdata) {
+    switch (static_cast<unsigned char>(prsdata->symb)) {
+    case TLNT_WILL:
+    case TLNT_WONT:
+    case TLNT_DO:
+    case TLNT_DONT:
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_iac_opt);
+        break;
+
+    case TLNT_SB:
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_sb_opt);
+        break;
+
+    case TLNT_IP:
+        /* Interrupt Process: Ctrl + C to the current state */
+        parser_fsm_resume(prscfg, prsdata);
+        prsdata->symb = '\x03';
+        return reinterpret_cast
+        <int (*)(const struct parse_config *const, struct parse_data *const)>
+        (prsdata->func)(prscfg, prsdata);
+
+    default:
+        /* IAC IAC (data 255) and single byte commands are dropped */
+        parser_fsm_resume(prscfg, prsdata);
+        break;
+    }
+    return 0;
+}
+
+static int parser_fsm_iac_opt(const struct parse_config *const prscfg,
+                              struct parse_data *const prsdata) {
+    log_trace("Telnet option ",
+              static_cast<unsigned>(static_cast<unsigned char>(prsdata->symb)));
+    parser_fsm_resume(prscfg, prsdata);
+    return 0;
+}
+
+static int parser_fsm_sb_opt(const struct parse_config *const,
+                             struct parse_data *const prsdata) {
+    prsdata->opt = static_cast<unsigned char>(prsdata->symb);
+    prsdata->sblen = 0;
+    prsdata->func = reinterpret_cast<void *>(parser_fsm_sb);
+    return 0;
+}
+
+static int parser_fsm_sb(const struct parse_config *const,
+                         struct parse_data *const prsdata) {
+    if (prsdata->symb == '\xff') {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_sb_iac);
+        return 0;
+    }
+    /* Only the first bytes matter, the count tells a wrong length */
+    if (prsdata->sblen < sizeof(prsdata->sb)) {
+        prsdata->sb[prsdata->sblen] = static_cast<unsigned char>(prsdata->symb);
+    }
+    if (prsdata->sblen < UINT8_MAX) {
+        ++prsdata->sblen;
+    }
+    return 0;
+}
+
+static int parser_fsm_sb_iac(const struct parse_config *const prscfg,
+                             struct parse_data *const prsdata) {
+    /* Variables */
+    struct sess *s = prscfg->sess;
+    /* IAC IAC - a 255 data byte */
+    if (prsdata->symb == '\xff') {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_sb);
+        return parser_fsm_sb(prscfg, prsdata);
+    }
+    /* IAC SE - done (anything else aborts the subnegotiation) */
+    if ((static_cast<unsigned char>(prsdata->symb) == TLNT_SE) &&
+        (prsdata->opt == TLNT_OPT_NAWS) && (prsdata->sblen == 4)) {
+        s->cols = static_cast<uint16_t>((prsdata->sb[0] << 8) | prsdata->sb[1]);
+        s->rows = static_cast<uint16_t>((prsdata->sb[2] << 8) | prsdata->sb[3]);
+        log_trace("NAWS ", s->cols, "x", s->rows);
+        if constexpr (tlnt_policy::feat::proc) {
+            if (s->proc != NULL) {
+                proc_winsize(s);
+            }
+        }
+    }
+    parser_fsm_resume(prscfg, prsdata);
+    return 0;
+}
+
+static void parser_fsm_resume(const struct parse_config *const prscfg,
+                              struct parse_data *const prsdata) {
+    if (tlnt_policy::feat::auth && (prscfg->sess->login != NULL)) {
+        prsdata->func = (prscfg->sess->login->stage == AUTH_CHECK) ?
+            reinterpret_cast<void *>(parser_fsm_login_wait) :
+            reinterpret_cast<void *>(parser_fsm_login);
+    } else if (tlnt_policy::feat::pager && (prscfg->sess->pager != NULL)) {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_more);
+    } else if (tlnt_policy::feat::watch && (prscfg->sess->watch != NULL)) {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_watch);
+    } else if (tlnt_policy::feat::proc && (prscfg->sess->proc != NULL)) {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_proc);
+    } else {
+        prsdata->func = reinterpret_cast<void *>(parser_fsm_main);
+    }
+}
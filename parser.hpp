@@ -2,7 +2,7 @@
  * @file parser.hpp
  * @author Konstantin Kamyshanov (kkamyshanov)
  * @brief Raw Telnet Data Parser.
- * @version 0.1.0
+ * @version 0.2.0
  * @date 2025-05-17
  *
  * @copyright Copyright (c) 2025
@@ -13,37 +13,80 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct sess;
+
+/**
+ * @brief Parser state data used during Telnet session processing.
+ *
+ * Holds mutable parsing state, function pointers and buffer positions.
+ */
+struct parse_data {
+    void *func; /**< Generic pointer to the current parser state function */
+    char symb;  /**< Last read character (symbol) from input */
+    unsigned short history_index; /**< Current index (command history) */
+    unsigned char opt; /**< Telnet option being subnegotiated */
+    unsigned char sblen; /**< Subnegotiation bytes received */
+    unsigned char sb[4]; /**< Subnegotiation data (NAWS: 4 bytes) */
+};
+
 //=============================================================================
 // Global Function Declarations
 //=============================================================================
 /**
- * @brief Handles a Telnet client session (parses raw Telnet data).
- *
- * This function runs in a separate thread and manages the lifecycle of
- * a single Telnet client session. It continuously receives input
- * from the client over the provided socket, interprets or parses
- * the raw Telnet data (including control characters),
- * and responds accordingly.
- * 
+ * @brief Starts the parser finite state machine (FSM) for a Telnet session.
+ *
+ * Initializes the FSM state of the session, reserves the line buffer
+ * and queues the welcome prompt.
+ *
+ * @param s The session.
+ * @return int Returns >=0 on success, or <0 error code.
+ */
+int parser_start(struct sess *const s);
+
+/**
+ * @brief Feeds raw Telnet data received from the client into the FSM.
+ *
  * Responsibilities include:
- * - Receiving user input byte-by-byte.
  * - Handling control sequences (e.g., Enter, Backspace, Ctrl+D).
  * - Interpreting and executing recognized commands (like "help").
- * - Sending command results or echoing input back to the client.
- * - Ensuring buffer limits are respected to prevent overflows.
- * 
- * When the client disconnects or sends an exit signal (e.g., Ctrl+D),
- * the function performs cleanup: it closes the client socket and releases any
- * allocated resources.
- * 
- * @param clntsocket The file descriptor of the accepted client socket.
+ * - Queueing command results or echoing input back to the client.
+ *
+ * Output is queued in the session and must be flushed by the caller.
+ *
+ * @param s The session.
+ * @param data Received bytes.
+ * @param len Number of received bytes.
+ * @return int 0 - continue, >0 - close the client, <0 - error code.
  */
-void parser_handler(int clntsocket);
+int parser_feed(struct sess *const s, const char *data, const size_t len);
 
 /**
- * @brief 
- * 
+ * @brief Ends a checked login: the prompt after a success, the name
+ * again after a failure (AUTH_TRIES failures close the session).
+ *
+ * Output is queued in the session and must be flushed by the caller.
+ *
+ * @param s The session (logging in).
+ * @param ok The password matches.
+ * @return int 0 - continue, >0 - close the client, <0 - error code.
+ */
+int parser_login_done(struct sess *const s, const bool ok);
+
+/**
+ * @brief Returns a session to line editing once its program is done and
+ * queues the prompt (the caller flushes).
+ *
+ * @param s The session (sess::proc already gone).
+ * @return int 0 on success, or -1 on failure (out of memory).
  */
-void parser_finish();
+int parser_prompt(struct sess *const s);
 
 #endif /* PARSER_HPP */
@@ -0,0 +1,163 @@
+/**
+ * @file pgr.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Server-side pager: one screen of command output at a time,
+ * produced lazily as the operator pages forward.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include "pgr.hpp"
+#include "sess.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Shows the next lines, produced on demand.
+ *
+ * @param s The session (paging).
+ * @param lines Lines to show.
+ * @return int 0 - more left (PGR_MORE shown), 1 - all shown, -1 - error.
+ */
+static int pgr_show(struct sess *const s, const size_t lines);
+
+/**
+ * @brief Offset just past the given number of lines of a text.
+ *
+ * @param text The text.
+ * @param lines Lines.
+ * @return size_t Offset, or std::string::npos if the text is shorter.
+ */
+static size_t pgr_lines_end(const std::string_view text, const size_t lines);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int pgr_start(struct sess *const s, std::string &&text,
+              struct pgr_src *const src) {
+    /* Variables */
+    int result;
+    /* Pager */
+    s->pager.reset(new (std::nothrow) struct pgr);
+    if (s->pager == NULL) {
+        if (src != NULL) {
+            src->close(src);
+        }
+        return (-1);
+    }
+    s->pager->text = std::move(text);
+    s->pager->src = src;
+    /* The line of the prompt stays free */
+    result = pgr_show(s, std::max<size_t>(s->rows, 2) - 1);
+    if (result != 0) {
+        pgr_stop(s);
+    }
+    return result;
+}
+
+int pgr_key(struct sess *const s, const char key) {
+    /* Variables */
+    size_t lines;
+    int result;
+    /* Keys */
+    switch (key) {
+    case ' ':
+        lines = std::max<size_t>(s->rows, 2) - 1;
+        break;
+    case '\r':
+        lines = 1;
+        break;
+    case 'q':
+    case 'Q':
+    case '\x03':
+        pgr_stop(s);
+        return (sess_write(s, "\r\033[K", 4) < 0) ? (-1) : 1;
+    default:
+        return 0; /* '\n' or '\0' after '\r', anything else */
+    }
+    /* Next lines over the prompt */
+    if (sess_write(s, "\r\033[K", 4) < 0) {
+        return (-1);
+    }
+    result = pgr_show(s, lines);
+    if (result != 0) {
+        pgr_stop(s);
+    }
+    return result;
+}
+
+void pgr_stop(struct sess *const s) {
+    if (s->pager == NULL) {
+        return;
+    }
+    /* Nothing more is produced */
+    if (s->pager->src != NULL) {
+        s->pager->src->close(s->pager->src);
+    }
+    s->pager.reset();
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int pgr_show(struct sess *const s, const size_t lines) {
+    /* Variables */
+    struct pgr *p = s->pager.get();
+    size_t end;
+    int result;
+    /* Produce just what the screen needs (one line more tells whether
+     * anything is left) */
+    try {
+        while ((p->src != NULL) &&
+               (pgr_lines_end(p->text, lines + 1) == std::string::npos)) {
+            result = p->src->next(p->src, &p->text, lines);
+            if (result != 0) {
+                p->src->close(p->src);
+                p->src = NULL;
+            }
+            if (result < 0) {
+                return (-1);
+            }
+        }
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    end = pgr_lines_end(p->text, lines);
+    if ((end == std::string::npos) || (end == p->text.size())) {
+        end = p->text.size();
+    }
+    /* Show */
+    if (sess_text(s, p->text.data(), end) < 0) {
+        return (-1);
+    }
+    p->text.erase(0, end);
+    if (p->text.empty() && (p->src == NULL)) {
+        return 1;
+    }
+    return (sess_write(s, PGR_MORE) < 0) ? (-1) : 0;
+}
+
+static size_t pgr_lines_end(const std::string_view text, const size_t lines) {
+    /* Variables */
+    size_t pos = 0;
+    /* Past the n-th '\n' */
+    for (size_t n = 0; n < lines; ++n) {
+        pos = text.find('\n', pos);
+        if (pos == std::string_view::npos) {
+            return std::string::npos;
+        }
+        ++pos;
+    }
+    return pos;
+}
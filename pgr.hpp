@@ -0,0 +1,120 @@
+/**
+ * @file pgr.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Server-side pager: one screen of command output at a time,
+ * produced lazily as the operator pages forward.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef PGR_HPP
+#define PGR_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <string_view>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr std::string_view PGR_MORE("--More--", 8); /**< Pager prompt */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct sess;
+struct pgr_src;
+
+/**
+ * @brief Produces more lines of a command output.
+ *
+ * @param src The source.
+ * @param out Receives about the requested number of lines (more is fine).
+ * @param lines Lines wanted.
+ * @return int 0 - more to come, 1 - done, -1 - error.
+ */
+typedef int (*pgr_next)(struct pgr_src *const src, std::string *const out,
+                        const size_t lines);
+
+/**
+ * @brief Lazy output of a command, embedded (as a base) into the state
+ * of its producer.
+ */
+struct pgr_src {
+    pgr_next next; /**< Produces lines */
+    void (*close)(struct pgr_src *const src); /**< Frees the source */
+};
+
+/**
+ * @brief Pager of a session (sess::pager, set while paging).
+ */
+struct pgr {
+    std::string text; /**< Produced, not yet shown output */
+    struct pgr_src *src; /**< Producer of the rest, NULL - all in text */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Shows command output: all of it if it fits on the screen,
+ * otherwise the first screen followed by PGR_MORE.
+ *
+ * @param s The session (terminal size known).
+ * @param text Output produced so far.
+ * @param src Producer of the rest, or NULL (owned from now on).
+ * @return int 0 - paging (s->pager set), 1 - all shown, -1 - error.
+ */
+int pgr_start(struct sess *const s, std::string &&text,
+              struct pgr_src *const src);
+
+/**
+ * @brief Handles a key pressed at PGR_MORE: space shows the next screen,
+ * Enter the next line, q (or Ctrl+C) quits and cancels the producer.
+ *
+ * @param s The session (paging).
+ * @param key The key.
+ * @return int 0 - still paging, 1 - done (the pager is freed), -1 - error.
+ */
+int pgr_key(struct sess *const s, const char key);
+
+/**
+ * @brief Cancels the pager of a session (no-op if not paging).
+ *
+ * @param s The session.
+ */
+void pgr_stop(struct sess *const s);
+
+/**
+ * @brief Produces all the output of a source and frees it (callers that
+ * do not page; here, as builds without the pager have sources too).
+ *
+ * @param src The source.
+ * @param out Receives the output.
+ * @return int 0 on success, or -1 on failure.
+ */
+inline int pgr_drain(struct pgr_src *const src, std::string *const out) {
+    /* Variables */
+    int result;
+    /* All of it, in one go if the source can */
+    try {
+        do {
+            result = src->next(src, out, SIZE_MAX);
+        } while (result == 0);
+    } catch (const std::bad_alloc& e) {
+        result = (-1);
+    }
+    src->close(src);
+    return (result < 0) ? (-1) : 0;
+}
+
+#endif /* PGR_HPP */
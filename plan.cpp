@@ -0,0 +1,315 @@
+/**
+ * @file plan.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Startup sizing: reactors, workers, session limit and pool
+ * reserves derived from the cgroup limits and the CPUs of the process.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <vector>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "plan.hpp"
+#include "cfg.hpp"
+#include "sess.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Finds the cgroup directory of the process for a controller.
+ *
+ * @param ctrl v1 controller ("memory", "cpu"), the unified (v2)
+ * hierarchy is preferred when it is mounted at PLAN_CGROUP.
+ * @param dir Receives the directory.
+ * @param v2 Receives true for the unified hierarchy.
+ * @return bool true if the process has one.
+ */
+static bool plan_cg_dir(const std::string &ctrl, std::string *const dir,
+                        bool *const v2);
+
+/**
+ * @brief Reads the first line of a cgroup file, from the cgroup of the
+ * process up to the mount (the nearest one that exists is used: inside a
+ * cgroup namespace the mount is the own cgroup).
+ *
+ * @param dir cgroup directory of the process.
+ * @param file File name.
+ * @param pair Second file read from the same directory, its first line
+ * appended after a space (a level missing either file is skipped), NULL -
+ * none.
+ * @param lines Receives the first line of every file found, leaf first.
+ */
+static void plan_cg_read(std::string dir, const char *const file,
+                         const char *const pair,
+                         std::vector<std::string> *const lines);
+
+/**
+ * @brief Memory limit of the cgroup (the lowest on the path).
+ *
+ * @param lim Receives the limit, bytes.
+ * @param src Receives the file it comes from.
+ * @return bool true if there is a limit.
+ */
+static bool plan_cg_mem(uint64_t *const lim, std::string *const src);
+
+/**
+ * @brief CPU bandwidth limit of the cgroup, rounded up to CPUs (the
+ * lowest on the path).
+ *
+ * @param cpus Receives the limit.
+ * @param src Receives the file it comes from.
+ * @return bool true if there is a limit.
+ */
+static bool plan_cg_cpus(unsigned *const cpus, std::string *const src);
+
+/**
+ * @brief Reads a number (the whole of the string).
+ *
+ * @param str Digits.
+ * @param num Receives the number.
+ * @return bool true on success.
+ */
+static bool plan_num(const std::string &str, uint64_t *const num);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void plan_make(struct plan *const p, const struct cfg *const c,
+               const int lqueue, const unsigned reactors,
+               const unsigned workers) {
+    /* Variables */
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long psize = sysconf(_SC_PAGESIZE);
+    const uint64_t per = sizeof(struct sess) + PLAN_SESS_EXTRA + c->oq_high +
+                         OQ_CHUNK_SIZE; /**< Worst case of a session */
+    uint64_t lim = 0;
+    uint64_t budget;
+    uint64_t sessions;
+    uint64_t somax = PLAN_BACKLOG_MAX;
+    unsigned cpus = 0;
+    std::string src;
+    std::string line;
+    struct rlimit rl;
+    cpu_set_t set;
+    /* Memory: the host, a lower cgroup limit, the setting over both */
+    p->mem = ((pages > 0) && (psize > 0)) ?
+             static_cast<uint64_t>(pages) * static_cast<uint64_t>(psize) :
+             UINT64_MAX;
+    p->memsrc = "host";
+    if (plan_cg_mem(&lim, &src) && (lim < p->mem)) {
+        p->mem = lim;
+        p->memsrc = src;
+    }
+    if (c->mem_limit != 0) {
+        p->mem = c->mem_limit;
+        p->memsrc = "mem_limit";
+    }
+    /* CPUs: the affinity mask, a lower cgroup quota */
+    p->cpus = (sched_getaffinity(0, sizeof(set), &set) == 0) ?
+              static_cast<unsigned>(CPU_COUNT(&set)) : 1;
+    p->cpusrc = "affinity";
+    if (plan_cg_cpus(&cpus, &src) && (cpus < p->cpus)) {
+        p->cpus = cpus;
+        p->cpusrc = src;
+    }
+    p->cpus = std::max(p->cpus, 1u);
+    /* Threads: the build policy, the settings, one per CPU */
+    p->reactors = (reactors > 0) ? reactors :
+                  (c->reactors > 0) ? c->reactors : p->cpus;
+    p->workers = (workers > 0) ? workers :
+                 (c->workers > 0) ? c->workers : p->cpus;
+    /* Sessions: every one may queue oq_high, all of them fit the memory
+     * left after the headroom (and the descriptors) */
+    budget = p->mem - (p->mem / 100 * PLAN_HEADROOM);
+    budget = (budget > PLAN_BASE) ? (budget - PLAN_BASE) : 0;
+    sessions = budget / per;
+    if ((getrlimit(RLIMIT_NOFILE, &rl) == 0) &&
+        (rl.rlim_cur != RLIM_INFINITY)) {
+        sessions = std::min<uint64_t>(sessions,
+                                      (rl.rlim_cur > PLAN_FD_SPARE) ?
+                                      (rl.rlim_cur - PLAN_FD_SPARE) : 0);
+    }
+    p->sessions = static_cast<unsigned>(
+        std::clamp<uint64_t>(sessions, PLAN_SESS_MIN, UINT_MAX));
+    sessions = (c->sessions_max != 0) ? c->sessions_max : p->sessions;
+    /* Pools: the share of a reactor carved up front */
+    p->slab = std::min<size_t>(sessions / p->reactors + 1, PLAN_SLAB_MAX);
+    p->chunks = std::min<size_t>(sessions / p->reactors + 1, PLAN_CHUNKS_MAX);
+    /* Backlog: a burst of an eighth of the sessions */
+    {
+        std::ifstream file("/proc/sys/net/core/somaxconn");
+        if (std::getline(file, line) && plan_num(line, &somax)) {
+            somax = std::min<uint64_t>(somax, PLAN_BACKLOG_MAX);
+        }
+    }
+    p->backlog = (c->backlog > 0) ? c->backlog :
+                 static_cast<int>(std::clamp<uint64_t>(
+                     sessions / 8, static_cast<uint64_t>(lqueue),
+                     std::max<uint64_t>(somax, lqueue)));
+}
+
+std::string plan_describe(const struct plan *const p) {
+    return "memory " + std::to_string(p->mem >> 20) + " MiB (" + p->memsrc +
+           "), " + std::to_string(p->cpus) + " CPU(s) (" + p->cpusrc +
+           "): " + std::to_string(p->reactors) + " reactor(s), " +
+           std::to_string(p->workers) + " worker(s), " +
+           std::to_string(p->sessions) + " sessions, " +
+           std::to_string(p->slab) + " session slots and " +
+           std::to_string(p->chunks) + " output chunks per reactor, backlog " +
+           std::to_string(p->backlog);
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static bool plan_cg_dir(const std::string &ctrl, std::string *const dir,
+                        bool *const v2) {
+    /* Variables */
+    std::ifstream file("/proc/self/cgroup");
+    std::ifstream unified(std::string(PLAN_CGROUP) + "/cgroup.controllers");
+    std::string line;
+    std::string list;
+    std::string want;
+    size_t a;
+    size_t b;
+    /* "0::/path" (v2), "N:ctrl,ctrl:/path" (v1) */
+    *v2 = unified.good();
+    want.push_back(',');
+    want.append(ctrl).push_back(',');
+    while (std::getline(file, line)) {
+        a = line.find(':');
+        b = (a == std::string::npos) ? a : line.find(':', a + 1);
+        if (b == std::string::npos) {
+            continue;
+        }
+        list.clear();
+        list.push_back(',');
+        list.append(line, a + 1, b - a - 1).push_back(',');
+        if (*v2 ? (line.compare(0, 3, "0::") == 0) :
+                  (list.find(want) != std::string::npos)) {
+            dir->assign(PLAN_CGROUP);
+            if (!*v2) {
+                dir->append("/").append(ctrl);
+            }
+            dir->append(line, b + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void plan_cg_read(std::string dir, const char *const file,
+                         const char *const pair,
+                         std::vector<std::string> *const lines) {
+    /* Variables */
+    const size_t root = std::string_view(PLAN_CGROUP).size();
+    std::string line;
+    std::string second;
+    size_t slash;
+    /* Up to the mount point */
+    for (;;) {
+        std::ifstream in(dir + "/" + file);
+        if (std::getline(in, line) && (pair != NULL)) {
+            std::ifstream in2(dir + "/" + pair);
+            if (std::getline(in2, second)) {
+                line.push_back(' ');
+                line.append(second);
+                lines->push_back(line);
+            }
+        } else if (in) {
+            lines->push_back(line);
+        }
+        slash = dir.rfind('/');
+        if ((dir.size() <= root) || (slash == std::string::npos) ||
+            (slash < root)) {
+            break;
+        }
+        dir.resize(slash);
+    }
+}
+
+static bool plan_cg_mem(uint64_t *const lim, std::string *const src) {
+    /* Variables */
+    std::string dir;
+    std::vector<std::string> lines;
+    uint64_t num;
+    bool v2;
+    bool found = false;
+    /* "max" or bytes; v1 has a huge number for no limit */
+    if (!plan_cg_dir("memory", &dir, &v2)) {
+        return false;
+    }
+    *src = v2 ? "memory.max" : "memory.limit_in_bytes";
+    plan_cg_read(dir, src->c_str(), NULL, &lines);
+    for (const std::string &l : lines) {
+        if (plan_num(l, &num) && (num < (1ull << 60)) &&
+            (!found || (num < *lim))) {
+            *lim = num;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static bool plan_cg_cpus(unsigned *const cpus, std::string *const src) {
+    /* Variables */
+    std::string dir;
+    std::vector<std::string> lines;
+    uint64_t quota;
+    uint64_t period;
+    unsigned n;
+    size_t sp;
+    bool v2;
+    bool found = false;
+    /* v2 "quota period" ("max" - none), v1 quota (-1 - none) and period
+     * of the same directory joined the same way */
+    if (!plan_cg_dir("cpu", &dir, &v2)) {
+        return false;
+    }
+    *src = v2 ? "cpu.max" : "cpu.cfs_quota_us";
+    plan_cg_read(dir, src->c_str(), v2 ? NULL : "cpu.cfs_period_us",
+                 &lines);
+    for (const std::string &l : lines) {
+        sp = l.find(' ');
+        if ((sp == std::string::npos) || !plan_num(l.substr(0, sp), &quota) ||
+            !plan_num(l.substr(sp + 1), &period)) {
+            continue;
+        }
+        if (period == 0) {
+            continue;
+        }
+        n = static_cast<unsigned>(std::max<uint64_t>(
+            (quota + period - 1) / period, 1));
+        if (!found || (n < *cpus)) {
+            *cpus = n;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static bool plan_num(const std::string &str, uint64_t *const num) {
+    /* Variables */
+    char *end = NULL;
+    /* Digits only ("max", "-1" are no limit) */
+    if (str.empty() || (str[0] < '0') || (str[0] > '9')) {
+        return false;
+    }
+    *num = strtoull(str.c_str(), &end, 10);
+    return *end == '\0';
+}
@@ -0,0 +1,96 @@
+/**
+ * @file plan.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Startup sizing: reactors, workers, session limit and pool
+ * reserves derived from the cgroup limits and the CPUs of the process.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef PLAN_HPP
+#define PLAN_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr uint64_t PLAN_HEADROOM = 25; /**< Memory left out of the plan, % */
+constexpr uint64_t PLAN_BASE = 16 * 1024 * 1024; /**< Process without
+                                                      sessions, bytes */
+constexpr size_t PLAN_SESS_EXTRA = 32 * 1024; /**< Per session besides the
+                                                   object and its queue:
+                                                   line, history, socket
+                                                   buffers, bytes */
+constexpr unsigned PLAN_SESS_MIN = 16; /**< Fewest sessions planned */
+constexpr size_t PLAN_SLAB_MAX = 4096; /**< Session objects reserved up
+                                            front per reactor */
+constexpr size_t PLAN_CHUNKS_MAX = 1024; /**< Output chunks reserved up
+                                              front per reactor */
+constexpr unsigned PLAN_FD_SPARE = 64; /**< Descriptors not given to
+                                            sessions */
+constexpr int PLAN_BACKLOG_MAX = 4096; /**< Largest planned backlog */
+constexpr const char *PLAN_CGROUP = "/sys/fs/cgroup"; /**< cgroupfs mount */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct cfg;
+
+/**
+ * @brief Sizes the server starts with.
+ *
+ * Every session may queue up to oq_high bytes, so the session limit is
+ * what fits the memory limit, less the headroom, in the worst case.
+ */
+struct plan {
+    uint64_t mem; /**< Memory the process may use, bytes */
+    std::string memsrc; /**< Where mem comes from */
+    unsigned cpus; /**< CPUs the process may keep busy */
+    std::string cpusrc; /**< Where cpus comes from */
+    unsigned reactors; /**< Reactor threads (admin one not included) */
+    unsigned workers; /**< Worker threads */
+    unsigned sessions; /**< Most sessions at a time (new clients beyond
+                            are refused) */
+    size_t slab; /**< Session objects reserved per reactor */
+    size_t chunks; /**< Output chunks reserved per reactor */
+    int backlog; /**< Listen queue */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Derives the sizes from the cgroup (v2, or v1 controllers) of the
+ * process, its CPU affinity and descriptor limit; settings that are not
+ * 0 in c take precedence.
+ *
+ * @param p Receives the plan.
+ * @param c Configuration (reactors, workers, sessions_max, mem_limit,
+ * backlog and oq_high are used).
+ * @param lqueue Listen queue of the application (the least backlog).
+ * @param reactors Reactors fixed by the build policy, 0 - planned.
+ * @param workers Workers fixed by the build policy, 0 - planned.
+ */
+void plan_make(struct plan *const p, const struct cfg *const c,
+               const int lqueue, const unsigned reactors,
+               const unsigned workers);
+
+/**
+ * @brief Describes a plan on one line (log, "config").
+ *
+ * @param p The plan.
+ * @return std::string The description.
+ */
+std::string plan_describe(const struct plan *const p);
+
+#endif /* PLAN_HPP */
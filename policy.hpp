@@ -0,0 +1,404 @@
+/**
+ * @file policy.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Compile-time server policies (I/O, logger, allocator, history,
+ * metrics, transport dispatch) and build profiles.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef POLICY_HPP
+#define POLICY_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "io.hpp"
+#include "pool.hpp"
+
+//=============================================================================
+// Logger Policies
+//=============================================================================
+/**
+ * @brief Log levels (a message is printed if level <= current level).
+ */
+enum log_level {
+    LOG_ERROR = 0,
+    LOG_INFO = 1,
+    LOG_TRACE = 2 /**< Per byte FSM trace */
+};
+
+/**
+ * @brief Serialized logger to the standard output.
+ */
+struct log_stdout {
+    static constexpr bool enabled = true;
+    static std::atomic<int> level; /**< Current level (runtime) */
+    static bool on(const enum log_level lvl) {
+        return static_cast<int>(lvl) <= level.load(std::memory_order_relaxed);
+    }
+    static void set_level(const enum log_level lvl) { level = lvl; }
+    static void write(const enum log_level level, const std::string &msg);
+};
+
+/**
+ * @brief Logger that compiles out every message.
+ */
+struct log_null {
+    static constexpr bool enabled = false;
+    static constexpr bool on(const enum log_level) { return false; }
+    static void set_level(const enum log_level) {}
+    static void write(const enum log_level, const std::string &) {}
+};
+
+/**
+ * @brief Writes a fatal startup error to the standard error, whatever the
+ * logger policy (log_null drops the hot path messages only).
+ *
+ * @param msg The message.
+ */
+void log_fatal_write(const std::string &msg);
+
+//=============================================================================
+// Allocator Policies
+//=============================================================================
+/**
+ * @brief Every block comes from malloc() and goes back with free().
+ */
+struct alloc_heap {
+    struct arena {
+        size_t bsize = 0; /**< Block size */
+        size_t nused = 0; /**< Blocks handed out */
+    };
+    static void init(struct arena *const a, const size_t bsize) {
+        a->bsize = bsize;
+        a->nused = 0;
+    }
+    static void fini(struct arena *const) {}
+    static void *get(struct arena *const a) {
+        void *block = malloc(a->bsize);
+        a->nused += (block != NULL) ? 1 : 0;
+        return block;
+    }
+    static void put(struct arena *const a, void *const block) {
+        free(block);
+        --a->nused;
+    }
+    static int reserve(struct arena *const, const size_t) { return 0; }
+    static size_t reserved(const struct arena *const a) {
+        return a->nused * a->bsize;
+    }
+};
+
+/**
+ * @brief Blocks come from per-reactor free list pools (pool.hpp).
+ */
+struct alloc_pool {
+    using arena = struct pool;
+    static void init(struct pool *const a, const size_t bsize) {
+        pool_init(a, bsize);
+    }
+    static void fini(struct pool *const a) { pool_fini(a); }
+    static void *get(struct pool *const a) { return pool_get(a); }
+    static void put(struct pool *const a, void *const block) {
+        pool_put(a, block);
+    }
+    static int reserve(struct pool *const a, const size_t n) {
+        return pool_reserve(a, n);
+    }
+    static size_t reserved(const struct pool *const a) {
+        return pool_reserved(a);
+    }
+};
+
+//=============================================================================
+// History Store Policies
+//=============================================================================
+/**
+ * @brief Bounded history, the oldest command is dropped first (a vector:
+ * shifting N strings is cheap, and an empty one owns no memory, unlike a
+ * deque that allocates a block per idle session).
+ */
+template <size_t N>
+struct hist_ring {
+    using store = std::vector<std::string>;
+    static constexpr size_t limit = N;
+};
+
+/**
+ * @brief Unbounded history (grows for the whole session).
+ */
+struct hist_vector {
+    using store = std::vector<std::string>;
+    static constexpr size_t limit = SIZE_MAX;
+};
+
+/**
+ * @brief No history, ARROW_UP/ARROW_DOWN do nothing.
+ */
+struct hist_none {
+    using store = std::vector<std::string>;
+    static constexpr size_t limit = 0;
+};
+
+//=============================================================================
+// Metrics Policies
+//=============================================================================
+/**
+ * @brief Metric counters.
+ */
+enum mtrc_id {
+    MTRC_ACCEPTED = 0, /**< Sessions started */
+    MTRC_CLOSED, /**< Sessions finished */
+    MTRC_BYTES_IN, /**< Bytes received */
+    MTRC_BYTES_OUT, /**< Bytes sent */
+    MTRC_COMMANDS, /**< Commands executed */
+    MTRC_HIBERNATED, /**< Idle sessions hibernated */
+    MTRC_WOKEN, /**< Hibernated sessions woken by input */
+    MTRC_REFUSED, /**< Clients refused over the session limit */
+    MTRC_DEAD, /**< Sessions closed after unanswered keepalive probes */
+    MTRC_MAX
+};
+
+/**
+ * @brief Histograms (log2 buckets: bucket b counts values of bit width b,
+ * i.e. 0 goes to bucket 0 and [2^(b-1), 2^b) to bucket b).
+ */
+enum mtrc_hist_id {
+    MTRC_H_RTT = 0, /**< TCP smoothed RTT, us */
+    MTRC_H_RTTVAR, /**< TCP RTT variance, us */
+    MTRC_H_RETRANS, /**< TCP retransmits per sample period */
+    MTRC_H_CWND, /**< TCP congestion window, segments */
+    MTRC_H_UNACKED, /**< TCP unacknowledged bytes */
+    MTRC_H_CMD_US, /**< Command execution time, us */
+    MTRC_H_MAX
+};
+
+constexpr size_t MTRC_H_BUCKETS = 65; /**< Bit widths 0..64 */
+
+/**
+ * @brief Relaxed atomic counters (one writer per reactor).
+ */
+struct mtrc_atomic {
+    static constexpr bool enabled = true;
+    struct counters {
+        std::atomic<uint64_t> v[MTRC_MAX] = {};
+        std::atomic<uint64_t> h[MTRC_H_MAX][MTRC_H_BUCKETS] = {};
+    };
+    static void add(struct counters *const c, const enum mtrc_id id,
+                    const uint64_t n) {
+        c->v[id].fetch_add(n, std::memory_order_relaxed);
+    }
+    static uint64_t get(const struct counters *const c,
+                        const enum mtrc_id id) {
+        return c->v[id].load(std::memory_order_relaxed);
+    }
+    static void observe(struct counters *const c,
+                        const enum mtrc_hist_id id, const uint64_t value) {
+        c->h[id][std::bit_width(value)].fetch_add(1,
+                                                  std::memory_order_relaxed);
+    }
+    static uint64_t bucket(const struct counters *const c,
+                           const enum mtrc_hist_id id, const size_t b) {
+        return c->h[id][b].load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief No metrics (empty counters, no-op updates).
+ */
+struct mtrc_none {
+    static constexpr bool enabled = false;
+    struct counters {};
+    static void add(struct counters *const, const enum mtrc_id,
+                    const uint64_t) {}
+    static uint64_t get(const struct counters *const, const enum mtrc_id) {
+        return 0;
+    }
+    static void observe(struct counters *const, const enum mtrc_hist_id,
+                        const uint64_t) {}
+    static uint64_t bucket(const struct counters *const,
+                           const enum mtrc_hist_id, const size_t) {
+        return 0;
+    }
+};
+
+//=============================================================================
+// Transport Dispatch Policies
+//=============================================================================
+/**
+ * @brief Transport calls go through struct trns_ops (socket, loopback,
+ * user provided transports).
+ */
+struct trns_dynamic {
+    static constexpr bool dynamic = true;
+};
+
+/**
+ * @brief Transport calls are direct socket syscalls (sockets only).
+ */
+struct trns_static {
+    static constexpr bool dynamic = false;
+};
+
+//=============================================================================
+// Feature Policies
+//=============================================================================
+/**
+ * @brief Every optional feature is built.
+ */
+struct feat_all {
+    static constexpr bool rpc = true; /**< RPC mode (rpc.hpp) */
+    static constexpr bool mux = true; /**< Channel mode (mux.hpp), needs
+                                           trns_dynamic */
+    static constexpr bool auth = true; /**< Login stage (auth.hpp) */
+    static constexpr bool proc = true; /**< Programs as commands (proc.hpp) */
+    static constexpr bool watch = true; /**< "watch" (wtch.hpp) */
+    static constexpr bool pager = true; /**< Screen by screen output
+                                             (pgr.hpp) */
+    static constexpr bool prof = true; /**< CPU profiler, "prof" (prof.hpp) */
+};
+
+/**
+ * @brief Line mode commands only: the feature modules are not built
+ * (CMakeLists.txt) and the calls into them are discarded at compile time.
+ */
+struct feat_none {
+    static constexpr bool rpc = false;
+    static constexpr bool mux = false;
+    static constexpr bool auth = false;
+    static constexpr bool proc = false;
+    static constexpr bool watch = false;
+    static constexpr bool pager = false;
+    static constexpr bool prof = false;
+};
+
+//=============================================================================
+// Profiles
+//=============================================================================
+/**
+ * @brief Data center build: epoll reactors and RPC workers on every CPU,
+ * pooled memory, logging and metrics, every feature.
+ */
+struct tlnt_policy_full {
+    using io = struct io_epoll;
+    static constexpr unsigned reactors = 0; /**< 0 - planned (plan.hpp) */
+    static constexpr unsigned workers = 0; /**< 0 - planned (plan.hpp) */
+    using log = struct log_stdout;
+    using alloc = struct alloc_pool;
+    using hist = struct hist_ring<100>;
+    using mtrc = struct mtrc_atomic;
+    using trns = struct trns_dynamic;
+    using feat = struct feat_all;
+};
+
+/**
+ * @brief Embedded build: a single poll() reactor and a single worker,
+ * heap memory, short history, no logs, no metrics, direct socket calls,
+ * line mode commands only.
+ */
+struct tlnt_policy_minimal {
+    using io = struct io_poll;
+    static constexpr unsigned reactors = 1;
+    static constexpr unsigned workers = 1;
+    using log = struct log_null;
+    using alloc = struct alloc_heap;
+    using hist = struct hist_ring<10>;
+    using mtrc = struct mtrc_none;
+    using trns = struct trns_static;
+    using feat = struct feat_none;
+};
+
+#if defined(TLNT_PROFILE_MINIMAL)
+using tlnt_policy = struct tlnt_policy_minimal;
+#else
+using tlnt_policy = struct tlnt_policy_full;
+#endif
+static_assert(!tlnt_policy::feat::mux || tlnt_policy::trns::dynamic,
+              "channels are transports of their own");
+
+//=============================================================================
+// Policy Helpers
+//=============================================================================
+/**
+ * @brief Formats and writes a log message (compiled out by log_null).
+ *
+ * @param level Message level.
+ * @param args Values streamed into the message.
+ */
+template <class... Args>
+static inline void log_msg(const enum log_level level, const Args &...args) {
+    if constexpr (tlnt_policy::log::enabled) {
+        if (tlnt_policy::log::on(level)) {
+            std::ostringstream os;
+            (os << ... << args);
+            tlnt_policy::log::write(level, os.str());
+        }
+    }
+}
+
+/**
+ * @brief Changes the runtime log level.
+ *
+ * @param level Messages above this level are dropped.
+ */
+static inline void log_set_level(const enum log_level level) {
+    tlnt_policy::log::set_level(level);
+}
+
+template <class... Args>
+static inline void log_error(const Args &...args) {
+    log_msg(LOG_ERROR, args...);
+}
+
+template <class... Args>
+static inline void log_info(const Args &...args) {
+    log_msg(LOG_INFO, args...);
+}
+
+template <class... Args>
+static inline void log_trace(const Args &...args) {
+    log_msg(LOG_TRACE, args...);
+}
+
+/**
+ * @brief Formats a fatal startup error, never compiled out.
+ *
+ * @param args Values streamed into the message.
+ */
+template <class... Args>
+static inline void log_fatal(const Args &...args) {
+    std::ostringstream os;
+    (os << ... << args);
+    log_fatal_write(os.str());
+}
+
+/**
+ * @brief Adds to a metric counter (compiled out by mtrc_none).
+ */
+static inline void mtrc_add(tlnt_policy::mtrc::counters *const c,
+                            const enum mtrc_id id, const uint64_t n) {
+    tlnt_policy::mtrc::add(c, id, n);
+}
+
+/**
+ * @brief Records a histogram sample (compiled out by mtrc_none).
+ */
+static inline void mtrc_observe(tlnt_policy::mtrc::counters *const c,
+                                const enum mtrc_hist_id id,
+                                const uint64_t value) {
+    tlnt_policy::mtrc::observe(c, id, value);
+}
+
+#endif /* POLICY_HPP */
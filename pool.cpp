@@ -0,0 +1,115 @@
+/**
+ * @file pool.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Fixed-size block pools (sessions, output chunks).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cstdlib>
+#include "pool.hpp"
+
+//==============================================================================
+// Definitions
+//==============================================================================
+constexpr size_t POOL_SLAB_BLOCKS = 64; /**< Blocks carved per slab */
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Allocates a slab and puts its blocks in the free list.
+ *
+ * @param p The pool.
+ * @return int 0 on success, or -1 when out of memory.
+ */
+static int pool_grow(struct pool *const p);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void pool_init(struct pool *const p, const size_t bsize) {
+    p->bsize = (bsize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    if (p->bsize < sizeof(void *)) {
+        p->bsize = sizeof(void *);
+    }
+    p->free = NULL;
+    p->slabs.clear();
+    p->nused = 0;
+    p->nfree = 0;
+}
+
+void pool_fini(struct pool *const p) {
+    for (void *slab : p->slabs) {
+        free(slab);
+    }
+    p->slabs.clear();
+    p->free = NULL;
+    p->nused = 0;
+    p->nfree = 0;
+}
+
+void *pool_get(struct pool *const p) {
+    /* Variables */
+    void *block;
+    /* New slab */
+    if ((p->free == NULL) && (pool_grow(p) < 0)) {
+        return NULL;
+    }
+    /* Pop */
+    block = p->free;
+    p->free = *static_cast<void **>(block);
+    --p->nfree;
+    ++p->nused;
+    return block;
+}
+
+void pool_put(struct pool *const p, void *const block) {
+    *static_cast<void **>(block) = p->free;
+    p->free = block;
+    ++p->nfree;
+    --p->nused;
+}
+
+int pool_reserve(struct pool *const p, const size_t n) {
+    while (p->nfree < n) {
+        if (pool_grow(p) < 0) {
+            return (-1);
+        }
+    }
+    return 0;
+}
+
+size_t pool_reserved(const struct pool *const p) {
+    return p->slabs.size() * p->bsize * POOL_SLAB_BLOCKS;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int pool_grow(struct pool *const p) {
+    /* Variables */
+    char *slab = static_cast<char *>(malloc(p->bsize * POOL_SLAB_BLOCKS));
+    /* Carve */
+    if (slab == NULL) {
+        return (-1);
+    }
+    try {
+        p->slabs.push_back(slab);
+    } catch (const std::bad_alloc& e) {
+        free(slab);
+        return (-1);
+    }
+    for (size_t i = 0; i < POOL_SLAB_BLOCKS; ++i) {
+        pool_put(p, slab + (i * p->bsize));
+        ++p->nused; /* pool_put() counts a return */
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file pool.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Fixed-size block pools (sessions, output chunks).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <vector>
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Free list pool of equally sized blocks.
+ *
+ * Blocks are carved from slabs of POOL_SLAB_BLOCKS blocks and are never
+ * returned to the system while the pool lives. A pool is owned by one
+ * reactor thread and is not thread-safe.
+ */
+struct pool {
+    size_t bsize = 0; /**< Block size (rounded up to a pointer) */
+    void *free = NULL; /**< Free list head */
+    std::vector<void *> slabs; /**< Allocated slabs */
+    size_t nused = 0; /**< Blocks handed out */
+    size_t nfree = 0; /**< Blocks in the free list */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Initializes a pool.
+ *
+ * @param p The pool.
+ * @param bsize Block size in bytes.
+ */
+void pool_init(struct pool *const p, const size_t bsize);
+
+/**
+ * @brief Frees every slab of the pool (all blocks must be returned).
+ *
+ * @param p The pool.
+ */
+void pool_fini(struct pool *const p);
+
+/**
+ * @brief Takes a block from the pool.
+ *
+ * @param p The pool.
+ * @return void* Block on success, or NULL when out of memory.
+ */
+void *pool_get(struct pool *const p);
+
+/**
+ * @brief Returns a block to the pool.
+ *
+ * @param p The pool.
+ * @param block Block taken by pool_get().
+ */
+void pool_put(struct pool *const p, void *const block);
+
+/**
+ * @brief Carves slabs until at least n blocks are free (sized up front,
+ * no allocation on the first n pool_get() calls).
+ *
+ * @param p The pool.
+ * @param n Number of blocks.
+ * @return int 0 on success, or -1 when out of memory.
+ */
+int pool_reserve(struct pool *const p, const size_t n);
+
+/**
+ * @brief Returns the bytes currently reserved by the pool.
+ *
+ * @param p The pool.
+ * @return size_t Reserved bytes (used and free blocks).
+ */
+size_t pool_reserved(const struct pool *const p);
+
+#endif /* POOL_HPP */
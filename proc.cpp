@@ -0,0 +1,582 @@
+/**
+ * @file proc.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief External programs run for a session (posix_spawn, pipes or a
+ * PTY), their output driven by the session reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include "proc.hpp"
+#include "sess.hpp"
+#include "srv.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Command of a configured program: runs it with the arguments of
+ * the line in the foreground of the session.
+ *
+ * @param call Call context (the program is looked up by argv[0] in a
+ * snapshot held for the call).
+ * @return int 0 on success, or -1 on failure.
+ */
+static int proc_cmd(struct cmd_call *const call);
+
+/**
+ * @brief Starts the child: pipes or a PTY as its standard descriptors,
+ * a process group (or session) of its own, default signals.
+ *
+ * @param x The program (out, in, pid and pidfd filled on success).
+ * @param prog The configured program.
+ * @param argv Arguments, NULL terminated.
+ * @param s The session (terminal size).
+ * @return int 0 on success, or -1 on failure.
+ */
+static int proc_spawn(struct proc *const x, const struct cfg_program *const prog,
+                      char *const *const argv, const struct sess *const s);
+
+/**
+ * @brief Reactor handler of the output: splices it to the socket or
+ * queues it, pauses while the client lags behind.
+ *
+ * @param h proc::outh.
+ * @param events IO_* ready.
+ */
+static void proc_on_out(struct rctr_fd *const h, const uint32_t events);
+
+/**
+ * @brief Reactor handler of the pidfd: reaps the child.
+ *
+ * @param h proc::exith.
+ * @param events IO_* ready.
+ */
+static void proc_on_exit(struct rctr_fd *const h, const uint32_t events);
+
+/**
+ * @brief Tells whether output may skip the queue: raw pipe output, a TCP
+ * connection with nothing queued and no output limit.
+ *
+ * @param s The session.
+ * @param x Its program.
+ * @param conf Current configuration.
+ * @return bool true if splice() may be used.
+ */
+static bool proc_direct(const struct sess *const s, const struct proc *const x,
+                        const struct cfg *const conf);
+
+/**
+ * @brief Closes the output (end of file), the program may be done.
+ *
+ * @param x The program.
+ */
+static void proc_eof(struct proc *const x);
+
+/**
+ * @brief Ends a program whose output ended and whose child was reaped:
+ * the exit status if it failed, then the prompt.
+ *
+ * @param s The session.
+ */
+static void proc_finish(struct sess *const s);
+
+/**
+ * @brief Sends queued output of a session (and of its connection).
+ *
+ * @param s The session.
+ */
+static void proc_flush(struct sess *const s);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int proc_sync(struct srv *const srv, const struct cfg *const prev,
+              const struct cfg *const next) {
+    /* Variables */
+    bool kept;
+    /* Programs gone from the configuration */
+    if (prev != NULL) {
+        for (const struct cfg_program &p : prev->programs) {
+            kept = false;
+            for (const struct cfg_program &q : next->programs) {
+                kept = kept || (q.name == p.name);
+            }
+            if (!kept) {
+                srv_cmd_unregister(srv, p.name);
+            }
+        }
+    }
+    /* Writes to a program that quit fail with EPIPE, the server lives */
+    if (!next->programs.empty()) {
+        signal(SIGPIPE, SIG_IGN);
+    }
+    /* New ones, the others point to the new snapshot */
+    try {
+        for (const struct cfg_program &p : next->programs) {
+            if (srv_cmd_register(srv, p.name, proc_cmd, NULL,
+                                 "Run " + p.path) < 0) {
+                return (-1);
+            }
+        }
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    return 0;
+}
+
+int proc_key(struct sess *const s, const char key) {
+    /* Variables */
+    struct proc *x = s->proc.get();
+    char c = key;
+    pid_t pgrp = 0;
+    /* Enter comes as "\r\n" or "\r\0" from Telnet */
+    if (x->cr && ((key == '\n') || (key == '\0'))) {
+        x->cr = false;
+        return 0;
+    }
+    x->cr = (key == '\r');
+    /* Ctrl + C - a pipe: the process group (not after the reap: the pid
+     * is free); a PTY: the line discipline signals the foreground job (a
+     * job control shell runs it in a group of its own), a full master the
+     * same group by hand */
+    if (key == '\x03') {
+        if (!x->pty && (x->pidfd >= 0)) {
+            kill(-x->pid, SIGINT);
+        } else if (x->pty && (x->pidfd >= 0) &&
+                   ((x->in < 0) || (write(x->in, &c, 1) < 0)) &&
+                   ((pgrp = tcgetpgrp(x->out)) > 0)) {
+            kill(-pgrp, SIGINT);
+        }
+        return 0;
+    }
+    if (x->in < 0) {
+        return 0;
+    }
+    /* A PTY edits and echoes by itself, a pipe gets lines and Ctrl + D
+     * closes it */
+    if (!x->pty) {
+        if (key == '\x04') {
+            close(x->in);
+            x->in = (-1);
+            return 0;
+        }
+        c = (key == '\r') ? '\n' : key;
+        if ((c == '\n') && (sess_echo(s, "\r\n", 2) < 0)) {
+            return (-1);
+        }
+        if (isprint(static_cast<unsigned char>(c)) &&
+            (sess_echo(s, &c, 1) < 0)) {
+            return (-1);
+        }
+    }
+    /* A full pipe drops the key: the program does not read */
+    if ((write(x->in, &c, 1) < 0) && (errno != EAGAIN) && (errno != EINTR) &&
+        !x->pty) {
+        close(x->in);
+        x->in = (-1);
+    }
+    return 0;
+}
+
+void proc_resume(struct sess *const s) {
+    /* Variables */
+    struct proc *x = s->proc.get();
+    /* Paused output only */
+    if (!x->paused || (x->out < 0)) {
+        return;
+    }
+    if (rctr_fd_mod(s->rctr, x->out, IO_IN, &x->outh) < 0) {
+        rctr_sess_close(s);
+        return;
+    }
+    x->paused = false;
+}
+
+void proc_winsize(struct sess *const s) {
+    /* Variables */
+    struct proc *x = s->proc.get();
+    struct winsize ws = {};
+    /* The kernel sends SIGWINCH to the foreground group */
+    if (!x->pty || (x->out < 0)) {
+        return;
+    }
+    ws.ws_col = (s->cols > 0) ? s->cols : PROC_COLS;
+    ws.ws_row = (s->rows > 0) ? s->rows : PROC_ROWS;
+    ioctl(x->out, TIOCSWINSZ, &ws);
+}
+
+void proc_stop(struct sess *const s) {
+    /* Variables */
+    struct proc *x = s->proc.get();
+    struct rctr *r = s->rctr;
+    /* No program */
+    if (x == NULL) {
+        return;
+    }
+    if (x->out >= 0) {
+        rctr_fd_del(r, x->out, &x->outh);
+        close(x->out);
+    }
+    if ((x->in >= 0) && (x->in != x->out)) {
+        close(x->in);
+    }
+    /* A running child goes with its group, reaped now or later */
+    if (x->pidfd >= 0) {
+        kill(-x->pid, SIGKILL);
+        rctr_fd_del(r, x->pidfd, &x->exith);
+        close(x->pidfd);
+        if (waitpid(x->pid, NULL, WNOHANG) == 0) {
+            try {
+                r->orphans.push_back(x->pid);
+            } catch (const std::bad_alloc& e) {
+                waitpid(x->pid, NULL, 0);
+            }
+        }
+    }
+    s->proc.reset();
+}
+
+void proc_reap(struct rctr *const r, const bool wait) {
+    /* Variables */
+    size_t keep = 0;
+    /* Killed children that have not exited yet stay */
+    for (const pid_t pid : r->orphans) {
+        if ((waitpid(pid, NULL, wait ? 0 : WNOHANG) == 0)) {
+            r->orphans[keep++] = pid;
+        }
+    }
+    r->orphans.resize(keep);
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int proc_cmd(struct cmd_call *const call) {
+    /* Variables */
+    const std::shared_ptr<const struct cfg> conf = cfg_hold(&call->srv->conf);
+    const struct cfg_program *prog = NULL;
+    struct sess *s = call->sess;
+    std::vector<std::string> args;
+    std::vector<char *> argv;
+    struct proc *x;
+    /* Terminals only: the output is driven by the session reactor */
+    if ((s == NULL) || (s->mode != SESS_TEXT)) {
+        call->out->append("Error: programs need a terminal session\r\n");
+        return (-1);
+    }
+    if ((s->proc != NULL) || (s->watch != NULL)) {
+        call->out->append("Error: session is busy\r\n"); /* Scripts */
+        return (-1);
+    }
+    if (call->argv.size() > PROC_ARGS_MAX) {
+        call->out->append("Error: too many arguments\r\n");
+        return (-1);
+    }
+    /* The program as configured now (a reload may have just removed it) */
+    for (const struct cfg_program &p : conf->programs) {
+        if (p.name == call->argv[0]) {
+            prog = &p;
+            break;
+        }
+    }
+    if (prog == NULL) {
+        call->out->append("Error: no such program\r\n");
+        return (-1);
+    }
+    /* The path, then the words after the name */
+    try {
+        args.emplace_back(prog->path);
+        for (size_t i = 1; i < call->argv.size(); ++i) {
+            args.emplace_back(call->argv[i]);
+        }
+        for (std::string &arg : args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(NULL);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    x = new (std::nothrow) struct proc;
+    if (x == NULL) {
+        return (-1);
+    }
+    x->sess = s;
+    x->outh = { .cb = proc_on_out, .arg = x };
+    x->exith = { .cb = proc_on_exit, .arg = x };
+    x->pty = prog->pty;
+    x->raw = prog->raw;
+    x->paused = false;
+    x->cr = false;
+    x->status = 0;
+    if (proc_spawn(x, prog, argv.data(), s) < 0) {
+        delete x;
+        call->out->append("Error: cannot run " + prog->name + "\r\n");
+        return (-1);
+    }
+    s->proc.reset(x);
+    /* Watched until the output ends and the child exits */
+    if ((rctr_fd_add(s->rctr, x->out, IO_IN, &x->outh) < 0) ||
+        (rctr_fd_add(s->rctr, x->pidfd, IO_IN, &x->exith) < 0)) {
+        proc_stop(s);
+        call->out->append("Error: cannot run " + prog->name + "\r\n");
+        return (-1);
+    }
+    log_info("Program ", prog->name, " pid ", x->pid, " session ", s->id);
+    return 0;
+}
+
+static int proc_spawn(struct proc *const x, const struct cfg_program *const prog,
+                      char *const *const argv, const struct sess *const s) {
+    /* Variables */
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t attr;
+    sigset_t mask;
+    sigset_t def;
+    int in[2] = { -1, -1 };
+    int out[2] = { -1, -1 };
+    char tty[64];
+    struct winsize ws = {};
+    int result = (-1);
+    /* Default signals and an empty mask (the server blocks and ignores
+     * some), a group of its own for Ctrl + C */
+    x->out = (-1);
+    x->in = (-1);
+    x->pidfd = (-1);
+    if (posix_spawn_file_actions_init(&fa) != 0) {
+        return (-1);
+    }
+    if (posix_spawnattr_init(&attr) != 0) {
+        posix_spawn_file_actions_destroy(&fa);
+        return (-1);
+    }
+    sigemptyset(&mask);
+    sigemptyset(&def);
+    sigaddset(&def, SIGINT);
+    sigaddset(&def, SIGTERM);
+    sigaddset(&def, SIGHUP);
+    sigaddset(&def, SIGPIPE);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setsigdefault(&attr, &def);
+    /* PTY: a session of its own, the slave opened after setsid() becomes
+     * its controlling terminal; pipes: a process group */
+    if (prog->pty) {
+        x->out = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        ws.ws_col = (s->cols > 0) ? s->cols : PROC_COLS;
+        ws.ws_row = (s->rows > 0) ? s->rows : PROC_ROWS;
+        if ((x->out < 0) || (grantpt(x->out) < 0) || (unlockpt(x->out) < 0) ||
+            (ptsname_r(x->out, tty, sizeof(tty)) != 0) ||
+            (ioctl(x->out, TIOCSWINSZ, &ws) < 0)) {
+            goto proc_spawn_fini;
+        }
+        x->in = x->out;
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID |
+                                 POSIX_SPAWN_SETSIGMASK |
+                                 POSIX_SPAWN_SETSIGDEF);
+        posix_spawn_file_actions_addopen(&fa, 0, tty, O_RDWR, 0);
+        posix_spawn_file_actions_adddup2(&fa, 0, 1);
+        posix_spawn_file_actions_adddup2(&fa, 0, 2);
+    } else {
+        if ((pipe2(in, O_CLOEXEC) < 0) || (pipe2(out, O_CLOEXEC) < 0)) {
+            goto proc_spawn_fini;
+        }
+        x->in = in[1];
+        x->out = out[0];
+        posix_spawnattr_setpgroup(&attr, 0);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP |
+                                 POSIX_SPAWN_SETSIGMASK |
+                                 POSIX_SPAWN_SETSIGDEF);
+        posix_spawn_file_actions_adddup2(&fa, in[0], 0);
+        posix_spawn_file_actions_adddup2(&fa, out[1], 1);
+        posix_spawn_file_actions_adddup2(&fa, out[1], 2);
+    }
+    /* Spawn (vfork-like, the server memory is not copied) */
+    if (posix_spawn(&x->pid, prog->path.c_str(), &fa, &attr, argv,
+                    environ) != 0) {
+        goto proc_spawn_fini;
+    }
+    x->pidfd = static_cast<int>(syscall(SYS_pidfd_open, x->pid, 0));
+    if (x->pidfd < 0) {
+        kill(-x->pid, SIGKILL);
+        waitpid(x->pid, NULL, 0);
+        goto proc_spawn_fini;
+    }
+    /* Our ends never block the reactor */
+    if ((fcntl(x->out, F_SETFL, O_NONBLOCK) < 0) ||
+        (!prog->pty && (fcntl(x->in, F_SETFL, O_NONBLOCK) < 0))) {
+        kill(-x->pid, SIGKILL);
+        waitpid(x->pid, NULL, 0);
+        close(x->pidfd);
+        x->pidfd = (-1);
+        goto proc_spawn_fini;
+    }
+    result = 0;
+proc_spawn_fini:
+    /* The child ends are the child's only */
+    for (const int fd : { in[0], out[1] }) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (result < 0) {
+        if ((x->in >= 0) && (x->in != x->out)) {
+            close(x->in);
+        }
+        if (x->out >= 0) {
+            close(x->out);
+        }
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&fa);
+    return result;
+}
+
+static void proc_on_out(struct rctr_fd *const h, const uint32_t) {
+    /* Variables */
+    struct proc *x = static_cast<struct proc *>(h->arg);
+    struct sess *s = x->sess;
+    struct rctr *r = s->rctr;
+    const struct cfg *conf = r->conf.get();
+    ssize_t n;
+    /* Straight from the pipe to the socket, no copy through user space
+     * (EAGAIN: the socket is full or the pipe empty, read below tells) */
+    if (proc_direct(s, x, conf)) {
+        n = splice(x->out, NULL, s->trns->fd, NULL, PROC_SPLICE_MAX,
+                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            mtrc_add(&r->mtrc, MTRC_BYTES_OUT, static_cast<uint64_t>(n));
+            rctr_sess_account(s, 0, static_cast<uint64_t>(n), 0);
+            return;
+        }
+        if (n == 0) {
+            proc_eof(x);
+            return;
+        }
+        if ((errno == EPIPE) || (errno == ECONNRESET)) {
+            rctr_sess_close(s);
+            return;
+        }
+    }
+    /* Through the queue (encoded unless raw) */
+    n = read(x->out, r->rbuf, sizeof(r->rbuf));
+    if (n < 0) {
+        if ((errno == EAGAIN) || (errno == EINTR)) {
+            return;
+        }
+        proc_eof(x); /* EIO: the PTY slave is closed */
+        return;
+    }
+    if (n == 0) {
+        proc_eof(x);
+        return;
+    }
+    if ((x->raw ? sess_write(s, r->rbuf, static_cast<size_t>(n)) :
+                  sess_text(s, r->rbuf, static_cast<size_t>(n))) < 0) {
+        rctr_sess_close(s);
+        return;
+    }
+    /* Backpressure: the program blocks on its full pipe (or PTY) until
+     * the queue drains below oq_low (proc_resume()) */
+    if (sess_queued(s) > conf->oq_high) {
+        if (rctr_fd_mod(r, x->out, 0, &x->outh) < 0) {
+            rctr_sess_close(s);
+            return;
+        }
+        x->paused = true;
+    }
+    proc_flush(s);
+}
+
+static void proc_on_exit(struct rctr_fd *const h, const uint32_t) {
+    /* Variables */
+    struct proc *x = static_cast<struct proc *>(h->arg);
+    /* Reap, the output may still hold the last bytes */
+    if (waitpid(x->pid, &x->status, WNOHANG) <= 0) {
+        return;
+    }
+    rctr_fd_del(x->sess->rctr, x->pidfd, &x->exith);
+    close(x->pidfd);
+    x->pidfd = (-1);
+    if (x->out < 0) {
+        proc_finish(x->sess);
+    }
+}
+
+static bool proc_direct(const struct sess *const s, const struct proc *const x,
+                        const struct cfg *const conf) {
+    /* Variables */
+    const int64_t own = s->rate.load(std::memory_order_relaxed);
+    const uint64_t rate = (own < 0) ? conf->rate_session : own;
+    /* Nothing may be overtaken or shaped */
+    return x->raw && !x->pty && s->tcp && (s->parent == NULL) &&
+           (sess_queued(s) == 0) && (rate == 0) && (conf->rate_global == 0);
+}
+
+static void proc_eof(struct proc *const x) {
+    /* PTY: the master is the input as well */
+    rctr_fd_del(x->sess->rctr, x->out, &x->outh);
+    close(x->out);
+    if (x->in == x->out) {
+        x->in = (-1);
+    }
+    x->out = (-1);
+    if (x->pidfd < 0) {
+        proc_finish(x->sess);
+    }
+}
+
+static void proc_finish(struct sess *const s) {
+    /* Variables */
+    struct proc *x = s->proc.get();
+    const int status = x->status;
+    std::string msg;
+    /* Done */
+    if (x->in >= 0) {
+        close(x->in);
+    }
+    s->proc.reset();
+    try {
+        if (WIFSIGNALED(status)) {
+            msg = "\r\nSignal " + std::to_string(WTERMSIG(status)) + "\r\n";
+        } else if (WEXITSTATUS(status) != 0) {
+            msg = "Exit " + std::to_string(WEXITSTATUS(status)) + "\r\n";
+        }
+    } catch (const std::bad_alloc& e) {
+        rctr_sess_close(s);
+        return;
+    }
+    if ((sess_write(s, msg) < 0) || (parser_prompt(s) < 0)) {
+        rctr_sess_close(s);
+        return;
+    }
+    proc_flush(s);
+}
+
+static void proc_flush(struct sess *const s) {
+    /* Channel output lands in the queue of its connection */
+    if ((rctr_sess_flush(s) == 0) && (s->parent != NULL)) {
+        rctr_sess_flush(s->parent);
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file proc.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief External programs run for a session (posix_spawn, pipes or a
+ * PTY), their output driven by the session reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef PROC_HPP
+#define PROC_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include "rctr.hpp"
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr size_t PROC_SPLICE_MAX = 64 * 1024; /**< Bytes moved per splice */
+constexpr size_t PROC_ARGS_MAX = 64; /**< Arguments given to a program */
+constexpr uint16_t PROC_COLS = 80; /**< PTY of a terminal without NAWS */
+constexpr uint16_t PROC_ROWS = 24;
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct sess;
+struct cfg;
+
+/**
+ * @brief Program running in the foreground of a session (sess::proc).
+ *
+ * The output descriptor and the pidfd are watched by the session
+ * reactor, the program is done once both the output ended and the
+ * process exited.
+ */
+struct proc {
+    struct sess *sess; /**< Owning session */
+    pid_t pid; /**< Child, leader of its process group */
+    int out; /**< Output: pipe read end or PTY master (non-blocking) */
+    int in; /**< Input: pipe write end or the PTY master, -1 - closed */
+    int pidfd; /**< Readable once the child exited, -1 - reaped */
+    struct rctr_fd outh; /**< Reactor handler of out */
+    struct rctr_fd exith; /**< Reactor handler of pidfd */
+    bool pty; /**< Runs on a PTY */
+    bool raw; /**< Unencoded output, splice allowed */
+    bool paused; /**< Output not read (client lags behind) */
+    bool cr; /**< Last key was '\r' (its '\n' or '\0' is skipped) */
+    int status; /**< waitpid() status once reaped */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Registers the programs of a new configuration as commands and
+ * removes those the previous one had and the new one does not.
+ *
+ * @param srv The server.
+ * @param prev Previous configuration, NULL on start.
+ * @param next New configuration (the commands look their program up in
+ * the snapshot current when they run).
+ * @return int 0 on success, or -1 on failure.
+ */
+int proc_sync(struct srv *const srv, const struct cfg *const prev,
+              const struct cfg *const next);
+
+/**
+ * @brief Handles a key typed while a program runs: Ctrl + C interrupts
+ * its process group, Enter becomes '\r' (PTY) or '\n', anything else is
+ * written to the program input (dropped while it does not read).
+ *
+ * @param s The session (running a program).
+ * @param key The key.
+ * @return int 0 on success, or -1 on failure.
+ */
+int proc_key(struct sess *const s, const char key);
+
+/**
+ * @brief Reads the output of a program paused by the output backpressure
+ * again (the session queue drained below oq_low).
+ *
+ * @param s The session.
+ */
+void proc_resume(struct sess *const s);
+
+/**
+ * @brief Passes the terminal size of the session to the PTY of its
+ * program (NAWS).
+ *
+ * @param s The session.
+ */
+void proc_winsize(struct sess *const s);
+
+/**
+ * @brief Kills the program of a session (session close), a child that
+ * has not exited yet is reaped later by its reactor.
+ *
+ * @param s The session.
+ */
+void proc_stop(struct sess *const s);
+
+/**
+ * @brief Reaps killed programs of a reactor (reactor thread only).
+ *
+ * @param r The reactor.
+ * @param wait Waits for every child (reactor stop).
+ */
+void proc_reap(struct rctr *const r, const bool wait);
+
+#endif /* PROC_HPP */
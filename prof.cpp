@@ -0,0 +1,472 @@
+/**
+ * @file prof.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Built-in sampling CPU profiler: SIGPROF per thread CPU timers,
+ * frame pointer stacks, folded stack output for flame graphs.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <link.h>
+#include <pthread.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "prof.hpp"
+
+//==============================================================================
+// Definitions
+//==============================================================================
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief One sample: the interrupted PC and the return addresses above.
+ */
+struct prof_sample {
+    uint32_t depth; /**< Frames in pc */
+    uintptr_t pc[PROF_DEPTH]; /**< Leaf first */
+};
+
+/**
+ * @brief Samples of one thread in one profile (written by its SIGPROF
+ * handler only, read once the handler is quiet).
+ */
+struct prof_buf {
+    char name[16]; /**< Thread name */
+    size_t n; /**< Samples taken */
+    uint64_t dropped; /**< Samples that did not fit */
+    std::vector<struct prof_sample> samples; /**< Preallocated */
+};
+
+/**
+ * @brief A profilable thread (thread_local, listed in prof_threads).
+ */
+struct prof_thr {
+    pid_t tid; /**< Kernel thread id (timer signal target) */
+    pthread_t self; /**< For its CPU clock */
+    uintptr_t stack_hi; /**< Top of the stack: frames are walked below */
+    char name[16]; /**< Thread name */
+    timer_t timer; /**< CPU time timer while profiling */
+    bool armed; /**< timer exists */
+    std::atomic<struct prof_buf *> buf; /**< Samples go here, NULL - off */
+    std::atomic<bool> busy; /**< Handler running (stop waits for it) */
+};
+
+/**
+ * @brief A function symbol of the executable.
+ */
+struct prof_sym {
+    uintptr_t addr; /**< Run time address */
+    uintptr_t size; /**< Bytes */
+    const char *name; /**< Mangled name (into prof_elf) */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief SIGPROF handler: records the stack of the interrupted thread
+ * (async-signal-safe, no allocation).
+ */
+static void prof_handler(int sig, siginfo_t *info, void *ctx);
+
+/**
+ * @brief Stops the timer and the sampling of a thread (prof_mutex held).
+ *
+ * @param t The thread.
+ */
+static void prof_thr_off(struct prof_thr *const t);
+
+/**
+ * @brief Loads the function symbols of the executable (called once).
+ */
+static void prof_syms_load();
+
+/**
+ * @brief Name of a code address: the executable symbol table, then the
+ * dynamic symbols of shared objects, then "object+0xoffset".
+ *
+ * @param pc The address.
+ * @return std::string Demangled name.
+ */
+static std::string prof_symbolize(const uintptr_t pc);
+
+/**
+ * @brief dl_iterate_phdr() callback: load base of the executable (the
+ * first object).
+ */
+static int prof_exe_base(struct dl_phdr_info *info, size_t size, void *data);
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+static thread_local struct prof_thr prof_self; /**< The calling thread */
+static std::mutex prof_mutex; /**< Protects the variables below */
+static std::vector<struct prof_thr *> prof_threads; /**< Registered */
+static std::vector<std::unique_ptr<struct prof_buf>> prof_bufs; /**< Of the
+                                                    running profile */
+static bool prof_running = false; /**< A profile is running */
+static std::once_flag prof_once; /**< Handler installed */
+static std::once_flag prof_syms_once; /**< Symbols loaded */
+static std::string prof_elf; /**< Executable image (symbol names) */
+static std::vector<struct prof_sym> prof_syms; /**< Sorted by address */
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void prof_thread_enter(const char *const name) {
+    /* Variables */
+    struct prof_thr *t = &prof_self;
+    pthread_attr_t attr;
+    void *addr = NULL;
+    size_t size = 0;
+    /* Stack bounds for the unwinder */
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstack(&attr, &addr, &size);
+        pthread_attr_destroy(&attr);
+    }
+    t->tid = gettid();
+    t->self = pthread_self();
+    t->stack_hi = reinterpret_cast<uintptr_t>(addr) + size;
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t->armed = false;
+    t->buf = NULL;
+    t->busy = false;
+    try {
+        std::lock_guard<std::mutex> lock(prof_mutex);
+        prof_threads.push_back(t);
+    } catch (const std::bad_alloc& e) {
+        /* Not profiled */
+    }
+}
+
+void prof_thread_leave() {
+    /* Variables */
+    struct prof_thr *t = &prof_self;
+    std::lock_guard<std::mutex> lock(prof_mutex);
+    /* Off the list, the samples stay with the profile */
+    auto it = std::find(prof_threads.begin(), prof_threads.end(), t);
+    if (it != prof_threads.end()) {
+        prof_thr_off(t);
+        prof_threads.erase(it);
+    }
+}
+
+int prof_start(const unsigned seconds) {
+    /* Variables */
+    struct sigevent sev;
+    struct itimerspec its;
+    clockid_t clk;
+    std::unique_ptr<struct prof_buf> b;
+    std::lock_guard<std::mutex> lock(prof_mutex);
+    /* One profile at a time */
+    if (prof_running) {
+        errno = EBUSY;
+        return (-1);
+    }
+    std::call_once(prof_once, []() {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = prof_handler;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGPROF, &sa, NULL);
+    });
+    prof_bufs.clear();
+    /* Buffers first, then a CPU time timer per thread */
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_nsec = 1000000000L / PROF_HZ;
+    its.it_value = its.it_interval;
+    try {
+        for (struct prof_thr *t : prof_threads) {
+            b.reset(new struct prof_buf);
+            memcpy(b->name, t->name, sizeof(b->name));
+            b->n = 0;
+            b->dropped = 0;
+            b->samples.resize(static_cast<size_t>(PROF_HZ) * (seconds + 1));
+            memset(&sev, 0, sizeof(sev));
+            sev.sigev_notify = SIGEV_THREAD_ID;
+            sev.sigev_signo = SIGPROF;
+            sev.sigev_notify_thread_id = t->tid;
+            if ((pthread_getcpuclockid(t->self, &clk) != 0) ||
+                (timer_create(clk, &sev, &t->timer) < 0)) {
+                throw std::system_error(errno, std::generic_category());
+            }
+            t->armed = true;
+            t->buf.store(b.get());
+            prof_bufs.push_back(std::move(b));
+            timer_settime(t->timer, 0, &its, NULL);
+        }
+    } catch (const std::exception& e) {
+        for (struct prof_thr *t : prof_threads) {
+            prof_thr_off(t);
+        }
+        prof_bufs.clear();
+        errno = ENOMEM;
+        return (-1);
+    }
+    prof_running = true;
+    return 0;
+}
+
+int prof_stop(const char *const path, struct prof_result *const res) {
+    /* Variables */
+    std::vector<std::unique_ptr<struct prof_buf>> bufs;
+    std::unordered_map<uintptr_t, std::string> names;
+    std::map<std::string, uint64_t> stacks;
+    struct prof_result sum = {};
+    std::string stack;
+    std::string tmp;
+    /* Quiesce every handler, take the samples */
+    {
+        std::lock_guard<std::mutex> lock(prof_mutex);
+        if (!prof_running) {
+            return (-1);
+        }
+        for (struct prof_thr *t : prof_threads) {
+            prof_thr_off(t);
+        }
+        bufs.swap(prof_bufs);
+        prof_running = false;
+    }
+    if (path == NULL) {
+        return 0;
+    }
+    /* Fold: "thread;outer;...;leaf", symbols resolved once per address */
+    try {
+        std::call_once(prof_syms_once, prof_syms_load);
+        for (const auto &b : bufs) {
+            sum.samples += b->n;
+            sum.dropped += b->dropped;
+            sum.threads += 1;
+            for (size_t i = 0; i < b->n; ++i) {
+                const struct prof_sample &smp = b->samples[i];
+                stack.assign(b->name);
+                for (uint32_t d = smp.depth; d > 0; --d) {
+                    /* Return addresses point past the call */
+                    const uintptr_t pc = smp.pc[d - 1] - ((d > 1) ? 1 : 0);
+                    auto it = names.find(pc);
+                    if (it == names.end()) {
+                        it = names.emplace(pc, prof_symbolize(pc)).first;
+                    }
+                    stack.append(";").append(it->second);
+                }
+                ++stacks[stack];
+            }
+        }
+        sum.stacks = stacks.size();
+        tmp = std::string(path) + ".tmp";
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const auto &[s, count] : stacks) {
+            out << s << " " << count << "\n";
+        }
+        out.close();
+        if (!out || (rename(tmp.c_str(), path) < 0)) {
+            unlink(tmp.c_str());
+            return (-1);
+        }
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    if (res != NULL) {
+        *res = sum;
+    }
+    return 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void prof_handler(int, siginfo_t *, void *ctx) {
+    /* Variables */
+    const int saved = errno;
+    struct prof_thr *t = &prof_self;
+    const ucontext_t *uc = static_cast<const ucontext_t *>(ctx);
+    struct prof_buf *b;
+    struct prof_sample *smp;
+    uintptr_t pc = 0;
+    uintptr_t fp = 0;
+    uintptr_t sp = 0;
+    uintptr_t next;
+    /* Announce, then look (prof_thr_off() clears buf, then waits) */
+    t->busy.store(true);
+    b = t->buf.load();
+    if (b == NULL) {
+        t->busy.store(false);
+        return;
+    }
+    if (b->n >= b->samples.size()) {
+        ++b->dropped;
+        t->busy.store(false);
+        return;
+    }
+#if defined(__x86_64__)
+    pc = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+    sp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RSP]);
+#elif defined(__aarch64__)
+    pc = static_cast<uintptr_t>(uc->uc_mcontext.pc);
+    fp = static_cast<uintptr_t>(uc->uc_mcontext.regs[29]);
+    sp = static_cast<uintptr_t>(uc->uc_mcontext.sp);
+#else
+    (void)uc;
+#endif
+    smp = &b->samples[b->n];
+    smp->depth = 0;
+    smp->pc[smp->depth++] = pc;
+    /* Frame chain: [fp] - caller's fp, [fp + 1] - return address; only
+     * inside the live part of the stack, strictly upwards */
+    while ((smp->depth < PROF_DEPTH) && (fp >= sp) && ((fp & 7) == 0) &&
+           (fp + (2 * sizeof(uintptr_t)) <= t->stack_hi)) {
+        const uintptr_t *frame = reinterpret_cast<const uintptr_t *>(fp);
+        if (frame[1] == 0) {
+            break;
+        }
+        smp->pc[smp->depth++] = frame[1];
+        next = frame[0];
+        if (next <= fp) {
+            break;
+        }
+        fp = next;
+    }
+    ++b->n;
+    t->busy.store(false);
+    errno = saved;
+}
+
+static void prof_thr_off(struct prof_thr *const t) {
+    if (t->armed) {
+        timer_delete(t->timer);
+        t->armed = false;
+    }
+    /* A signal already on its way finds no buffer */
+    t->buf.store(NULL);
+    while (t->busy.load()) {
+        sched_yield();
+    }
+}
+
+static void prof_syms_load() {
+    /* Variables */
+    const ElfW(Ehdr) *eh;
+    const ElfW(Shdr) *sh;
+    uintptr_t base = 0;
+    /* The executable image, its names are used in place */
+    {
+        std::ifstream exe("/proc/self/exe", std::ios::binary);
+        std::ostringstream image;
+        image << exe.rdbuf();
+        prof_elf = image.str();
+    }
+    if ((prof_elf.size() < sizeof(ElfW(Ehdr))) ||
+        (memcmp(prof_elf.data(), ELFMAG, SELFMAG) != 0)) {
+        return;
+    }
+    dl_iterate_phdr(prof_exe_base, &base);
+    eh = reinterpret_cast<const ElfW(Ehdr) *>(prof_elf.data());
+    if ((eh->e_shoff == 0) || (eh->e_shentsize != sizeof(ElfW(Shdr))) ||
+        (eh->e_shoff + (eh->e_shnum * sizeof(ElfW(Shdr))) > prof_elf.size())) {
+        return;
+    }
+    sh = reinterpret_cast<const ElfW(Shdr) *>(prof_elf.data() + eh->e_shoff);
+    /* Function symbols of .symtab (static functions included) */
+    for (unsigned i = 0; i < eh->e_shnum; ++i) {
+        if ((sh[i].sh_type != SHT_SYMTAB) || (sh[i].sh_link >= eh->e_shnum) ||
+            (sh[i].sh_offset + sh[i].sh_size > prof_elf.size())) {
+            continue;
+        }
+        const ElfW(Shdr) *strs = &sh[sh[i].sh_link];
+        const ElfW(Sym) *syms = reinterpret_cast<const ElfW(Sym) *>(
+            prof_elf.data() + sh[i].sh_offset);
+        const size_t n = sh[i].sh_size / sizeof(ElfW(Sym));
+        if (strs->sh_offset + strs->sh_size > prof_elf.size()) {
+            continue;
+        }
+        for (size_t k = 0; k < n; ++k) {
+            if ((ELF64_ST_TYPE(syms[k].st_info) != STT_FUNC) ||
+                (syms[k].st_value == 0) ||
+                (syms[k].st_name >= strs->sh_size)) {
+                continue;
+            }
+            prof_syms.push_back({
+                .addr = base + syms[k].st_value,
+                .size = syms[k].st_size,
+                .name = prof_elf.data() + strs->sh_offset + syms[k].st_name
+            });
+        }
+    }
+    std::sort(prof_syms.begin(), prof_syms.end(),
+              [](const struct prof_sym &a, const struct prof_sym &b) {
+                  return a.addr < b.addr;
+              });
+}
+
+static std::string prof_symbolize(const uintptr_t pc) {
+    /* Variables */
+    const char *name = NULL;
+    Dl_info info;
+    char *plain;
+    char hex[32];
+    std::string result;
+    int status;
+    /* Executable, then shared objects */
+    auto it = std::upper_bound(prof_syms.begin(), prof_syms.end(), pc,
+                               [](const uintptr_t a, const struct prof_sym &s) {
+                                   return a < s.addr;
+                               });
+    if ((it != prof_syms.begin()) &&
+        (pc < (it - 1)->addr + std::max<uintptr_t>((it - 1)->size, 1))) {
+        name = (it - 1)->name;
+    } else if ((dladdr(reinterpret_cast<void *>(pc), &info) != 0) &&
+               (info.dli_sname != NULL)) {
+        name = info.dli_sname;
+    } else if ((dladdr(reinterpret_cast<void *>(pc), &info) != 0) &&
+               (info.dli_fname != NULL)) {
+        snprintf(hex, sizeof(hex), "+0x%zx",
+                 pc - reinterpret_cast<uintptr_t>(info.dli_fbase));
+        result = info.dli_fname;
+        return result.substr(result.rfind('/') + 1) + hex;
+    } else {
+        snprintf(hex, sizeof(hex), "0x%zx", pc);
+        return hex;
+    }
+    plain = abi::__cxa_demangle(name, NULL, NULL, &status);
+    result = (plain != NULL) ? plain : name;
+    free(plain);
+    return result;
+}
+
+static int prof_exe_base(struct dl_phdr_info *info, size_t, void *data) {
+    *static_cast<uintptr_t *>(data) = info->dlpi_addr;
+    return 1;
+}
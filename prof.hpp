@@ -0,0 +1,81 @@
+/**
+ * @file prof.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Built-in sampling CPU profiler: SIGPROF per thread CPU timers,
+ * frame pointer stacks, folded stack output for flame graphs.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef PROF_HPP
+#define PROF_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr unsigned PROF_HZ = 99; /**< Samples per CPU second of a thread */
+constexpr unsigned PROF_DEPTH = 32; /**< Frames kept per sample */
+constexpr unsigned PROF_SECONDS_MAX = 60; /**< Longest profile */
+constexpr const char *PROF_FILE = "telnet_prof-%Y%m%d-%H%M%S.folded"; /**<
+    Profile file in the working directory ("prof", strftime() format) */
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Summary of a finished profile.
+ */
+struct prof_result {
+    uint64_t samples; /**< Samples taken */
+    uint64_t dropped; /**< Samples lost to full buffers */
+    uint64_t stacks; /**< Distinct stacks written */
+    unsigned threads; /**< Profiled threads */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Makes the calling thread profilable (reactor and worker
+ * threads, at start).
+ *
+ * @param name Thread name, the root frame of its stacks.
+ */
+void prof_thread_enter(const char *const name);
+
+/**
+ * @brief Withdraws the calling thread (before it exits), its samples
+ * stay in a running profile.
+ */
+void prof_thread_leave();
+
+/**
+ * @brief Starts sampling every registered thread.
+ *
+ * @param seconds Intended length (sizes the per-thread buffers).
+ * @return int 0 on success, or -1 on failure (errno: EBUSY - a profile
+ * is running).
+ */
+int prof_start(const unsigned seconds);
+
+/**
+ * @brief Stops sampling and writes the folded stacks
+ * ("thread;outer;...;leaf count" lines).
+ *
+ * @param path Output file, NULL - discard the samples.
+ * @param res Receives the summary (may be NULL).
+ * @return int 0 on success, or -1 on failure (no profile running, or
+ * the file cannot be written).
+ */
+int prof_stop(const char *const path, struct prof_result *const res);
+
+#endif /* PROF_HPP */
@@ -0,0 +1,971 @@
+/**
+ * @file rctr.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Event loop (reactor) driving non-blocking sessions.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "rctr.hpp"
+#include "sess.hpp"
+#include "srv.hpp"
+#include "parser.hpp"
+#include "rpc.hpp"
+#include "wrk.hpp"
+#include "prof.hpp"
+#include "proc.hpp"
+
+//==============================================================================
+// Definitions
+//==============================================================================
+/* Module descriptors are registered with a tagged handler pointer,
+ * sessions and the listeners are at least 2-byte aligned */
+static constexpr uintptr_t RCTR_FD_TAG = 1;
+static constexpr std::string_view RCTR_FULL("Error: server is full\r\n");
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Event loop of the reactor thread.
+ *
+ * @param r The reactor.
+ */
+static void rctr_loop(struct rctr *const r);
+
+/**
+ * @brief Creates sessions for the transports handed over by rctr_adopt().
+ *
+ * @param r The reactor.
+ */
+static void rctr_adopt_pending(struct rctr *const r);
+
+/**
+ * @brief Runs the done callbacks of the jobs posted by rctr_post(), oldest
+ * first.
+ *
+ * @param r The reactor.
+ */
+static void rctr_run_posted(struct rctr *const r);
+
+/**
+ * @brief Receives pending input of a session and feeds the parser.
+ *
+ * @param s The session.
+ */
+static void rctr_sess_read(struct sess *const s);
+
+/**
+ * @brief Sends queued output of a session, interactive class first.
+ *
+ * @param s The session.
+ * @param limit Bulk bytes the shaper allows (SIZE_MAX - no limit).
+ * @return int Result of oq_send() (2 - bulk limit reached).
+ */
+static int rctr_sess_send(struct sess *const s, const size_t limit);
+
+/**
+ * @brief Flushes a session with bulk output only after the sessions
+ * with interactive output (at the end of the batch of events).
+ *
+ * @param s The session.
+ */
+static void rctr_sess_defer(struct sess *const s);
+
+/**
+ * @brief Flushes the sessions deferred during the batch of events.
+ *
+ * @param r The reactor.
+ */
+static void rctr_flush_deferred(struct rctr *const r);
+
+/**
+ * @brief Frees the sessions closed during the last batch of events.
+ *
+ * @param r The reactor.
+ */
+static void rctr_reap(struct rctr *const r);
+
+/**
+ * @brief Sampler timer: takes TCP_INFO of the next batch of sessions.
+ *
+ * Every tick samples 1/(RCTR_NET_PERIOD/RCTR_NET_TICK) of the sessions,
+ * so each one is sampled about once a period without a syscall burst.
+ *
+ * @param t The netsmpl timer of a reactor.
+ */
+static void rctr_net_sample(struct tmr *const t);
+
+/**
+ * @brief Idle sweeper timer: hibernates the idle sessions of the next
+ * batch (each session is looked at about once per hibernate_ms).
+ *
+ * @param t The hibsweep timer of a reactor.
+ */
+static void rctr_hib_sweep(struct tmr *const t);
+
+/**
+ * @brief Keepalive timer: probes the quiet TCP text sessions of the next
+ * batch with IAC NOP and closes those that left keepalive_probes probes
+ * unanswered (each session is looked at about once per keepalive_ms).
+ *
+ * A probe is answered by any input or by the TCP ACK of the probe, so
+ * clients need no Telnet support for it and a hibernated session stays
+ * asleep; a peer that is gone acknowledges nothing.
+ *
+ * @param t The alive timer of a reactor.
+ */
+static void rctr_alive_sweep(struct tmr *const t);
+
+/**
+ * @brief Shaper timer: resumes the output of a session (and of the
+ * connection carrying it, for a channel).
+ *
+ * @param t The shaped timer of a session.
+ */
+static void rctr_sess_unshape(struct tmr *const t);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int rctr_init(struct rctr *const r, struct srv *const srv,
+              const unsigned idx) {
+    r->srv = srv;
+    r->idx = idx;
+    r->stop = false;
+    r->confgen = srv->conf.gen.load(std::memory_order_acquire);
+    r->conf = cfg_hold(&srv->conf);
+    mbox_init(&r->mbox);
+    tmr_wheel_init(&r->wheel);
+    r->netsmpl.cb = rctr_net_sample;
+    r->netsmpl.arg = r;
+    r->netcur = r->sessions.end();
+    r->hibsweep.cb = rctr_hib_sweep;
+    r->hibsweep.arg = r;
+    r->hibcur = r->sessions.end();
+    r->alive.cb = rctr_alive_sweep;
+    r->alive.arg = r;
+    r->alivecur = r->sessions.end();
+    r->slots = 0;
+    r->authrun = 0;
+    r->batch = NULL;
+    r->nbatch = 0;
+    tlnt_policy::alloc::init(&r->sessmem, sizeof(struct sess));
+    tlnt_policy::alloc::init(&r->chunks, sizeof(struct oq_chunk));
+    if (r->io.init() < 0) {
+        log_error("Error: reactor backend init");
+        return (-1);
+    }
+    r->wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (r->wakefd < 0) {
+        r->io.fini();
+        return (-1);
+    }
+    if (r->io.add(r->wakefd, IO_IN, &r->wakefd) < 0) {
+        close(r->wakefd);
+        r->io.fini();
+        return (-1);
+    }
+    return 0;
+}
+
+int rctr_start(struct rctr *const r) {
+    try {
+        r->thread = std::thread(rctr_loop, r);
+    } catch (const std::system_error& e) {
+        log_error("Error: reactor thread");
+        return (-1);
+    }
+    return 0;
+}
+
+void rctr_stop(struct rctr *const r) {
+    r->stop = true;
+    rctr_wake(r);
+    if (r->thread.joinable()) {
+        r->thread.join();
+    }
+}
+
+void rctr_fini(struct rctr *const r) {
+    /* Transports that were never adopted */
+    for (struct trns *t : r->incoming) {
+        trns_destroy(t);
+    }
+    r->incoming.clear();
+    for (const int fd : r->spare) {
+        close(fd);
+    }
+    r->spare.clear();
+    close(r->wakefd);
+    r->io.fini();
+    tlnt_policy::alloc::fini(&r->chunks);
+    tlnt_policy::alloc::fini(&r->sessmem);
+}
+
+int rctr_adopt(struct rctr *const r, struct trns *const t) {
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        try {
+            r->incoming.push_back(t);
+        } catch (const std::bad_alloc& e) {
+            return (-1);
+        }
+    }
+    if (mbox_signal(&r->mbox)) {
+        rctr_wake(r);
+    }
+    return 0;
+}
+
+void rctr_post(struct rctr *const r, struct wrk_job *const j) {
+    if (mbox_push(&r->mbox, j)) {
+        rctr_wake(r);
+    }
+}
+
+int rctr_listen(struct rctr *const r, int *const sock) {
+    return r->io.add(*sock, IO_IN, sock);
+}
+
+int rctr_pin(struct rctr *const r, const cpu_set_t *const set) {
+    if (pthread_setaffinity_np(r->thread.native_handle(), sizeof(*set),
+                               set) != 0) {
+        log_error("Error: pin reactor ", r->idx);
+        return (-1);
+    }
+    return 0;
+}
+
+int rctr_reserve(struct rctr *const r, const unsigned slots) {
+    try {
+        r->spare.reserve(slots);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    r->slots = slots;
+    rctr_slot_refill(r);
+    return (r->spare.size() == slots) ? 0 : (-1);
+}
+
+int rctr_prealloc(struct rctr *const r, const size_t sessions,
+                  const size_t chunks) {
+    if ((tlnt_policy::alloc::reserve(&r->sessmem, sessions) < 0) ||
+        (tlnt_policy::alloc::reserve(&r->chunks, chunks) < 0)) {
+        log_error("Error: reactor pools");
+        return (-1);
+    }
+    return 0;
+}
+
+int rctr_slot_take(struct rctr *const r) {
+    if (r->sessions.size() >= r->slots) {
+        return (-1);
+    }
+    /* A lost spare (out of descriptors at refill) is still a free slot */
+    if (!r->spare.empty()) {
+        close(r->spare.back());
+        r->spare.pop_back();
+    }
+    return 0;
+}
+
+void rctr_slot_refill(struct rctr *const r) {
+    /* Variables */
+    const size_t live = r->sessions.size();
+    const size_t want = (live < r->slots) ? (r->slots - live) : 0;
+    int fd;
+    /* One descriptor per free slot (capacity reserved up front) */
+    while (r->spare.size() < want) {
+        fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        r->spare.push_back(fd);
+    }
+}
+
+int rctr_signals(struct rctr *const r, const int fd) {
+    return r->io.add(fd, IO_IN, &r->srv->sigfd);
+}
+
+int rctr_fd_add(struct rctr *const r, const int fd, const uint32_t events,
+                struct rctr_fd *const h) {
+    return r->io.add(fd, events, reinterpret_cast<void *>(
+                         reinterpret_cast<uintptr_t>(h) | RCTR_FD_TAG));
+}
+
+int rctr_fd_mod(struct rctr *const r, const int fd, const uint32_t events,
+                struct rctr_fd *const h) {
+    return r->io.mod(fd, events, reinterpret_cast<void *>(
+                         reinterpret_cast<uintptr_t>(h) | RCTR_FD_TAG));
+}
+
+void rctr_fd_del(struct rctr *const r, const int fd, struct rctr_fd *const h) {
+    /* Variables */
+    void *const ptr = reinterpret_cast<void *>(
+        reinterpret_cast<uintptr_t>(h) | RCTR_FD_TAG);
+    /* Not watched any more, and not dispatched from this batch */
+    r->io.del(fd);
+    for (int i = 0; i < r->nbatch; ++i) {
+        if (r->batch[i].ptr == ptr) {
+            r->batch[i].ptr = NULL;
+        }
+    }
+}
+
+void rctr_wake(struct rctr *const r) {
+    const uint64_t one = 1;
+    if (write(r->wakefd, &one, sizeof(one)) < 0) {
+        /* Already signalled */
+    }
+}
+
+struct sess *rctr_sess_open(struct rctr *const r, struct trns *const t) {
+    /* Variables */
+    struct srv *srv = r->srv;
+    struct sess *s;
+    void *mem;
+    /* Allocate */
+    mem = tlnt_policy::alloc::get(&r->sessmem);
+    if (mem == NULL) {
+        trns_destroy(t);
+        return NULL;
+    }
+    s = new (mem) struct sess;
+    s->id = srv->next_id.fetch_add(1);
+    s->srv = srv;
+    s->rctr = r;
+    s->trns = t;
+    s->events = IO_IN;
+    s->cols = 0;
+    s->rows = 0;
+    s->closing = false;
+    s->hibernated = false;
+    s->active_at = tmr_now_ms();
+    s->probe_at = 0;
+    s->probes = 0;
+    s->mode = SESS_SNIFF;
+    s->refs = 0;
+    s->tcp = (tlnt_peer_name(t->fd, s->peer, sizeof(s->peer)) == 0);
+    if (!s->tcp) {
+        strcpy(s->peer, "-");
+    }
+    s->net = {};
+    s->net_at = 0;
+    s->rate = -1;
+    s->fmt = REC_TEXT;
+    s->shaped.cb = rctr_sess_unshape;
+    s->shaped.arg = s;
+    s->parent = NULL;
+    s->user = NULL;
+    /* Register (virtual transports have no descriptor) */
+    if ((t->fd >= 0) &&
+        ((trns_nonblock(t) < 0) || (r->io.add(t->fd, IO_IN, s) < 0))) {
+        log_error("Error: session register");
+        trns_destroy(t);
+        s->~sess();
+        tlnt_policy::alloc::put(&r->sessmem, mem);
+        return NULL;
+    }
+    try {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        s->it = r->sessions.insert(r->sessions.end(), s);
+    } catch (const std::bad_alloc& e) {
+        if (t->fd >= 0) {
+            r->io.del(t->fd);
+        }
+        trns_destroy(t);
+        s->~sess();
+        tlnt_policy::alloc::put(&r->sessmem, mem);
+        return NULL;
+    }
+    mtrc_add(&r->mtrc, MTRC_ACCEPTED, 1);
+    r->srv->nsess.fetch_add(1, std::memory_order_relaxed);
+    if (s->tcp && !tmr_armed(&r->netsmpl)) {
+        tmr_arm(&r->wheel, &r->netsmpl, RCTR_NET_TICK);
+    }
+    if (s->tcp && !tmr_armed(&r->alive)) {
+        tmr_arm(&r->wheel, &r->alive, RCTR_ALIVE_TICK);
+    }
+    if (!tmr_armed(&r->hibsweep)) {
+        tmr_arm(&r->wheel, &r->hibsweep, RCTR_HIB_TICK);
+    }
+    /* Start */
+    if (srv->cbs.on_connect != NULL) {
+        srv->cbs.on_connect(srv, s, srv->cbs.user);
+    }
+    if (parser_start(s) < 0) {
+        rctr_sess_close(s);
+        return NULL;
+    }
+    if (rctr_sess_flush(s) < 0) {
+        return NULL;
+    }
+    return s;
+}
+
+void rctr_sess_close(struct sess *const s) {
+    /* Variables */
+    struct rctr *r = s->rctr;
+    struct srv *srv = s->srv;
+    /* Close once */
+    if (s->closing) {
+        return;
+    }
+    s->closing = true;
+    if (s->trns->fd >= 0) {
+        r->io.del(s->trns->fd);
+    }
+    tmr_cancel(&r->wheel, &s->shaped);
+    if constexpr (tlnt_policy::feat::mux) {
+        if (s->mux != NULL) {
+            mux_close(s);
+        }
+    }
+    if constexpr (tlnt_policy::feat::pager) {
+        pgr_stop(s);
+    }
+    if constexpr (tlnt_policy::feat::watch) {
+        wtch_stop(s);
+    }
+    if constexpr (tlnt_policy::feat::auth) {
+        auth_stop(s);
+    }
+    if constexpr (tlnt_policy::feat::proc) {
+        proc_stop(s);
+    }
+    if (srv->cbs.on_disconnect != NULL) {
+        srv->cbs.on_disconnect(srv, s, srv->cbs.user);
+    }
+    log_info("Stop Parser Session: ", s->id);
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        if (r->netcur == s->it) {
+            ++r->netcur;
+        }
+        if (r->hibcur == s->it) {
+            ++r->hibcur;
+        }
+        if (r->alivecur == s->it) {
+            ++r->alivecur;
+        }
+        for (struct acct_top &top : r->top) {
+            acct_top_remove(&top, s);
+        }
+        r->sessions.erase(s->it);
+    }
+    trns_destroy(s->trns);
+    if (r->slots > 0) {
+        rctr_slot_refill(r);
+    }
+    oq_clear(&s->oq[OQ_INTERACTIVE], &r->chunks);
+    oq_clear(&s->oq[OQ_BULK], &r->chunks);
+    mtrc_add(&r->mtrc, MTRC_CLOSED, 1);
+    srv->nsess.fetch_sub(1, std::memory_order_relaxed);
+    try {
+        r->dead.push_back(s);
+    } catch (const std::bad_alloc& e) {
+        /* Leak rather than free a session that may still be referenced */
+    }
+}
+
+int rctr_sess_flush(struct sess *const s) {
+    /* Variables */
+    struct rctr *r = s->rctr;
+    const struct cfg *conf = r->conf.get();
+    const size_t before = sess_queued(s);
+    const int64_t own = s->rate.load(std::memory_order_relaxed);
+    const uint64_t rate = (own < 0) ? conf->rate_session : own;
+    size_t limit = SIZE_MAX;
+    size_t sent;
+    uint64_t now = 0;
+    uint64_t delay = 0;
+    uint32_t events;
+    int result;
+    /* Send */
+    if (s->closing) {
+        return (-1);
+    }
+    if ((rate != 0) || (conf->rate_global != 0)) {
+        now = tmr_now_ms();
+        limit = shp_budget(&s->shp, rate, now);
+        if (conf->rate_global != 0) {
+            std::lock_guard<std::mutex> lock(s->srv->shpmutex);
+            limit = std::min(limit, shp_budget(&s->srv->shp,
+                                               conf->rate_global, now));
+        }
+    }
+    result = rctr_sess_send(s, limit);
+    sent = before - sess_queued(s);
+    mtrc_add(&r->mtrc, MTRC_BYTES_OUT, sent);
+    if (sent > 0) {
+        rctr_sess_account(s, 0, sent, 0);
+    }
+    if (result < 0) {
+        rctr_sess_close(s);
+        return (-1);
+    }
+    /* Shaped: pay for the bytes, a timer resumes once tokens are back
+     * (the queue stays, so the input backpressure below bounds it) */
+    if (limit != SIZE_MAX) {
+        shp_take(&s->shp, sent);
+        delay = shp_delay(&s->shp);
+        if (conf->rate_global != 0) {
+            std::lock_guard<std::mutex> lock(s->srv->shpmutex);
+            shp_take(&s->srv->shp, sent);
+            delay = std::max(delay, shp_delay(&s->srv->shp));
+        }
+    }
+    if ((result == 2) && !tmr_armed(&s->shaped)) {
+        tmr_arm(&r->wheel, &s->shaped, delay);
+    }
+    /* Interest: write when blocked, read unless the client lags behind */
+    events = s->events & IO_IN;
+    if (sess_queued(s) > conf->oq_high) {
+        events = 0;
+    } else if (sess_queued(s) <= conf->oq_low) {
+        events = IO_IN;
+        if constexpr (tlnt_policy::feat::proc) {
+            if (s->proc != NULL) {
+                proc_resume(s);
+            }
+        }
+    }
+    if (result == 1) {
+        events |= IO_OUT;
+    }
+    if (s->trns->fd < 0) {
+        s->events = events;
+        if ((s->trns->ops->interest != NULL) &&
+            (s->trns->ops->interest(s->trns, events) < 0)) {
+            rctr_sess_close(s);
+            return (-1);
+        }
+    } else if (events != s->events) {
+        if (r->io.mod(s->trns->fd, events, s) < 0) {
+            rctr_sess_close(s);
+            return (-1);
+        }
+        s->events = events;
+    }
+    return 0;
+}
+
+void rctr_sess_account(struct sess *const s, const uint64_t ticks,
+                       const uint64_t bytes, const uint64_t cmds) {
+    /* Variables */
+    struct rctr *r = s->rctr;
+    const uint64_t now = tmr_now_ms();
+    /* Closed sessions left the top-K sets for good */
+    if (s->closing) {
+        return;
+    }
+    /* Published for "top" running in other reactors */
+    std::lock_guard<std::mutex> lock(r->mutex);
+    acct_add(&s->acct, now, ticks, bytes, cmds);
+    for (size_t k = 0; k < ACCT_KEYS; ++k) {
+        acct_top_offer(&r->top[k], static_cast<enum acct_key>(k), s,
+                       &s->acct, now);
+    }
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void rctr_loop(struct rctr *const r) {
+    /* Variables */
+    struct io_event evs[256];
+    struct sess *s;
+    struct rctr_fd *h;
+    uint64_t cnt;
+    uint64_t gen;
+    int n;
+    /* Event Loop */
+    if constexpr (tlnt_policy::feat::prof) {
+        prof_thread_enter(("rctr" + std::to_string(r->idx)).c_str());
+    }
+    while (!r->stop.load()) {
+        n = r->io.wait(evs, 256, tmr_timeout(&r->wheel));
+        if (n < 0) {
+            log_error("Error: reactor wait");
+            break;
+        }
+        /* A reload since the last iteration - the previous snapshot is
+         * freed once nobody else holds it */
+        gen = r->srv->conf.gen.load(std::memory_order_acquire);
+        if (gen != r->confgen) {
+            r->conf = cfg_hold(&r->srv->conf);
+            r->confgen = gen;
+        }
+        r->batch = evs;
+        r->nbatch = n;
+        for (int i = 0; i < n; ++i) {
+            if (evs[i].ptr == NULL) {
+                continue; /* Handler gone (rctr_fd_del()) */
+            }
+            if ((reinterpret_cast<uintptr_t>(evs[i].ptr) & RCTR_FD_TAG) != 0) {
+                h = reinterpret_cast<struct rctr_fd *>(
+                    reinterpret_cast<uintptr_t>(evs[i].ptr) & ~RCTR_FD_TAG);
+                h->cb(h, evs[i].events);
+                continue;
+            }
+            if (evs[i].ptr == &r->wakefd) {
+                if (read(r->wakefd, &cnt, sizeof(cnt)) < 0) {
+                    cnt = 0;
+                }
+                mbox_arm(&r->mbox);
+                rctr_adopt_pending(r);
+                rctr_run_posted(r);
+                continue;
+            }
+            if (evs[i].ptr == &r->srv->srvsocket) {
+                srv_accept(r->srv);
+                continue;
+            }
+            if (evs[i].ptr == &r->srv->admsocket) {
+                srv_accept_admin(r->srv);
+                continue;
+            }
+            if (evs[i].ptr == &r->srv->sigfd) {
+                srv_signal(r->srv);
+                continue;
+            }
+            s = static_cast<struct sess *>(evs[i].ptr);
+            if (s->closing) {
+                continue;
+            }
+            if (evs[i].events & IO_OUT) {
+                rctr_sess_defer(s);
+            }
+            if (evs[i].events & (IO_IN | IO_ERR)) {
+                rctr_sess_read(s);
+            }
+        }
+        r->nbatch = 0;
+        rctr_flush_deferred(r);
+        tmr_advance(&r->wheel);
+        rctr_reap(r);
+    }
+    /* Close all sessions (workers are drained already) */
+    rctr_run_posted(r);
+    while (!r->sessions.empty()) {
+        rctr_sess_close(r->sessions.front());
+    }
+    rctr_reap(r);
+    if constexpr (tlnt_policy::feat::proc) {
+        proc_reap(r, true);
+    }
+    if constexpr (tlnt_policy::feat::prof) {
+        prof_thread_leave();
+    }
+}
+
+static void rctr_adopt_pending(struct rctr *const r) {
+    /* Variables */
+    std::vector<struct trns *> incoming;
+    /* Take the list */
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        incoming.swap(r->incoming);
+    }
+    /* Clients over the session limit are told and closed (reactors
+     * adopting at once may each let one more in) */
+    for (struct trns *t : incoming) {
+        if (r->srv->nsess.load(std::memory_order_relaxed) >=
+            srv_sessions_max(r->srv)) {
+            trns_nonblock(t);
+            trns_send(t, RCTR_FULL.data(), RCTR_FULL.size());
+            trns_destroy(t);
+            mtrc_add(&r->mtrc, MTRC_REFUSED, 1);
+            continue;
+        }
+        rctr_sess_open(r, t);
+    }
+}
+
+static void rctr_run_posted(struct rctr *const r) {
+    /* Variables */
+    struct mbox_msg *msg;
+    struct wrk_job *j;
+    /* Drain (a message posted meanwhile is taken too, or wakes again) */
+    while ((msg = mbox_pop(&r->mbox)) != NULL) {
+        j = static_cast<struct wrk_job *>(msg);
+        j->done(j);
+    }
+}
+
+static void rctr_sess_read(struct sess *const s) {
+    /* Variables */
+    struct rctr *r = s->rctr;
+    uint64_t start;
+    ssize_t n;
+    int result;
+    /* Receive */
+    n = trns_recv(s->trns, r->rbuf, sizeof(r->rbuf));
+    if (n < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return;
+        }
+        rctr_sess_close(s);
+        return;
+    }
+    if (n == 0) {
+        rctr_sess_close(s);
+        return;
+    }
+    mtrc_add(&r->mtrc, MTRC_BYTES_IN, static_cast<uint64_t>(n));
+    s->active_at = tmr_now_ms();
+    /* Parse and answer (the slice charged to the session: FSM and the
+     * commands run inline, channel work counts for the connection) */
+    start = acct_ticks();
+    switch (s->mode) {
+    case SESS_TEXT:
+        result = parser_feed(s, r->rbuf, static_cast<size_t>(n));
+        break;
+    case SESS_RPC:
+        if constexpr (tlnt_policy::feat::rpc) {
+            result = rpc_feed(s, r->rbuf, static_cast<size_t>(n));
+        } else {
+            result = (-1); /* Not built */
+        }
+        break;
+    case SESS_MUX:
+        if constexpr (tlnt_policy::feat::mux) {
+            result = mux_feed(s, r->rbuf, static_cast<size_t>(n));
+        } else {
+            result = (-1);
+        }
+        break;
+    default:
+        result = sess_sniff(s, r->rbuf, static_cast<size_t>(n));
+        break;
+    }
+    rctr_sess_account(s, acct_ticks() - start, static_cast<uint64_t>(n), 0);
+    if (result < 0) {
+        log_error("Error: parser_fsm");
+    }
+    if (result == 0) {
+        rctr_sess_defer(s);
+    } else if (rctr_sess_flush(s) == 0) {
+        rctr_sess_close(s);
+    }
+}
+
+static int rctr_sess_send(struct sess *const s, const size_t limit) {
+    /* Variables */
+    struct rctr *r = s->rctr;
+    struct oq *iq = &s->oq[OQ_INTERACTIVE];
+    struct oq *bq = &s->oq[OQ_BULK];
+    int result;
+    /* Interactive output does not wait for the shaper (it is paid for),
+     * a started bulk line is finished first: echo must not split an
+     * escape sequence or a character */
+    if (iq->bytes > 0) {
+        if (bq->mid) {
+            result = oq_send(bq, &r->chunks, s->trns, oq_line(bq));
+            if ((result < 0) || (result == 1)) {
+                return result;
+            }
+        }
+        result = oq_send(iq, &r->chunks, s->trns, SIZE_MAX);
+        if (result != 0) {
+            return result;
+        }
+    }
+    return oq_send(bq, &r->chunks, s->trns, limit);
+}
+
+static void rctr_sess_defer(struct sess *const s) {
+    /* Interactive output goes out now */
+    if (s->oq[OQ_INTERACTIVE].bytes > 0) {
+        rctr_sess_flush(s);
+        return;
+    }
+    try {
+        s->rctr->deferred.push_back(s);
+    } catch (const std::bad_alloc& e) {
+        rctr_sess_flush(s);
+    }
+}
+
+static void rctr_flush_deferred(struct rctr *const r) {
+    /* Closed sessions are freed by the reap after this */
+    for (struct sess *s : r->deferred) {
+        if (!s->closing) {
+            rctr_sess_flush(s);
+        }
+    }
+    r->deferred.clear();
+}
+
+static void rctr_reap(struct rctr *const r) {
+    /* Variables */
+    size_t keep = 0;
+    /* Sessions still referenced by worker jobs wait for the next batch */
+    for (struct sess *s : r->dead) {
+        if (s->refs > 0) {
+            r->dead[keep++] = s;
+            continue;
+        }
+        s->~sess();
+        tlnt_policy::alloc::put(&r->sessmem, s);
+    }
+    r->dead.resize(keep);
+    /* Programs of closed sessions */
+    if constexpr (tlnt_policy::feat::proc) {
+        if (!r->orphans.empty()) {
+            proc_reap(r, false);
+        }
+    }
+}
+
+static void rctr_net_sample(struct tmr *const t) {
+    /* Variables */
+    struct rctr *r = static_cast<struct rctr *>(t->arg);
+    const size_t n = r->sessions.size();
+    const uint64_t period = r->conf->net_period;
+    size_t batch = (n * RCTR_NET_TICK / period) + 1;
+    const uint64_t now = tmr_now_ms();
+    struct tlnt_tcp_stat stat;
+    struct sess *s;
+    /* Idle reactor - rearmed by the next TCP session */
+    if (n == 0) {
+        return;
+    }
+    for (batch = (batch < n) ? batch : n; batch > 0; --batch) {
+        if (r->netcur == r->sessions.end()) {
+            r->netcur = r->sessions.begin();
+        }
+        s = *r->netcur++;
+        if (!s->tcp || ((now - s->net_at) < period) ||
+            (tlnt_tcp_stat(s->trns->fd, &stat) < 0)) {
+            continue;
+        }
+        mtrc_observe(&r->mtrc, MTRC_H_RTT, stat.rtt);
+        mtrc_observe(&r->mtrc, MTRC_H_RTTVAR, stat.rttvar);
+        mtrc_observe(&r->mtrc, MTRC_H_RETRANS, stat.retrans - s->net.retrans);
+        mtrc_observe(&r->mtrc, MTRC_H_CWND, stat.cwnd);
+        mtrc_observe(&r->mtrc, MTRC_H_UNACKED, stat.unacked);
+        /* Published for "who" running in other reactors */
+        std::lock_guard<std::mutex> lock(r->mutex);
+        s->net = stat;
+        s->net_at = now;
+    }
+    tmr_arm(&r->wheel, t, RCTR_NET_TICK);
+}
+
+static void rctr_hib_sweep(struct tmr *const t) {
+    /* Variables */
+    struct rctr *r = static_cast<struct rctr *>(t->arg);
+    const size_t n = r->sessions.size();
+    const uint64_t idle = r->conf->hibernate;
+    const uint64_t now = tmr_now_ms();
+    size_t batch;
+    struct sess *s;
+    /* Idle reactor - rearmed by the next session */
+    if (n == 0) {
+        return;
+    }
+    batch = (idle == 0) ? 0 : std::min(n, (n * RCTR_HIB_TICK / idle) + 1);
+    for (; batch > 0; --batch) {
+        if (r->hibcur == r->sessions.end()) {
+            r->hibcur = r->sessions.begin();
+        }
+        s = *r->hibcur++;
+        /* Text sessions (or silent ones) at rest: no pending output,
+         * login, heredoc, pager, watch, program or job */
+        if (s->hibernated || (s->mode > SESS_TEXT) || (s->refs > 0) ||
+            (s->login != NULL) || (s->block != NULL) || (s->pager != NULL) ||
+            (s->watch != NULL) || (s->proc != NULL) ||
+            (sess_queued(s) > 0) ||
+            ((now - s->active_at) < idle)) {
+            continue;
+        }
+        sess_hibernate(s);
+    }
+    tmr_arm(&r->wheel, t, RCTR_HIB_TICK);
+}
+
+static void rctr_alive_sweep(struct tmr *const t) {
+    /* Variables */
+    static constexpr char NOP[] = {
+        static_cast<char>(TLNT_IAC), static_cast<char>(TLNT_NOP)
+    };
+    struct rctr *r = static_cast<struct rctr *>(t->arg);
+    const size_t n = r->sessions.size();
+    const struct cfg *conf = r->conf.get();
+    const uint64_t now = tmr_now_ms();
+    struct tlnt_tcp_stat stat;
+    size_t batch;
+    struct sess *s;
+    /* Idle reactor - rearmed by the next TCP session */
+    if (n == 0) {
+        return;
+    }
+    batch = (conf->keepalive == 0) ? 0 :
+            std::min(n, (n * RCTR_ALIVE_TICK / conf->keepalive) + 1);
+    for (; batch > 0; --batch) {
+        if (r->alivecur == r->sessions.end()) {
+            r->alivecur = r->sessions.begin();
+        }
+        s = *r->alivecur++;
+        /* TCP text connections (binary modes have no room for IAC) */
+        if (!s->tcp || (s->parent != NULL) || (s->mode > SESS_TEXT)) {
+            continue;
+        }
+        /* The last probe: answered by input or an ACK since, or one
+         * more unanswered */
+        if (s->probes > 0) {
+            if ((s->active_at >= s->probe_at) ||
+                ((tlnt_tcp_stat(s->trns->fd, &stat) == 0) &&
+                 ((now - stat.ack_age) >= s->probe_at))) {
+                s->probes = 0;
+            } else if (s->probes >= conf->keepalive_probes) {
+                log_info("Dead peer: session ", s->id, " ", s->peer);
+                mtrc_add(&r->mtrc, MTRC_DEAD, 1);
+                rctr_sess_close(s);
+                continue;
+            }
+        }
+        /* Quiet: another probe (a stuck queue carries none, its bytes
+         * are not acknowledged either) */
+        if ((now - s->active_at) < conf->keepalive) {
+            continue;
+        }
+        if ((sess_queued(s) == 0) &&
+            ((sess_echo(s, NOP, sizeof(NOP)) < 0) ||
+             (rctr_sess_flush(s) < 0))) {
+            rctr_sess_close(s);
+            continue;
+        }
+        s->probe_at = now;
+        ++s->probes;
+    }
+    tmr_arm(&r->wheel, t, RCTR_ALIVE_TICK);
+}
+
+static void rctr_sess_unshape(struct tmr *const t) {
+    /* Variables */
+    struct sess *s = static_cast<struct sess *>(t->arg);
+    /* Channel output lands in the queue of its connection */
+    if ((rctr_sess_flush(s) == 0) && (s->parent != NULL)) {
+        rctr_sess_flush(s->parent);
+    }
+}
@@ -0,0 +1,335 @@
+/**
+ * @file rctr.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Event loop (reactor) driving non-blocking sessions.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef RCTR_HPP
+#define RCTR_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sched.h>
+#include <sys/types.h>
+#include "policy.hpp"
+#include "acct.hpp"
+#include "cfg.hpp"
+#include "mbox.hpp"
+#include "oq.hpp"
+#include "tmr.hpp"
+#include "trns.hpp"
+
+//=============================================================================
+// Definitions
+//=============================================================================
+/* Defaults of oq_high, oq_low, net_period_ms, hibernate_ms, keepalive_ms
+ * and keepalive_probes (cfg.hpp) */
+constexpr size_t RCTR_OQ_HIGH = 256 * 1024; /**< Stop reading above */
+constexpr size_t RCTR_OQ_LOW = 64 * 1024; /**< Resume reading below */
+constexpr uint64_t RCTR_NET_PERIOD = 1000; /**< TCP_INFO sample period, ms */
+constexpr uint64_t RCTR_HIB_IDLE = 10 * 60 * 1000; /**< Idle before
+                                                       hibernation, ms */
+constexpr uint64_t RCTR_NET_TICK = 100; /**< Sampler batch period, ms */
+constexpr uint64_t RCTR_HIB_TICK = 1000; /**< Idle sweep batch period, ms */
+constexpr uint64_t RCTR_ALIVE_IDLE = 60 * 1000; /**< Quiet time before a
+                                                     keepalive probe, ms */
+constexpr unsigned RCTR_ALIVE_PROBES = 3; /**< Unanswered probes before
+                                               the close */
+constexpr uint64_t RCTR_ALIVE_TICK = 1000; /**< Probe batch period, ms */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct sess;
+struct wrk_job;
+
+/**
+ * @brief A descriptor of a module watched by a reactor (program pipes).
+ *
+ * Registered with rctr_fd_add(), its readiness is passed to cb on the
+ * reactor thread.
+ */
+struct rctr_fd {
+    void (*cb)(struct rctr_fd *const h, const uint32_t events); /**< IO_*
+                                                                     ready */
+    void *arg; /**< Free for the owner */
+};
+
+/**
+ * @brief Reactor: one thread, one readiness backend, many sessions.
+ *
+ * A session belongs to exactly one reactor for its whole life, its memory
+ * (session object and output chunks) comes from the reactor allocators
+ * and is touched by the reactor thread only.
+ */
+struct rctr {
+    struct srv *srv; /**< Owning server */
+    unsigned idx; /**< Index in srv->rctrs */
+    std::thread thread; /**< Event loop thread */
+    tlnt_policy::io io; /**< Readiness backend */
+    int wakefd; /**< eventfd to interrupt the wait */
+    std::atomic<bool> stop; /**< Leave the event loop */
+    std::shared_ptr<const struct cfg> conf; /**< Snapshot pinned for the
+                                                 loop iteration */
+    uint64_t confgen; /**< cfg_store::gen of conf */
+    std::mutex mutex; /**< Protects incoming, sessions and top */
+    std::vector<struct trns *> incoming; /**< Transports to adopt */
+    struct mbox mbox; /**< Worker completions and session operations
+                           from other threads (wrk_job) */
+    std::list<struct sess *> sessions; /**< Live sessions */
+    std::vector<struct sess *> dead; /**< Closed, freed after the batch
+                                          (once no worker job refers) */
+    std::vector<struct sess *> deferred; /**< Flushed at the end of the
+                                              batch (bulk output only) */
+    tlnt_policy::alloc::arena sessmem; /**< Session objects */
+    oq_arena chunks; /**< Output chunks */
+    tlnt_policy::mtrc::counters mtrc; /**< Reactor metrics */
+    struct tmr_wheel wheel; /**< Timers of the reactor thread */
+    struct tmr netsmpl; /**< TCP_INFO sampler (armed while TCP sessions) */
+    std::list<struct sess *>::iterator netcur; /**< Next session to sample */
+    struct tmr hibsweep; /**< Idle sweeper (armed while sessions) */
+    std::list<struct sess *>::iterator hibcur; /**< Next session to sweep */
+    struct tmr alive; /**< Keepalive prober (armed while TCP sessions) */
+    std::list<struct sess *>::iterator alivecur; /**< Next session to
+                                                      probe */
+    struct acct_top top[ACCT_KEYS]; /**< Busiest sessions, per key */
+    unsigned slots; /**< Reserved session slots, 0 - no reservation */
+    std::vector<int> spare; /**< Descriptors held for the free slots */
+    std::list<struct sess *> authq; /**< Logins waiting for a hash slot */
+    unsigned authrun; /**< Logins hashed on the workers */
+    std::vector<pid_t> orphans; /**< Killed programs not reaped yet */
+    struct io_event *batch; /**< Events being dispatched */
+    int nbatch; /**< Number of them */
+    char rbuf[4096]; /**< Receive buffer shared by the sessions */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Initializes a reactor (no thread yet).
+ *
+ * @param r The reactor.
+ * @param srv Owning server.
+ * @param idx Index of the reactor.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_init(struct rctr *const r, struct srv *const srv,
+              const unsigned idx);
+
+/**
+ * @brief Starts the reactor thread.
+ *
+ * @param r The reactor.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_start(struct rctr *const r);
+
+/**
+ * @brief Stops the reactor thread, closing all of its sessions.
+ *
+ * @param r The reactor.
+ */
+void rctr_stop(struct rctr *const r);
+
+/**
+ * @brief Releases reactor resources (stopped reactor).
+ *
+ * @param r The reactor.
+ */
+void rctr_fini(struct rctr *const r);
+
+/**
+ * @brief Hands a connected transport over to the reactor (any thread).
+ *
+ * The session is created by the reactor thread on its next iteration.
+ *
+ * @param r The reactor.
+ * @param t Transport, owned by the reactor on success.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_adopt(struct rctr *const r, struct trns *const t);
+
+/**
+ * @brief Posts a message to the reactor mailbox (any thread): a finished
+ * worker job, or an operation on one of its sessions (a job without run);
+ * its done callback runs on the reactor thread, in posting order.
+ *
+ * Lock free; the reactor is woken by the first post after it drained its
+ * mailbox only.
+ *
+ * @param r The reactor.
+ * @param j The job.
+ */
+void rctr_post(struct rctr *const r, struct wrk_job *const j);
+
+/**
+ * @brief Watches a listening socket from the reactor (before start).
+ *
+ * Clients of srv->srvsocket are passed to srv_accept(), those of
+ * srv->admsocket to srv_accept_admin().
+ *
+ * @param r The reactor.
+ * @param sock srv->srvsocket or srv->admsocket (non-blocking).
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_listen(struct rctr *const r, int *const sock);
+
+/**
+ * @brief Pins the reactor thread to a set of CPUs (started reactor).
+ *
+ * @param r The reactor.
+ * @param set CPUs.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_pin(struct rctr *const r, const cpu_set_t *const set);
+
+/**
+ * @brief Reserves session slots: a descriptor is held for every free
+ * slot, so clients of the reactor get in when the process is out of
+ * descriptors (before start).
+ *
+ * @param r The reactor.
+ * @param slots Number of slots.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_reserve(struct rctr *const r, const unsigned slots);
+
+/**
+ * @brief Carves session objects and output chunks up front (plan.hpp),
+ * before start.
+ *
+ * @param r The reactor.
+ * @param sessions Session objects.
+ * @param chunks Output chunks.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int rctr_prealloc(struct rctr *const r, const size_t sessions,
+                  const size_t chunks);
+
+/**
+ * @brief Frees the descriptor of a reserved slot for a client about to
+ * be accepted (reactor thread only).
+ *
+ * @param r The reactor (with reserved slots).
+ * @return int 0 on success, or -1 if all slots are in use.
+ */
+int rctr_slot_take(struct rctr *const r);
+
+/**
+ * @brief Holds descriptors again for the free slots (reactor thread
+ * only, done on every session close).
+ *
+ * @param r The reactor.
+ */
+void rctr_slot_refill(struct rctr *const r);
+
+/**
+ * @brief Watches the server signalfd from the reactor (before start).
+ *
+ * Pending signals are passed to srv_signal().
+ *
+ * @param r The reactor.
+ * @param fd Non-blocking signalfd.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_signals(struct rctr *const r, const int fd);
+
+/**
+ * @brief Watches a descriptor of a module (reactor thread only).
+ *
+ * @param r The reactor.
+ * @param fd The descriptor (non-blocking).
+ * @param events IO_* interest.
+ * @param h Handler, stays valid until rctr_fd_del().
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_fd_add(struct rctr *const r, const int fd, const uint32_t events,
+                struct rctr_fd *const h);
+
+/**
+ * @brief Changes the interest in a descriptor of rctr_fd_add().
+ *
+ * @param r The reactor.
+ * @param fd The descriptor.
+ * @param events IO_* interest.
+ * @param h Its handler.
+ * @return int 0 on success, or -1 on failure.
+ */
+int rctr_fd_mod(struct rctr *const r, const int fd, const uint32_t events,
+                struct rctr_fd *const h);
+
+/**
+ * @brief Stops watching a descriptor of rctr_fd_add() (before close).
+ *
+ * Its events still in the current batch are dropped, so the handler
+ * may be freed right after.
+ *
+ * @param r The reactor.
+ * @param fd The descriptor.
+ * @param h Its handler.
+ */
+void rctr_fd_del(struct rctr *const r, const int fd, struct rctr_fd *const h);
+
+/**
+ * @brief Wakes the reactor thread up.
+ *
+ * @param r The reactor.
+ */
+void rctr_wake(struct rctr *const r);
+
+/**
+ * @brief Creates and starts a session (reactor thread only).
+ *
+ * Transports with a descriptor are registered with the readiness
+ * backend, virtual ones (fd < 0) are driven by their owner.
+ *
+ * @param r The reactor.
+ * @param t Transport of the client (destroyed on failure).
+ * @return struct sess* The session, or NULL on failure.
+ */
+struct sess *rctr_sess_open(struct rctr *const r, struct trns *const t);
+
+/**
+ * @brief Closes a session of this reactor (reactor thread only).
+ *
+ * @param s The session.
+ */
+void rctr_sess_close(struct sess *const s);
+
+/**
+ * @brief Sends queued output of a session and updates its interest set
+ * (write interest, input backpressure). Reactor thread only.
+ *
+ * @param s The session.
+ * @return int 0 on success, or -1 if the session was closed.
+ */
+int rctr_sess_flush(struct sess *const s);
+
+/**
+ * @brief Charges a session with processing time, traffic and commands
+ * and offers it to the top-K sets of its reactor. Reactor thread only.
+ *
+ * @param s The session.
+ * @param ticks acct_ticks() spent on the session.
+ * @param bytes Bytes received or sent.
+ * @param cmds Commands executed.
+ */
+void rctr_sess_account(struct sess *const s, const uint64_t ticks,
+                       const uint64_t bytes, const uint64_t cmds);
+
+#endif /* RCTR_HPP */
@@ -0,0 +1,335 @@
+/**
+ * @file rec.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Typed record writer of command output: the same calls render
+ * aligned text for people or JSON lines for scripts ("format").
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <bit>
+#include <charconv>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "rec.hpp"
+#include "cmd.hpp"
+#include "sess.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Starts a field: the separator and the key (JSON), or the
+ * separator, the key of a pair and the padding of a right aligned value
+ * (text).
+ *
+ * @param r The writer.
+ * @param key Field name.
+ * @param len Length of the text value that follows (text only).
+ * @param width Text width.
+ */
+static void rec_field(struct rec *const r, const std::string_view key,
+                      const size_t len, const int width);
+
+/**
+ * @brief Ends a field: the padding of a left aligned text value.
+ */
+static void rec_pad(struct rec *const r, const size_t len, const int width);
+
+/**
+ * @brief Adds a field whose text and JSON forms are the same (numbers,
+ * literals).
+ */
+static void rec_raw(struct rec *const r, const std::string_view key,
+                    const std::string_view text, const std::string_view json,
+                    const int width);
+
+/**
+ * @brief Length of the valid UTF-8 sequence at data[pos].
+ *
+ * @return size_t 2..4, or 0 if the bytes are not one.
+ */
+static size_t rec_utf8(const char *const data, const size_t pos,
+                       const size_t len);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+void rec_init(struct rec *const r, std::string *const out,
+              const enum rec_fmt fmt) {
+    r->out = out;
+    r->fmt = fmt;
+    r->fields = 0;
+}
+
+void rec_call(struct rec *const r, const struct cmd_call *const call) {
+    rec_init(r, call->out,
+             (call->sess != NULL) ?
+             call->sess->fmt.load(std::memory_order_relaxed) : REC_TEXT);
+}
+
+void rec_begin(struct rec *const r, const std::string_view type) {
+    r->fields = 0;
+    if (r->fmt == REC_JSON) {
+        r->out->append("{\"type\":");
+        rec_json_str(r->out, type);
+    }
+}
+
+void rec_str(struct rec *const r, const std::string_view key,
+             const std::string_view val, const int width) {
+    rec_field(r, key, val.size(), width);
+    if (r->fmt == REC_JSON) {
+        rec_json_str(r->out, val);
+        return;
+    }
+    r->out->append(val);
+    rec_pad(r, val.size(), width);
+}
+
+void rec_u64(struct rec *const r, const std::string_view key,
+             const uint64_t val, const int width) {
+    /* Variables */
+    char num[24];
+    const std::to_chars_result res = std::to_chars(num, num + sizeof(num),
+                                                   val);
+    const std::string_view text(num, static_cast<size_t>(res.ptr - num));
+    /* The same digits in both */
+    rec_raw(r, key, text, text, width);
+}
+
+void rec_i64(struct rec *const r, const std::string_view key,
+             const int64_t val, const int width) {
+    /* Variables */
+    char num[24];
+    const std::to_chars_result res = std::to_chars(num, num + sizeof(num),
+                                                   val);
+    const std::string_view text(num, static_cast<size_t>(res.ptr - num));
+    /* The same digits in both */
+    rec_raw(r, key, text, text, width);
+}
+
+void rec_bool(struct rec *const r, const std::string_view key,
+              const bool val, const int width) {
+    rec_raw(r, key, val ? "yes" : "no", val ? "true" : "false", width);
+}
+
+void rec_flag(struct rec *const r, const std::string_view key,
+              const bool val) {
+    if (r->fmt == REC_JSON) {
+        rec_bool(r, key, val, 0);
+    } else if (val) {
+        rec_label(r, key);
+    }
+}
+
+void rec_null(struct rec *const r, const std::string_view key,
+              const int width) {
+    rec_raw(r, key, "-", "null", width);
+}
+
+void rec_label(struct rec *const r, const std::string_view text) {
+    if (r->fmt == REC_TEXT) {
+        if (r->fields++ > 0) {
+            r->out->push_back(' ');
+        }
+        r->out->append(text);
+    }
+}
+
+void rec_break(struct rec *const r) {
+    if (r->fmt == REC_TEXT) {
+        r->out->append("\r\n");
+        r->fields = 0;
+    }
+}
+
+void rec_end(struct rec *const r) {
+    r->out->append((r->fmt == REC_JSON) ? "}\r\n" : "\r\n");
+    r->fields = 0;
+}
+
+void rec_head(struct rec *const r, const std::string_view text) {
+    if (r->fmt == REC_TEXT) {
+        r->out->append(text).append("\r\n");
+    }
+}
+
+void rec_line(struct rec *const r, const std::string_view type,
+              const std::string_view text) {
+    if (r->fmt == REC_TEXT) {
+        r->out->append(text).append("\r\n");
+        return;
+    }
+    rec_begin(r, type);
+    rec_str(r, "text", text, 0);
+    rec_end(r);
+}
+
+size_t rec_scan(const char *const data, size_t from, const size_t len) {
+#ifdef __SSE2__
+    /* Variables */
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(' ');
+    __m128i v;
+    __m128i m;
+    unsigned bits;
+    /* 16 bytes per compare; a signed "< ' '" also takes 0x80..0xFF */
+    for (; (from + 16) <= len; from += 16) {
+        v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + from));
+        m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                      _mm_cmpeq_epi8(v, bslash)),
+                         _mm_cmplt_epi8(v, space));
+        bits = static_cast<unsigned>(_mm_movemask_epi8(m));
+        if (bits != 0) {
+            return from + std::countr_zero(bits);
+        }
+    }
+#endif
+    /* Tail (or everything without SSE2) */
+    for (; from < len; ++from) {
+        const unsigned char c = static_cast<unsigned char>(data[from]);
+        if ((c < 0x20) || (c >= 0x80) || (c == '"') || (c == '\\')) {
+            return from;
+        }
+    }
+    return len;
+}
+
+void rec_json_str(std::string *const out, const std::string_view val) {
+    /* Variables */
+    static const char hex[] = "0123456789abcdef";
+    const char *data = val.data();
+    const size_t len = val.size();
+    size_t run = 0; /**< Start of the bytes not appended yet */
+    size_t pos = 0;
+    size_t n;
+    unsigned char c;
+    /* Scan, append unchanged runs, escape the hits */
+    out->push_back('"');
+    while ((pos = rec_scan(data, pos, len)) < len) {
+        c = static_cast<unsigned char>(data[pos]);
+        if (c >= 0x80) {
+            n = rec_utf8(data, pos, len);
+            if (n > 0) {
+                pos += n; /* Valid UTF-8 stays in the run */
+                continue;
+            }
+        }
+        out->append(data + run, pos - run);
+        switch (c) {
+        case '"':
+            out->append("\\\"");
+            break;
+        case '\\':
+            out->append("\\\\");
+            break;
+        case '\n':
+            out->append("\\n");
+            break;
+        case '\r':
+            out->append("\\r");
+            break;
+        case '\t':
+            out->append("\\t");
+            break;
+        default:
+            if (c >= 0x80) {
+                out->append("\\ufffd");
+            } else {
+                const char u[] = {'\\', 'u', '0', '0', hex[c >> 4],
+                                  hex[c & 0xf]};
+                out->append(u, sizeof(u));
+            }
+            break;
+        }
+        run = ++pos;
+    }
+    out->append(data + run, len - run);
+    out->push_back('"');
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void rec_field(struct rec *const r, const std::string_view key,
+                      const size_t len, const int width) {
+    /* JSON: ,"key": */
+    if (r->fmt == REC_JSON) {
+        r->out->push_back(',');
+        rec_json_str(r->out, key);
+        r->out->push_back(':');
+        return;
+    }
+    /* Text: separator, then the key or the padding */
+    if (r->fields++ > 0) {
+        r->out->push_back(' ');
+    }
+    if ((width == REC_PAIR) || (width == REC_ASSIGN)) {
+        r->out->append(key).push_back((width == REC_PAIR) ? ' ' : '=');
+    } else if ((width > 0) && (len < static_cast<size_t>(width))) {
+        r->out->append(static_cast<size_t>(width) - len, ' ');
+    }
+}
+
+static void rec_pad(struct rec *const r, const size_t len, const int width) {
+    if ((width < 0) && (width > REC_ASSIGN) &&
+        (len < static_cast<size_t>(-width))) {
+        r->out->append(static_cast<size_t>(-width) - len, ' ');
+    }
+}
+
+static void rec_raw(struct rec *const r, const std::string_view key,
+                    const std::string_view text, const std::string_view json,
+                    const int width) {
+    /* Variables */
+    const std::string_view val = (r->fmt == REC_JSON) ? json : text;
+    /* Field */
+    rec_field(r, key, val.size(), width);
+    r->out->append(val);
+    if (r->fmt == REC_TEXT) {
+        rec_pad(r, val.size(), width);
+    }
+}
+
+static size_t rec_utf8(const char *const data, const size_t pos,
+                       const size_t len) {
+    /* Variables */
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data) +
+                             pos;
+    unsigned char lo = 0x80; /**< Range of the second byte */
+    unsigned char hi = 0xbf;
+    size_t n;
+    /* Lead byte: no overlongs, surrogates or code points over U+10FFFF */
+    if ((p[0] >= 0xc2) && (p[0] <= 0xdf)) {
+        n = 2;
+    } else if ((p[0] >= 0xe0) && (p[0] <= 0xef)) {
+        n = 3;
+        lo = (p[0] == 0xe0) ? 0xa0 : lo;
+        hi = (p[0] == 0xed) ? 0x9f : hi;
+    } else if ((p[0] >= 0xf0) && (p[0] <= 0xf4)) {
+        n = 4;
+        lo = (p[0] == 0xf0) ? 0x90 : lo;
+        hi = (p[0] == 0xf4) ? 0x8f : hi;
+    } else {
+        return 0;
+    }
+    if (((pos + n) > len) || (p[1] < lo) || (p[1] > hi)) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; ++i) {
+        if ((p[i] < 0x80) || (p[i] > 0xbf)) {
+            return 0;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file rec.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Typed record writer of command output: the same calls render
+ * aligned text for people or JSON lines for scripts ("format").
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef REC_HPP
+#define REC_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr int REC_PAIR = INT_MIN; /**< Field width: "key value" in text */
+constexpr int REC_ASSIGN = INT_MIN + 1; /**< Field width: "key=value" in
+                                             text */
+
+/**
+ * @brief Output format of a session.
+ */
+enum rec_fmt {
+    REC_TEXT, /**< Fields by width, space separated, a line per record */
+    REC_JSON /**< A JSON object per record, {"type":...} first */
+};
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct cmd_call;
+
+/**
+ * @brief Record writer over a command output.
+ *
+ * Fields are rendered as they come, straight into the output (no
+ * record object in between); in text, width is a printf() field width
+ * (negative - left aligned, 0 - as it is) or REC_PAIR/REC_ASSIGN.
+ */
+struct rec {
+    std::string *out; /**< Output (cmd_call::out) */
+    enum rec_fmt fmt; /**< Rendering */
+    unsigned fields; /**< Fields (and labels) of the open record so far */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Starts a writer over an output.
+ *
+ * @param r The writer.
+ * @param out Output.
+ * @param fmt Rendering.
+ */
+void rec_init(struct rec *const r, std::string *const out,
+              const enum rec_fmt fmt);
+
+/**
+ * @brief Starts a writer over the output of a command, in the format of
+ * the calling session (text without one).
+ *
+ * @param r The writer.
+ * @param call Call context.
+ */
+void rec_call(struct rec *const r, const struct cmd_call *const call);
+
+/**
+ * @brief Opens a record.
+ *
+ * @param r The writer.
+ * @param type Record type (JSON "type", not shown in text).
+ */
+void rec_begin(struct rec *const r, const std::string_view type);
+
+/**
+ * @brief Adds a string field.
+ *
+ * @param r The writer.
+ * @param key Field name (JSON key, text with REC_PAIR/REC_ASSIGN).
+ * @param val Value (escaped in JSON, invalid UTF-8 as U+FFFD).
+ * @param width Text width.
+ */
+void rec_str(struct rec *const r, const std::string_view key,
+             const std::string_view val, const int width);
+
+/**
+ * @brief Adds an unsigned number field.
+ */
+void rec_u64(struct rec *const r, const std::string_view key,
+             const uint64_t val, const int width);
+
+/**
+ * @brief Adds a signed number field.
+ */
+void rec_i64(struct rec *const r, const std::string_view key,
+             const int64_t val, const int width);
+
+/**
+ * @brief Adds a boolean field (text "yes"/"no").
+ */
+void rec_bool(struct rec *const r, const std::string_view key,
+              const bool val, const int width);
+
+/**
+ * @brief Adds a flag: JSON boolean, in text the key if it is set (and
+ * nothing if not).
+ */
+void rec_flag(struct rec *const r, const std::string_view key,
+              const bool val);
+
+/**
+ * @brief Adds a field without a value (JSON null, text "-").
+ */
+void rec_null(struct rec *const r, const std::string_view key,
+              const int width);
+
+/**
+ * @brief Adds text shown between the fields of a text record only
+ * (e.g. "Sessions:").
+ */
+void rec_label(struct rec *const r, const std::string_view text);
+
+/**
+ * @brief Breaks a long text record into lines (no-op in JSON).
+ */
+void rec_break(struct rec *const r);
+
+/**
+ * @brief Closes a record ("\r\n" ends it in both formats).
+ */
+void rec_end(struct rec *const r);
+
+/**
+ * @brief Adds a line of text output only (table header, blank line).
+ *
+ * @param r The writer.
+ * @param text The line, without the line end.
+ */
+void rec_head(struct rec *const r, const std::string_view text);
+
+/**
+ * @brief Adds a message: the text line, or {"type":type,"text":text}.
+ *
+ * @param r The writer.
+ * @param type Record type ("error", "info").
+ * @param text The message, without the line end.
+ */
+void rec_line(struct rec *const r, const std::string_view type,
+              const std::string_view text);
+
+/**
+ * @brief Finds the first byte a JSON string may not carry as it is:
+ * '"', '\\', a control character or a non-ASCII byte.
+ *
+ * @param data Bytes.
+ * @param from Start offset.
+ * @param len Number of bytes.
+ * @return size_t Offset of the byte, or len if there is none.
+ */
+size_t rec_scan(const char *const data, size_t from, const size_t len);
+
+/**
+ * @brief Appends a JSON string (quoted and escaped): runs that need no
+ * escape are appended as they are.
+ *
+ * @param out Output.
+ * @param val The string.
+ */
+void rec_json_str(std::string *const out, const std::string_view val);
+
+#endif /* REC_HPP */
@@ -0,0 +1,225 @@
+/**
+ * @file rpc.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Binary framed RPC mode (pipelined, tagged requests).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cstring>
+#include <new>
+#include <string>
+#include <arpa/inet.h>
+#include "rpc.hpp"
+#include "sess.hpp"
+#include "srv.hpp"
+#include "rctr.hpp"
+#include "wrk.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief A request executed on the worker pool.
+ */
+struct rpc_job : public wrk_job {
+    struct sess *sess; /**< Requesting session (referenced) */
+    uint32_t id; /**< Request identifier, echoed in the response */
+    std::string line; /**< Command line */
+    std::string out; /**< Command output */
+    uint64_t ticks; /**< Execution time on the worker, acct_ticks() */
+    int result; /**< Handler result */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Queues one request on the worker pool.
+ *
+ * @param s The session.
+ * @param id Request identifier.
+ * @param line Command line.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+static int rpc_submit(struct sess *const s, const uint32_t id,
+                      const std::string_view line);
+
+/**
+ * @brief Executes a request (worker thread).
+ *
+ * @param job The rpc_job.
+ */
+static void rpc_run(struct wrk_job *const job);
+
+/**
+ * @brief Sends the response of an executed request (reactor thread).
+ *
+ * @param job The rpc_job, freed here.
+ */
+static void rpc_done(struct wrk_job *const job);
+
+/**
+ * @brief Queues a response frame.
+ *
+ * @param s The session.
+ * @param id Request identifier.
+ * @param status Handler result.
+ * @param out Output of the command.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+static int rpc_reply(struct sess *const s, const uint32_t id,
+                     const int32_t status, const std::string_view out);
+
+/**
+ * @brief Reads a big endian 32-bit value.
+ */
+static uint32_t rpc_get32(const char *const p);
+
+/**
+ * @brief Writes a big endian 32-bit value.
+ */
+static void rpc_put32(char *const p, const uint32_t v);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int rpc_feed(struct sess *const s, const char *data, const size_t len) {
+    /* Variables */
+    size_t pos = 0;
+    uint32_t size;
+    /* Frames */
+    try {
+        s->buf.append(data, len);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    while ((s->buf.size() - pos) >= RPC_REQ_HDR) {
+        size = rpc_get32(s->buf.data() + pos);
+        if (size > RPC_FRAME_MAX) {
+            log_error("Error: RPC frame of ", size, " bytes");
+            return 1;
+        }
+        if ((s->buf.size() - pos - RPC_REQ_HDR) < size) {
+            break;
+        }
+        if (rpc_submit(s, rpc_get32(s->buf.data() + pos + 4),
+                       std::string_view(s->buf).substr(pos + RPC_REQ_HDR,
+                                                       size)) < 0) {
+            return (-1);
+        }
+        pos += RPC_REQ_HDR + size;
+    }
+    s->buf.erase(0, pos);
+    return 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int rpc_submit(struct sess *const s, const uint32_t id,
+                      const std::string_view line) {
+    /* Variables */
+    struct rpc_job *j;
+    /* Assertion */
+    if (s->refs >= s->rctr->conf->rpc_inflight) {
+        return rpc_reply(s, id, (-1), "Error: too many requests\r\n");
+    }
+    /* Job */
+    j = new (std::nothrow) struct rpc_job;
+    if (j == NULL) {
+        return (-1);
+    }
+    try {
+        j->line.assign(line);
+    } catch (const std::bad_alloc& e) {
+        delete j;
+        return (-1);
+    }
+    j->run = rpc_run;
+    j->done = rpc_done;
+    j->rctr = s->rctr;
+    j->sess = s;
+    j->id = id;
+    j->ticks = 0;
+    j->result = 0;
+    /* The session stays allocated until rpc_done() */
+    ++s->refs;
+    if (wrk_submit(&s->srv->workers, j) < 0) {
+        --s->refs;
+        delete j;
+        return rpc_reply(s, id, (-1), "Error: server is stopping\r\n");
+    }
+    return 0;
+}
+
+static void rpc_run(struct wrk_job *const job) {
+    /* Variables */
+    struct rpc_job *j = static_cast<struct rpc_job *>(job);
+    struct cmd_call call = {
+        .srv = j->sess->srv,
+        .sess = j->sess,
+        .argv = {},
+        .out = &j->out,
+        .src = NULL,
+        .user = NULL
+    };
+    const uint64_t start = acct_ticks();
+    /* Execute */
+    try {
+        cmd_split(j->line, &call.argv);
+        j->result = srv_exec_call(call.srv, &call, j->line);
+    } catch (const std::bad_alloc& e) {
+        j->result = (-1);
+    }
+    j->ticks = acct_ticks() - start;
+}
+
+static void rpc_done(struct wrk_job *const job) {
+    /* Variables */
+    struct rpc_job *j = static_cast<struct rpc_job *>(job);
+    struct sess *s = j->sess;
+    /* Respond unless the client is gone */
+    --s->refs;
+    rctr_sess_account(s, j->ticks, 0, 1);
+    if (!s->closing) {
+        if (rpc_reply(s, j->id, j->result, j->out) < 0) {
+            rctr_sess_close(s);
+        } else if ((rctr_sess_flush(s) == 0) && (j->result > 0)) {
+            rctr_sess_close(s);
+        }
+    }
+    delete j;
+}
+
+static int rpc_reply(struct sess *const s, const uint32_t id,
+                     const int32_t status, const std::string_view out) {
+    /* Variables */
+    char hdr[RPC_RSP_HDR];
+    /* Frame */
+    rpc_put32(hdr, static_cast<uint32_t>(out.size()));
+    rpc_put32(hdr + 4, id);
+    rpc_put32(hdr + 8, static_cast<uint32_t>(status));
+    if (sess_write(s, hdr, sizeof(hdr)) < 0) {
+        return (-1);
+    }
+    return sess_write(s, out);
+}
+
+static uint32_t rpc_get32(const char *const p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return ntohl(v);
+}
+
+static void rpc_put32(char *const p, const uint32_t v) {
+    const uint32_t n = htonl(v);
+    memcpy(p, &n, sizeof(n));
+}
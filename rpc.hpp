@@ -0,0 +1,61 @@
+/**
+ * @file rpc.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Binary framed RPC mode (pipelined, tagged requests).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ * A client switches its session to RPC mode by sending RPC_MAGIC as the
+ * very first bytes; the server answers with RPC_MAGIC (after the prompt
+ * already sent) and then speaks frames only. All integers are big endian.
+ *
+ *   request:  u32 length | u32 id | length bytes of a command line
+ *   response: u32 length | u32 id | i32 status | length bytes of output
+ *
+ * Requests run on the worker pool and their responses come back as the
+ * handlers finish, not in the order of the requests.
+ */
+
+#ifndef RPC_HPP
+#define RPC_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr std::string_view RPC_MAGIC("\0TLRPC1\n", 8); /**< Mode switch */
+constexpr size_t RPC_REQ_HDR = 8; /**< length, id */
+constexpr size_t RPC_RSP_HDR = 12; /**< length, id, status */
+constexpr size_t RPC_FRAME_MAX = 64 * 1024; /**< Request payload limit */
+constexpr unsigned RPC_INFLIGHT_MAX = 1024; /**< Requests per session
+                                                 (rpc_inflight default) */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct sess;
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Feeds received bytes of a session in RPC mode, dispatches the
+ * complete frames.
+ *
+ * @param s The session (reactor thread).
+ * @param data Received bytes.
+ * @param len Number of bytes.
+ * @return int 0 on success, <0 on error, >0 to close the session.
+ */
+int rpc_feed(struct sess *const s, const char *data, const size_t len);
+
+#endif /* RPC_HPP */
@@ -0,0 +1,365 @@
+/**
+ * @file scr.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Server-side scripts ("source", "batch") with a compiled cache.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include "scr.hpp"
+#include "srv.hpp"
+#include "sess.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief "source <path>" - runs a script file of script_dir.
+ *
+ * @param call Call context.
+ * @return int Result of the script (see cmd_handler).
+ */
+static int scr_source(struct cmd_call *const call);
+
+/**
+ * @brief "batch <<TAG" - collects the next lines up to TAG and runs them.
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int scr_batch(struct cmd_call *const call);
+
+/**
+ * @brief Resolves a script path inside script_dir.
+ *
+ * @param dir script_dir (empty - scripts are off).
+ * @param name Path relative to dir: neither absolute nor with "..".
+ * @param path Receives the path of the file.
+ * @param out Receives an error message.
+ * @return int 0 on success, or -1 if the name is refused.
+ */
+static int scr_path(const std::string &dir, const std::string_view name,
+                    std::string *const path, std::string *const out);
+
+/**
+ * @brief Compiles script text: drops blank and "#" comment lines and
+ * splits every command into words once.
+ *
+ * @param text Script text.
+ * @return std::shared_ptr<const struct scr> Compiled script
+ * (throws std::bad_alloc).
+ */
+static std::shared_ptr<const struct scr> scr_compile(
+    const std::string_view text);
+
+/**
+ * @brief Returns the compiled script of a file, from the cache if the
+ * file did not change.
+ *
+ * @param cache The cache.
+ * @param path Path of the file.
+ * @param name Script name for error messages.
+ * @param out Receives an error message.
+ * @return std::shared_ptr<const struct scr> Script, or NULL on failure.
+ */
+static std::shared_ptr<const struct scr> scr_load(
+    struct scr_cache *const cache, const std::string &path,
+    const std::string_view name, std::string *const out);
+
+/**
+ * @brief Runs a compiled script, stops at the first failing command.
+ *
+ * @param srv The server.
+ * @param s The calling session.
+ * @param script The script.
+ * @param name Script name for error messages.
+ * @param out Receives the output of all commands.
+ * @return int 0 on success, <0 on the first error, >0 if a command
+ * closes the session.
+ */
+static int scr_run(struct srv *const srv, struct sess *const s,
+                   const struct scr *const script,
+                   const std::string_view name, std::string *const out);
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+static thread_local unsigned scr_depth = 0; /**< Nested scripts (per reactor) */
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int scr_register(struct srv *const srv) {
+    if (srv_cmd_register(srv, "source", scr_source, NULL,
+                         "Run a script file (stops at the first error)") < 0) {
+        return (-1);
+    }
+    if (srv_cmd_register(srv, "batch", scr_batch, NULL,
+                         "Run the next lines up to TAG (batch <<TAG)") < 0) {
+        return (-1);
+    }
+    return 0;
+}
+
+int scr_collect(struct srv *const srv, struct sess *const s,
+                const std::string_view line, std::string *const out) {
+    /* Variables */
+    struct scr_cache *cache = &srv->scripts;
+    std::shared_ptr<const struct scr> script;
+    std::string text;
+    /* Collect */
+    if (line != s->block->tag) {
+        s->block->text.append(line);
+        s->block->text.push_back('\n');
+        if (s->block->text.size() > SCR_SIZE_MAX) {
+            s->block.reset();
+            out->append("Error: batch is too large\r\n");
+            return (-1);
+        }
+        return 0;
+    }
+    text.swap(s->block->text);
+    s->block.reset();
+    /* Compile once per distinct block */
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        auto fblock = cache->blocks.find(text);
+        if (fblock != cache->blocks.end()) {
+            script = fblock->second;
+        }
+    }
+    if (script == NULL) {
+        script = scr_compile(text);
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        if (cache->blocks.size() >= SCR_CACHE_MAX) {
+            cache->blocks.clear();
+        }
+        cache->blocks.emplace(std::move(text), script);
+    }
+    return scr_run(srv, s, script.get(), "batch", out);
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int scr_source(struct cmd_call *const call) {
+    /* Variables */
+    std::shared_ptr<const struct scr> script;
+    std::string path;
+    /* Assertion */
+    if (call->argv.size() != 2) {
+        call->out->append("Usage: source <path>\r\n");
+        return (-1);
+    }
+    if (scr_path(cfg_hold(&call->srv->conf)->script_dir, call->argv[1],
+                 &path, call->out) < 0) {
+        return (-1);
+    }
+    /* Load and run (messages name the file as given) */
+    script = scr_load(&call->srv->scripts, path, call->argv[1], call->out);
+    if (script == NULL) {
+        return (-1);
+    }
+    return scr_run(call->srv, call->sess, script.get(), call->argv[1],
+                   call->out);
+}
+
+static int scr_batch(struct cmd_call *const call) {
+    /* Assertion */
+    if ((call->argv.size() != 2) || (call->argv[1].size() < 3) ||
+        (call->argv[1].substr(0, 2) != "<<")) {
+        call->out->append("Usage: batch <<TAG\r\n");
+        return (-1);
+    }
+    if (call->sess->mode == SESS_RPC) {
+        call->out->append("Error: batch is interactive, use source\r\n");
+        return (-1);
+    }
+    /* The next lines go to scr_collect() */
+    call->sess->block = std::make_unique<struct scr_block>();
+    call->sess->block->tag = std::string(call->argv[1].substr(2));
+    return 0;
+}
+
+static int scr_path(const std::string &dir, const std::string_view name,
+                    std::string *const path, std::string *const out) {
+    /* Variables */
+    size_t pos = 0;
+    size_t end;
+    /* Assertion */
+    if (dir.empty()) {
+        out->append("Error: scripts are off (script_dir)\r\n");
+        return (-1);
+    }
+    if (name.empty() || (name.front() == '/')) {
+        out->append("Error: script paths are relative to script_dir\r\n");
+        return (-1);
+    }
+    /* No ".." component */
+    while (pos <= name.size()) {
+        end = name.find('/', pos);
+        end = (end == std::string_view::npos) ? name.size() : end;
+        if (name.substr(pos, end - pos) == "..") {
+            out->append("Error: script paths may not contain ..\r\n");
+            return (-1);
+        }
+        pos = end + 1;
+    }
+    path->assign(dir).append("/").append(name);
+    return 0;
+}
+
+static std::shared_ptr<const struct scr> scr_compile(
+    const std::string_view text) {
+    /* Variables */
+    auto script = std::make_shared<struct scr>();
+    std::vector<std::string_view> argv;
+    std::string_view line;
+    size_t pos = 0;
+    size_t end;
+    unsigned lineno = 0;
+    /* One step per command line */
+    while (pos < text.size()) {
+        end = text.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        line = text.substr(pos, end - pos);
+        pos = end + 1;
+        ++lineno;
+        while (!line.empty() && ((line.back() == '\r') || (line.back() == ' ') ||
+                                 (line.back() == '\t'))) {
+            line.remove_suffix(1);
+        }
+        while (!line.empty() && ((line.front() == ' ') ||
+                                 (line.front() == '\t'))) {
+            line.remove_prefix(1);
+        }
+        if (line.empty() || (line.front() == '#')) {
+            continue;
+        }
+        struct scr_step &step = script->steps.emplace_back();
+        step.line = std::string(line);
+        step.lineno = lineno;
+        for (char &c : step.line) {
+            c = (c == '\t') ? ' ' : c;
+        }
+        cmd_split(step.line, &argv);
+        for (const std::string_view word : argv) {
+            step.words.emplace_back(word.data() - step.line.data(),
+                                    word.size());
+        }
+    }
+    return script;
+}
+
+static std::shared_ptr<const struct scr> scr_load(
+    struct scr_cache *const cache, const std::string &path,
+    const std::string_view name, std::string *const out) {
+    /* Variables */
+    struct stat st;
+    std::shared_ptr<const struct scr> script;
+    std::ostringstream text;
+    /* Identify the file version */
+    if ((stat(path.c_str(), &st) < 0) || !S_ISREG(st.st_mode)) {
+        out->append("Error: cannot open " + std::string(name) + "\r\n");
+        return NULL;
+    }
+    if (static_cast<size_t>(st.st_size) > SCR_SIZE_MAX) {
+        out->append("Error: " + std::string(name) + " is too large\r\n");
+        return NULL;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        auto ffile = cache->files.find(path);
+        if ((ffile != cache->files.end()) &&
+            (ffile->second.dev == st.st_dev) &&
+            (ffile->second.ino == st.st_ino) &&
+            (ffile->second.size == st.st_size) &&
+            (ffile->second.mtime.tv_sec == st.st_mtim.tv_sec) &&
+            (ffile->second.mtime.tv_nsec == st.st_mtim.tv_nsec)) {
+            return ffile->second.script;
+        }
+    }
+    /* Read and compile */
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        out->append("Error: cannot open " + std::string(name) + "\r\n");
+        return NULL;
+    }
+    text << file.rdbuf();
+    script = scr_compile(text.str());
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    if (cache->files.size() >= SCR_CACHE_MAX) {
+        cache->files.clear();
+    }
+    cache->files[path] = {
+        .dev = st.st_dev,
+        .ino = st.st_ino,
+        .size = st.st_size,
+        .mtime = st.st_mtim,
+        .script = script
+    };
+    return script;
+}
+
+static int scr_run(struct srv *const srv, struct sess *const s,
+                   const struct scr *const script,
+                   const std::string_view name, std::string *const out) {
+    /* Variables */
+    struct cmd_call call = {
+        .srv = srv,
+        .sess = s,
+        .argv = {},
+        .out = out,
+        .src = NULL,
+        .user = NULL
+    };
+    int result = 0;
+    /* Assertion */
+    if (scr_depth >= SCR_DEPTH_MAX) {
+        out->append("Error: scripts are nested too deep\r\n");
+        return (-1);
+    }
+    /* Run until the first error */
+    ++scr_depth;
+    try {
+        for (const struct scr_step &step : script->steps) {
+            const std::string_view line(step.line);
+            call.argv.clear();
+            for (const auto &[offset, size] : step.words) {
+                call.argv.push_back(line.substr(offset, size));
+            }
+            if (!cmd_exists(&srv->cmds, call.argv[0])) {
+                out->append("Error: " + std::string(name) + ":" +
+                            std::to_string(step.lineno) +
+                            ": unknown command\r\n");
+                result = (-1);
+                break;
+            }
+            result = srv_exec_call(srv, &call, line);
+            if (result < 0) {
+                out->append("Error: " + std::string(name) + ":" +
+                            std::to_string(step.lineno) +
+                            ": command failed\r\n");
+            }
+            if (result != 0) {
+                break;
+            }
+        }
+    } catch (const std::bad_alloc& e) {
+        result = (-1);
+    }
+    --scr_depth;
+    return result;
+}
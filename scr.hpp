@@ -0,0 +1,113 @@
+/**
+ * @file scr.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Server-side scripts ("source", "batch") with a compiled cache.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef SCR_HPP
+#define SCR_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr size_t SCR_SIZE_MAX = 1024 * 1024; /**< Script text limit */
+constexpr size_t SCR_CACHE_MAX = 64; /**< Cached scripts of each kind */
+constexpr unsigned SCR_DEPTH_MAX = 8; /**< Nested "source" calls */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct sess;
+
+/**
+ * @brief One compiled command of a script.
+ */
+struct scr_step {
+    std::string line; /**< Command line (trimmed) */
+    std::vector<std::pair<uint32_t, uint32_t>> words; /**< (offset, size) */
+    unsigned lineno; /**< Line number in the source, 1-based */
+};
+
+/**
+ * @brief Compiled script (immutable once cached).
+ */
+struct scr {
+    std::vector<struct scr_step> steps; /**< Commands, comments dropped */
+};
+
+/**
+ * @brief Cached compiled script file.
+ */
+struct scr_file {
+    dev_t dev; /**< Identity and version of the file */
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    std::shared_ptr<const struct scr> script;
+};
+
+/**
+ * @brief Compiled script cache of a server (thread-safe).
+ *
+ * Files are keyed by path and revalidated with stat(2), inline blocks
+ * are keyed by their text. A full map is simply dropped.
+ */
+struct scr_cache {
+    std::mutex mutex;
+    std::unordered_map<std::string, struct scr_file> files;
+    std::unordered_map<std::string, std::shared_ptr<const struct scr>> blocks;
+};
+
+/**
+ * @brief Heredoc being collected by a session ("batch <<TAG").
+ */
+struct scr_block {
+    std::string tag; /**< Terminating line */
+    std::string text; /**< Lines collected so far, "\n" separated */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Registers the script commands ("source", "batch").
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+int scr_register(struct srv *const srv);
+
+/**
+ * @brief Collects one line of a pending heredoc, runs the block when
+ * the terminating tag arrives.
+ *
+ * @param srv The server.
+ * @param s The session (s->block != NULL).
+ * @param line The input line.
+ * @param out Receives the output of the block.
+ * @return int Result of the block (see cmd_handler).
+ */
+int scr_collect(struct srv *const srv, struct sess *const s,
+                const std::string_view line, std::string *const out);
+
+#endif /* SCR_HPP */
@@ -0,0 +1,169 @@
+/**
+ * @file sess.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Telnet client session state and output queue.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cstring>
+#include <new>
+#include "sess.hpp"
+#include "enc.hpp"
+#include "rctr.hpp"
+#include "rpc.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Appends "u32 length | bytes" to a hibernation blob.
+ */
+static void sess_pack(std::string *const blob, const std::string &str);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int sess_write(struct sess *const s, const char *data, const size_t len) {
+    return oq_append(&s->oq[OQ_BULK], &s->rctr->chunks, data, len);
+}
+
+int sess_text(struct sess *const s, const char *data, const size_t len) {
+    return enc_append(&s->oq[OQ_BULK], &s->rctr->chunks, data, len,
+                      (s->parent == NULL) ? (ENC_CRLF | ENC_IAC) : ENC_CRLF);
+}
+
+int sess_echo(struct sess *const s, const char *data, const size_t len) {
+    return oq_append(&s->oq[OQ_INTERACTIVE], &s->rctr->chunks, data, len);
+}
+
+int sess_hibernate(struct sess *const s) {
+    /* Variables */
+    size_t size = sizeof(uint32_t) + s->buf.size();
+    std::unique_ptr<std::string> blob;
+    /* Blob: [u32 length | bytes] of every history entry, then the line */
+    if (!s->history.empty() || !s->buf.empty()) {
+        for (const std::string &h : s->history) {
+            size += sizeof(uint32_t) + h.size();
+        }
+        try {
+            blob = std::make_unique<std::string>();
+            blob->reserve(size);
+            for (const std::string &h : s->history) {
+                sess_pack(blob.get(), h);
+            }
+            sess_pack(blob.get(), s->buf);
+        } catch (const std::bad_alloc& e) {
+            return (-1);
+        }
+    }
+    /* Release */
+    s->hib = std::move(blob);
+    std::string().swap(s->buf);
+    tlnt_policy::hist::store().swap(s->history);
+    s->hibernated = true;
+    mtrc_add(&s->rctr->mtrc, MTRC_HIBERNATED, 1);
+    return 0;
+}
+
+int sess_wake(struct sess *const s) {
+    /* Variables */
+    const char *p;
+    const char *end;
+    uint32_t len;
+    /* Awake */
+    if (!s->hibernated) {
+        return 0;
+    }
+    /* Unpack, the last entry is the line */
+    if (s->hib != NULL) {
+        p = s->hib->data();
+        end = p + s->hib->size();
+        try {
+            while (p < end) {
+                memcpy(&len, p, sizeof(len));
+                p += sizeof(len);
+                if ((p + len) == end) {
+                    s->buf.assign(p, len);
+                } else {
+                    s->history.emplace_back(p, len);
+                }
+                p += len;
+            }
+        } catch (const std::bad_alloc& e) {
+            s->buf.clear();
+            s->history.clear();
+            return (-1);
+        }
+        s->hib.reset();
+    }
+    s->hibernated = false;
+    mtrc_add(&s->rctr->mtrc, MTRC_WOKEN, 1);
+    return 0;
+}
+
+int sess_sniff(struct sess *const s, const char *data, const size_t len) {
+    /* Variables */
+    bool rpc;
+    bool mux;
+    /* Partial magic of a hibernated session */
+    if (sess_wake(s) < 0) {
+        return (-1);
+    }
+    /* Binary modes would skip the login */
+    if (s->login != NULL) {
+        s->mode = SESS_TEXT;
+        return parser_feed(s, data, len);
+    }
+    /* Match the magics byte by byte */
+    for (size_t i = 0; i < len; ++i) {
+        s->buf.push_back(data[i]);
+        rpc = tlnt_policy::feat::rpc && RPC_MAGIC.starts_with(s->buf);
+        mux = tlnt_policy::feat::mux && MUX_MAGIC.starts_with(s->buf);
+        if (!rpc && !mux) {
+            /* Text: a partial magic is dropped */
+            s->mode = SESS_TEXT;
+            s->buf.clear();
+            return parser_feed(s, data + i, len - i);
+        }
+        if constexpr (tlnt_policy::feat::rpc) {
+            if (s->buf == RPC_MAGIC) {
+                s->mode = SESS_RPC;
+                s->buf.clear();
+                log_info("RPC mode: ", s->id);
+                if (sess_write(s, RPC_MAGIC) < 0) {
+                    return (-1);
+                }
+                return rpc_feed(s, data + i + 1, len - i - 1);
+            }
+        }
+        if constexpr (tlnt_policy::feat::mux) {
+            if (s->buf == MUX_MAGIC) {
+                s->buf.clear();
+                if ((mux_start(s) < 0) || (sess_write(s, MUX_MAGIC) < 0)) {
+                    return (-1);
+                }
+                return mux_feed(s, data + i + 1, len - i - 1);
+            }
+        }
+    }
+    return 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void sess_pack(std::string *const blob, const std::string &str) {
+    /* Variables */
+    const uint32_t len = static_cast<uint32_t>(str.size());
+    /* Append (capacity reserved by the caller) */
+    blob->append(reinterpret_cast<const char *>(&len), sizeof(len));
+    blob->append(str);
+}
@@ -0,0 +1,206 @@
+/**
+ * @file sess.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Telnet client session state and output queue.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef SESS_HPP
+#define SESS_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "policy.hpp"
+#include "acct.hpp"
+#include "auth.hpp"
+#include "parser.hpp"
+#include "trns.hpp"
+#include "oq.hpp"
+#include "tlnt.hpp"
+#include "scr.hpp"
+#include "mux.hpp"
+#include "pgr.hpp"
+#include "proc.hpp"
+#include "rec.hpp"
+#include "shp.hpp"
+#include "tmr.hpp"
+#include "wtch.hpp"
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct rctr;
+
+/**
+ * @brief Input mode of a session.
+ */
+enum sess_mode : uint8_t {
+    SESS_SNIFF = 0, /**< No input yet, a mode magic may follow */
+    SESS_TEXT, /**< Interactive lines (parser FSM) */
+    SESS_RPC, /**< Binary request frames (rpc.hpp) */
+    SESS_MUX /**< Channel frames (mux.hpp) */
+};
+
+/**
+ * @brief A single client session.
+ *
+ * Owns the line buffer, command history and FSM state of one connection.
+ * Output produced while parsing is queued in oq and pushed to the
+ * transport by the owning reactor.
+ */
+struct sess {
+    unsigned long id; /**< Server-wide session identifier */
+    struct srv *srv; /**< Owning server */
+    struct rctr *rctr; /**< Owning reactor */
+    std::list<struct sess *>::iterator it; /**< Position in rctr->sessions */
+    struct trns *trns; /**< Transport of the session */
+    std::string buf; /**< Current input line (RPC: partial frames) */
+    tlnt_policy::hist::store history; /**< Command history */
+    struct parse_data prsdata; /**< Parser FSM state */
+    std::unique_ptr<struct scr_block> block; /**< "batch <<TAG" heredoc */
+    std::unique_ptr<struct mux> mux; /**< Channels (SESS_MUX) */
+    std::unique_ptr<struct pgr> pager; /**< Paged output (--More--) */
+    std::unique_ptr<struct wtch> watch; /**< Re-run command ("watch") */
+    std::unique_ptr<struct proc> proc; /**< Program in the foreground */
+    std::unique_ptr<struct auth_login> login; /**< Login in progress, NULL -
+                                                   logged in or none needed */
+    struct oq oq[OQ_CLASSES]; /**< Output not yet sent, per class */
+    std::atomic<int64_t> rate; /**< Output limit, bytes/s (0 - unlimited,
+                                    -1 - cfg rate_session), set on the
+                                    reactor thread, read by any */
+    std::atomic<enum rec_fmt> fmt; /**< Output format of records ("format"),
+                                        any thread */
+    struct shp shp; /**< Output token bucket */
+    struct tmr shaped; /**< Resumes output paused by the shaper */
+    uint16_t cols; /**< Terminal width (NAWS), 0 - unknown */
+    uint16_t rows; /**< Terminal height (NAWS), 0 - unknown: no paging */
+    uint32_t events; /**< Registered IO_* interest */
+    bool tcp; /**< TCP transport (TCP_INFO can be sampled) */
+    char peer[24]; /**< Peer "ip:port", "-" for non-TCP transports */
+    struct tlnt_tcp_stat net; /**< Last TCP_INFO sample (rctr->mutex) */
+    uint64_t net_at; /**< tmr_now_ms() of the sample, 0 - none */
+    struct acct_win acct; /**< CPU, traffic, commands (rctr->mutex) */
+    bool closing; /**< rctr_sess_close() called */
+    bool hibernated; /**< Line state packed into hib (sess_hibernate()) */
+    uint64_t active_at; /**< tmr_now_ms() of the last input */
+    uint64_t probe_at; /**< tmr_now_ms() of the last keepalive probe */
+    unsigned probes; /**< Keepalive probes without an answer (input or a
+                          TCP ACK since), 0 - none out */
+    std::unique_ptr<std::string> hib; /**< Packed history and line, or
+                                           NULL if there was none */
+    enum sess_mode mode; /**< Input mode */
+    unsigned refs; /**< Worker jobs in flight (reactor thread only) */
+    struct sess *parent; /**< Connection session of a channel, or NULL */
+    void *user; /**< Free for use by the embedding application */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Queues bytes for output to the session client (bulk class).
+ *
+ * @param s The session.
+ * @param data Bytes to send.
+ * @param len Number of bytes.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int sess_write(struct sess *const s, const char *data, const size_t len);
+
+/**
+ * @brief Queues command output (bulk class) through the output encoding
+ * (enc.hpp): bare "\n" goes out as "\r\n", and on a Telnet connection
+ * (not a channel) 0xFF is doubled, so handlers write plain text.
+ *
+ * @param s The session.
+ * @param data Text to send.
+ * @param len Number of bytes.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int sess_text(struct sess *const s, const char *data, const size_t len);
+
+/**
+ * @brief Queues echo or a line edit (interactive class, sent ahead of
+ * queued bulk output).
+ *
+ * @param s The session.
+ * @param data Bytes to send.
+ * @param len Number of bytes.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int sess_echo(struct sess *const s, const char *data, const size_t len);
+
+/**
+ * @brief Feeds the first bytes of a session: a complete RPC_MAGIC or
+ * MUX_MAGIC switches the mode (and is echoed), anything else is text.
+ *
+ * Matched magic bytes are kept in s->buf meanwhile.
+ *
+ * @param s The session (SESS_SNIFF).
+ * @param data Received bytes.
+ * @param len Number of bytes.
+ * @return int Result of the feed function of the selected mode.
+ */
+int sess_sniff(struct sess *const s, const char *data, const size_t len);
+
+/**
+ * @brief Packs the history and the input line of an idle text session
+ * into one blob and releases their memory.
+ *
+ * @param s The session (SESS_SNIFF or SESS_TEXT, nothing queued).
+ * @return int 0 on success, or -1 on failure (out of memory, the session
+ * stays as it was).
+ */
+int sess_hibernate(struct sess *const s);
+
+/**
+ * @brief Restores the history and the input line of a hibernated
+ * session (no-op for an awake one).
+ *
+ * @param s The session.
+ * @return int 0 on success, or -1 on failure (out of memory).
+ */
+int sess_wake(struct sess *const s);
+
+/**
+ * @brief Queues a string for output to the session client.
+ */
+static inline int sess_write(struct sess *const s, const std::string_view str) {
+    return sess_write(s, str.data(), str.size());
+}
+
+/**
+ * @brief Queues a string of command output through the encoding.
+ */
+static inline int sess_text(struct sess *const s, const std::string_view str) {
+    return sess_text(s, str.data(), str.size());
+}
+
+/**
+ * @brief Queues a string as echo (interactive class).
+ */
+static inline int sess_echo(struct sess *const s, const std::string_view str) {
+    return sess_echo(s, str.data(), str.size());
+}
+
+/**
+ * @brief Output bytes queued in all classes.
+ */
+static inline size_t sess_queued(const struct sess *const s) {
+    return s->oq[OQ_INTERACTIVE].bytes + s->oq[OQ_BULK].bytes;
+}
+
+#endif /* SESS_HPP */
@@ -0,0 +1,81 @@
+/**
+ * @file shp.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Token bucket output shaper.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include "shp.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Bucket depth for a rate, bytes.
+ */
+static int64_t shp_depth(const uint64_t rate);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+size_t shp_budget(struct shp *const b, const uint64_t rate,
+                  const uint64_t now) {
+    /* Variables */
+    const int64_t depth = shp_depth(rate);
+    uint64_t add;
+    /* Unlimited */
+    if (rate == 0) {
+        b->rate = 0;
+        return SIZE_MAX;
+    }
+    /* New rate: start with a full bucket */
+    if (b->rate != rate) {
+        b->rate = rate;
+        b->tokens = depth;
+        b->at = now;
+    }
+    /* Refill (time is kept until it is worth at least one byte) */
+    add = (now > b->at) ? std::min<uint64_t>(((now - b->at) * rate) / 1000,
+                                             static_cast<uint64_t>(depth))
+                        : 0; /* Clocks of other threads may lag behind */
+    if (add > 0) {
+        b->tokens = std::min(b->tokens + static_cast<int64_t>(add), depth);
+        b->at = now;
+    }
+    return (b->tokens > 0) ? static_cast<size_t>(b->tokens) : 0;
+}
+
+void shp_take(struct shp *const b, const size_t n) {
+    if (b->rate != 0) {
+        b->tokens -= static_cast<int64_t>(n);
+    }
+}
+
+uint64_t shp_delay(const struct shp *const b) {
+    /* Variables */
+    const int64_t need = (shp_depth(b->rate) / 2) - b->tokens;
+    uint64_t ms;
+    /* Time to refill */
+    if ((b->rate == 0) || (need <= 0)) {
+        return 1;
+    }
+    ms = ((static_cast<uint64_t>(need) * 1000) + b->rate - 1) / b->rate;
+    return std::clamp<uint64_t>(ms, 1, SHP_DELAY_MAX);
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int64_t shp_depth(const uint64_t rate) {
+    return static_cast<int64_t>(std::max(SHP_BURST_MIN,
+                                         (rate * SHP_BURST_MS) / 1000));
+}
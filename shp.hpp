@@ -0,0 +1,78 @@
+/**
+ * @file shp.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Token bucket output shaper.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef SHP_HPP
+#define SHP_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr uint64_t SHP_BURST_MS = 100; /**< Bucket depth, ms of the rate */
+constexpr uint64_t SHP_BURST_MIN = 4096; /**< Smallest bucket depth */
+constexpr uint64_t SHP_RATE_MAX = uint64_t(1) << 34; /**< Largest rate,
+                                                         bytes/s */
+constexpr uint64_t SHP_DELAY_MAX = 1000; /**< Longest pause (rate changes
+                                              are seen at least this often) */
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Token bucket, one token per byte.
+ *
+ * The rate is passed on every call, so it can change at runtime. Tokens
+ * may go negative when a send overdraws the bucket, later sends pay back.
+ */
+struct shp {
+    uint64_t rate = 0; /**< Rate of the last refill, bytes/s */
+    int64_t tokens = 0; /**< Available bytes */
+    uint64_t at = 0; /**< tmr_now_ms() of the last refill */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Refills a bucket and tells how many bytes may be sent now.
+ *
+ * @param b The bucket.
+ * @param rate Bytes per second, 0 - unlimited.
+ * @param now tmr_now_ms().
+ * @return size_t Bytes that may be sent (SIZE_MAX if unlimited).
+ */
+size_t shp_budget(struct shp *const b, const uint64_t rate,
+                  const uint64_t now);
+
+/**
+ * @brief Takes sent bytes from a bucket.
+ *
+ * @param b The bucket.
+ * @param n Bytes sent.
+ */
+void shp_take(struct shp *const b, const size_t n);
+
+/**
+ * @brief Milliseconds until an empty bucket is worth sending from again
+ * (half of its depth refilled).
+ *
+ * @param b The bucket (refilled by shp_budget()).
+ * @return uint64_t Delay, 1..SHP_DELAY_MAX ms.
+ */
+uint64_t shp_delay(const struct shp *const b);
+
+#endif /* SHP_HPP */
@@ -0,0 +1,404 @@
+/**
+ * @file soak.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Connection-scale soak test (memory per session, fd limits, leaks).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <malloc.h>
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "srv.hpp"
+#include "trns.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief Soak test parameters (command line).
+ */
+struct soak_config {
+    size_t idle; /**< Idle sessions (connect and never talk) */
+    size_t active; /**< Active sessions (send commands in a loop) */
+    unsigned hold; /**< Seconds to hold all sessions open */
+    size_t budget; /**< Max bytes of RSS per session, 0 - no limit */
+    bool tcp; /**< TCP over 127.0.0.1 instead of in-memory loopback */
+    in_port_t port; /**< TCP port of the embedded server */
+    unsigned idle_wait; /**< Seconds to wait before the idle sample */
+    const char *cfgfile; /**< Server tunables (cfg.hpp), NULL - defaults */
+};
+
+/**
+ * @brief Process resource usage snapshot.
+ */
+struct soak_usage {
+    size_t rss; /**< Resident set size, bytes */
+    size_t heap; /**< Heap bytes in use (freed blocks do not leave RSS) */
+    size_t fds; /**< Open descriptors */
+    size_t threads; /**< Threads */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Parses the command line.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments.
+ * @param cfg Receives the parameters.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int soak_args(int argc, char **argv, struct soak_config *const cfg);
+
+/**
+ * @brief Raises RLIMIT_NOFILE to the hard limit.
+ *
+ * @return rlim_t The new soft limit.
+ */
+static rlim_t soak_raise_nofile();
+
+/**
+ * @brief Samples RSS, descriptors and threads of this process.
+ *
+ * @param usage Receives the snapshot.
+ */
+static void soak_sample(struct soak_usage *const usage);
+
+/**
+ * @brief Opens one client connection (TCP or loopback).
+ *
+ * @param srv The embedded server.
+ * @param cfg Parameters.
+ * @return struct trns* Client end, or NULL on failure.
+ */
+static struct trns *soak_connect(struct srv *const srv,
+                                 const struct soak_config *const cfg);
+
+/**
+ * @brief Reads from a client until the prompt arrives.
+ *
+ * @param t Client end.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int soak_wait_prompt(struct trns *const t);
+
+/**
+ * @brief Waits until the server reports the expected session count.
+ *
+ * @param srv The server.
+ * @param count Expected number of sessions.
+ * @param seconds Timeout.
+ * @return int 0 on success, or -1 on timeout.
+ */
+static int soak_wait_sessions(struct srv *const srv, const size_t count,
+                              const unsigned seconds);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int main(int argc, char **argv) {
+    /* Variables */
+    struct soak_config cfg = {
+        .idle = 1000,
+        .active = 16,
+        .hold = 5,
+        .budget = 0,
+        .tcp = !tlnt_policy::trns::dynamic, /* No loopback with sockets
+                                               only (minimal profile) */
+        .port = 23230,
+        .idle_wait = 0,
+        .cfgfile = NULL
+    };
+    struct srv_config srvcfg = {};
+    struct soak_usage base;
+    struct soak_usage load;
+    struct soak_usage rest;
+    struct soak_usage done;
+    std::vector<struct trns *> clients;
+    struct srv *srv;
+    size_t total;
+    size_t per_session;
+    uint64_t commands = 0;
+    int failed = 0;
+    /* Setup */
+    if (soak_args(argc, argv, &cfg) < 0) {
+        std::cout << "Usage: telnet_soak [--idle N] [--active M] [--hold SEC]"
+                     " [--budget BYTES] [--tcp] [--port PORT]"
+                     " [--config FILE] [--idle-wait SEC]" << std::endl;
+        return 2;
+    }
+    total = cfg.idle + cfg.active;
+    mallopt(M_ARENA_MAX, 1); /* mallinfo2() sees the main arena only */
+    log_set_level(LOG_ERROR); /* no per-connection logs */
+    std::cout << "nofile_limit=" << soak_raise_nofile() << std::endl;
+    srvcfg.port = cfg.tcp ? cfg.port : 0;
+    srvcfg.lqueue = 4096;
+    srvcfg.cfgfile = cfg.cfgfile;
+    srv = srv_create(&srvcfg, NULL);
+    if ((srv == NULL) || (srv_start(srv) < 0)) {
+        std::cout << "Error: server start" << std::endl;
+        return 1;
+    }
+    soak_sample(&base);
+    /* Connect */
+    clients.reserve(total);
+    for (size_t i = 0; i < total; ++i) {
+        struct trns *t = soak_connect(srv, &cfg);
+        if (t == NULL) {
+            std::cout << "Error: connect failed after " << i
+                      << " sessions" << std::endl;
+            failed = 1;
+            break;
+        }
+        clients.push_back(t);
+    }
+    if (soak_wait_sessions(srv, clients.size(), 30) < 0) {
+        std::cout << "Error: server has " << srv_session_count(srv)
+                  << " of " << clients.size() << " sessions" << std::endl;
+        failed = 1;
+    }
+    /* Hold: idle sessions sleep, active ones run commands */
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::seconds(cfg.hold);
+    for (size_t i = 0; (i < cfg.active) && (i < clients.size()); ++i) {
+        soak_wait_prompt(clients[i]);
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+        if ((cfg.active == 0) || (clients.size() < total)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        for (size_t i = 0; i < cfg.active; ++i) {
+            if ((trns_send(clients[i], "Pinata\r", 7) != 7) ||
+                (soak_wait_prompt(clients[i]) < 0)) {
+                std::cout << "Error: active session " << i
+                          << " stopped answering" << std::endl;
+                failed = 1;
+                break;
+            }
+            ++commands;
+        }
+        if (failed) {
+            break;
+        }
+    }
+    soak_sample(&load);
+    /* Idle for a while (hibernate_ms of the config) */
+    std::this_thread::sleep_for(std::chrono::seconds(cfg.idle_wait));
+    soak_sample(&rest);
+    /* Disconnect and look for leaks */
+    for (struct trns *t : clients) {
+        trns_destroy(t);
+    }
+    if (soak_wait_sessions(srv, 0, 30) < 0) {
+        std::cout << "Error: " << srv_session_count(srv)
+                  << " sessions leaked" << std::endl;
+        failed = 1;
+    }
+    soak_sample(&done);
+    if (srv_mtrc(srv, MTRC_ACCEPTED) != srv_mtrc(srv, MTRC_CLOSED)) {
+        std::cout << "Error: accepted " << srv_mtrc(srv, MTRC_ACCEPTED)
+                  << " closed " << srv_mtrc(srv, MTRC_CLOSED) << std::endl;
+        failed = 1;
+    }
+    if (done.fds > base.fds) {
+        std::cout << "Error: " << (done.fds - base.fds)
+                  << " descriptors leaked" << std::endl;
+        failed = 1;
+    }
+    srv_stop(srv);
+    srv_destroy(srv);
+    /* Report */
+    per_session = (total > 0) && (load.rss > base.rss) ?
+                  ((load.rss - base.rss) / total) : 0;
+    std::cout << "transport=" << (cfg.tcp ? "tcp" : "mem")
+              << " sessions=" << clients.size()
+              << " idle=" << cfg.idle << " active=" << cfg.active
+              << " hold_s=" << cfg.hold << " commands=" << commands
+              << std::endl;
+    std::cout << "rss_base=" << base.rss << " rss_load=" << load.rss
+              << " rss_done=" << done.rss
+              << " rss_per_session=" << per_session << std::endl;
+    std::cout << "heap_base=" << base.heap << " heap_load=" << load.heap
+              << " heap_rest=" << rest.heap << " heap_per_session="
+              << (((total > 0) && (load.heap > base.heap)) ?
+                  ((load.heap - base.heap) / total) : 0)
+              << " heap_per_idle_session="
+              << (((total > 0) && (rest.heap > base.heap)) ?
+                  ((rest.heap - base.heap) / total) : 0) << std::endl;
+    std::cout << "fds_base=" << base.fds << " fds_load=" << load.fds
+              << " fds_done=" << done.fds << std::endl;
+    std::cout << "threads_base=" << base.threads
+              << " threads_load=" << load.threads
+              << " threads_done=" << done.threads << std::endl;
+    if ((cfg.budget > 0) && (per_session > cfg.budget)) {
+        std::cout << "Error: " << per_session << " bytes per session exceed"
+                  << " the budget of " << cfg.budget << std::endl;
+        failed = 1;
+    }
+    std::cout << (failed ? "FAIL" : "PASS") << std::endl;
+    return failed;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int soak_args(int argc, char **argv, struct soak_config *const cfg) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char *val = ((i + 1) < argc) ? argv[i + 1] : NULL;
+        if (arg == "--tcp") {
+            cfg->tcp = true;
+            continue;
+        }
+        if (val == NULL) {
+            return (-1);
+        }
+        if (arg == "--idle") {
+            cfg->idle = strtoul(val, NULL, 10);
+        } else if (arg == "--active") {
+            cfg->active = strtoul(val, NULL, 10);
+        } else if (arg == "--hold") {
+            cfg->hold = strtoul(val, NULL, 10);
+        } else if (arg == "--budget") {
+            cfg->budget = strtoul(val, NULL, 10);
+        } else if (arg == "--config") {
+            cfg->cfgfile = val;
+        } else if (arg == "--idle-wait") {
+            cfg->idle_wait = strtoul(val, NULL, 10);
+        } else if (arg == "--port") {
+            cfg->port = static_cast<in_port_t>(strtoul(val, NULL, 10));
+        } else {
+            return (-1);
+        }
+        ++i;
+    }
+    return 0;
+}
+
+static rlim_t soak_raise_nofile() {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) < 0) {
+        return 0;
+    }
+    rl.rlim_cur = rl.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &rl) < 0) {
+        getrlimit(RLIMIT_NOFILE, &rl);
+    }
+    return rl.rlim_cur;
+}
+
+static void soak_sample(struct soak_usage *const usage) {
+    /* Variables */
+    std::ifstream statm("/proc/self/statm");
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t pages = 0;
+    size_t resident = 0;
+    DIR *dir;
+    /* RSS */
+    statm >> pages >> resident;
+    usage->rss = resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    /* Heap */
+    usage->heap = mallinfo2().uordblks;
+    /* Threads */
+    usage->threads = 0;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) {
+            usage->threads = strtoul(line.c_str() + 8, NULL, 10);
+        }
+    }
+    /* Descriptors (without ".", ".." and the directory itself) */
+    usage->fds = 0;
+    dir = opendir("/proc/self/fd");
+    if (dir != NULL) {
+        while (readdir(dir) != NULL) {
+            ++usage->fds;
+        }
+        closedir(dir);
+        usage->fds -= 3;
+    }
+}
+
+static struct trns *soak_connect(struct srv *const srv,
+                                 const struct soak_config *const cfg) {
+    /* Variables */
+    sockaddr_in addr{};
+    struct trns *t;
+    int fd;
+    /* In-memory loopback */
+    if (!cfg->tcp) {
+        return srv_connect_loopback(srv);
+    }
+    /* TCP */
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg->port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return NULL;
+    }
+    t = trns_socket_create(fd);
+    if (t == NULL) {
+        close(fd);
+    }
+    return t;
+}
+
+static int soak_wait_prompt(struct trns *const t) {
+    /* Variables */
+    char buf[512];
+    std::string tail;
+    ssize_t n;
+    /* Read until "> " */
+    for (;;) {
+        n = trns_recv(t, buf, sizeof(buf));
+        if (n <= 0) {
+            return (-1);
+        }
+        tail.append(buf, n);
+        if ((tail.size() >= 2) && (tail.compare(tail.size() - 2, 2, "> ") == 0)) {
+            return 0;
+        }
+        if (tail.size() > 64) {
+            tail.erase(0, tail.size() - 2);
+        }
+    }
+}
+
+static int soak_wait_sessions(struct srv *const srv, const size_t count,
+                              const unsigned seconds) {
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::seconds(seconds);
+    while (srv_session_count(srv) != count) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return (-1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return 0;
+}
@@ -0,0 +1,654 @@
+/**
+ * @file srv.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Embeddable Telnet server object (start/stop, commands, callbacks).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "srv.hpp"
+#include "sess.hpp"
+#include "rctr.hpp"
+#include "tlnt.hpp"
+#include "adm.hpp"
+#include "wtch.hpp"
+#include "prof.hpp"
+#include "proc.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Loads the tunables (defaults, then the file if configured).
+ *
+ * @param srv The server.
+ * @param c Receives the configuration.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int srv_conf_load(struct srv *const srv, struct cfg *const c);
+
+/**
+ * @brief Registers the commands of the features built in (policy.hpp):
+ * "watch" and the configured programs.
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int srv_register_features(struct srv *const srv);
+
+/**
+ * @brief Blocks the stop/reload signals and opens the signalfd.
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int srv_signals_open(struct srv *const srv);
+
+/**
+ * @brief Pins the admin reactor to the last CPU the process may use and
+ * keeps the other reactors off it (if there is more than one CPU).
+ *
+ * @param srv The server (started, with the admin reactor).
+ */
+static void srv_adm_pin(struct srv *const srv);
+
+/**
+ * @brief Admin rest timer: watches the admin listener again.
+ *
+ * @param t srv->admrest.
+ */
+static void srv_adm_resume(struct tmr *const t);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+struct srv *srv_create(const struct srv_config *const cfg,
+                       const struct srv_callbacks *const cbs) {
+    /* Assertion */
+    if (cfg == NULL) {
+        log_error("Error: srv_config == NULL");
+        return NULL;
+    }
+    /* Variables */
+    struct srv *srv = new (std::nothrow) struct srv;
+    struct cfg conf;
+    if (srv == NULL) {
+        return NULL;
+    }
+    srv->cfg = *cfg;
+    srv->cbs = {};
+    if (cbs != NULL) {
+        srv->cbs = *cbs;
+    }
+    srv->srvsocket = (-1);
+    srv->inherited = false;
+    srv->admsocket = (-1);
+    srv->adm = NULL;
+    srv->admrest.cb = srv_adm_resume;
+    srv->admrest.arg = srv;
+    srv->running = false;
+    srv->rctrs = NULL;
+    srv->nrctr = 0;
+    srv->rr = 0;
+    srv->next_id = 1;
+    srv->sigfd = (-1);
+    srv->stopsig = 0;
+    srv->nsess = 0;
+    srv->auth = {};
+    acct_us(0); /* TSC calibration starts here */
+    if constexpr (tlnt_policy::feat::auth) {
+        if (auth_cache_init(&srv->authcache) < 0) {
+            delete srv;
+            return NULL;
+        }
+    }
+    if ((srv_conf_load(srv, &conf) < 0) ||
+        (cfg_publish(&srv->conf, &conf) < 0)) {
+        delete srv;
+        return NULL;
+    }
+    if (srv->cfg.cfgfile != NULL) {
+        log_set_level(conf.log_level);
+    }
+    if ((cmd_register_builtins(&srv->cmds) < 0) || (adm_register(srv) < 0) ||
+        (scr_register(srv) < 0) || (srv_register_features(srv) < 0)) {
+        cfg_fini(&srv->conf);
+        delete srv;
+        return NULL;
+    }
+    return srv;
+}
+
+void srv_destroy(struct srv *const srv) {
+    if (srv == NULL) {
+        return;
+    }
+    srv_stop(srv);
+    cfg_fini(&srv->conf);
+    delete srv;
+}
+
+int srv_start(struct srv *const srv) {
+    /* Assertion */
+    if (srv == NULL) {
+        return (-1);
+    }
+    if (srv->running) {
+        log_error("Error: server is already running");
+        return (-1);
+    }
+    /* Variables */
+    const bool admin = (srv->cfg.admpath != NULL) || (srv->cfg.admport > 0);
+    unsigned n;
+    unsigned i;
+    /* Sizes for the limits of the process (the settings override) */
+    plan_make(&srv->plan, cfg_hold(&srv->conf).get(), srv->cfg.lqueue,
+              tlnt_policy::reactors, tlnt_policy::workers);
+    log_info("Plan: ", plan_describe(&srv->plan));
+    n = srv->plan.reactors;
+    /* Reactors (and the admin one) */
+    srv->rctrs = new (std::nothrow) struct rctr[n + (admin ? 1 : 0)];
+    if (srv->rctrs == NULL) {
+        return (-1);
+    }
+    for (srv->nrctr = 0; srv->nrctr < (n + (admin ? 1 : 0)); ++srv->nrctr) {
+        if (rctr_init(&srv->rctrs[srv->nrctr], srv, srv->nrctr) < 0) {
+            goto srv_start_fini;
+        }
+        if ((srv->nrctr < n) &&
+            (rctr_prealloc(&srv->rctrs[srv->nrctr], srv->plan.slab,
+                           srv->plan.chunks) < 0)) {
+            rctr_fini(&srv->rctrs[srv->nrctr]);
+            goto srv_start_fini;
+        }
+    }
+    /* Listener (optional, watched by reactor 0): passed by the parent
+     * (it queued connections while we started) or opened here */
+    if (srv->cfg.inherit) {
+        srv->srvsocket = tlnt_listen_fds();
+        srv->inherited = (srv->srvsocket >= 0);
+    }
+    if ((srv->srvsocket < 0) && (srv->cfg.port > 0)) {
+        srv->srvsocket = tlnt_init_srv(srv->cfg.port, srv->plan.backlog,
+                                       INADDR_ANY);
+        if (srv->srvsocket < 0) {
+            log_error("Error: tlnt_init_srv");
+            goto srv_start_fini;
+        }
+    }
+    if (srv->srvsocket >= 0) {
+        if ((fcntl(srv->srvsocket, F_SETFL, O_NONBLOCK) < 0) ||
+            (rctr_listen(&srv->rctrs[0], &srv->srvsocket) < 0)) {
+            log_error("Error: listen srvsocket in reactor");
+            goto srv_start_close_srv;
+        }
+    }
+    /* Admin listener (optional): a reactor of its own, so it answers
+     * however busy the others are; the TCP one is local only */
+    if (admin) {
+        srv->adm = &srv->rctrs[n];
+        srv->admsocket = (srv->cfg.admpath != NULL) ?
+                         tlnt_init_srv(srv->cfg.admpath, SRV_ADM_SLOTS) :
+                         tlnt_init_srv(srv->cfg.admport, SRV_ADM_SLOTS,
+                                       INADDR_LOOPBACK);
+        if ((srv->admsocket < 0) ||
+            (fcntl(srv->admsocket, F_SETFL, O_NONBLOCK) < 0) ||
+            (fcntl(srv->admsocket, F_SETFD, FD_CLOEXEC) < 0) ||
+            (rctr_reserve(srv->adm, SRV_ADM_SLOTS) < 0) ||
+            (rctr_listen(srv->adm, &srv->admsocket) < 0)) {
+            log_error("Error: admin listener");
+            goto srv_start_close_adm;
+        }
+    }
+    /* Signals (optional, watched by reactor 0) */
+    if (srv->cfg.signals) {
+        if ((srv_signals_open(srv) < 0) ||
+            (rctr_signals(&srv->rctrs[0], srv->sigfd) < 0)) {
+            log_error("Error: signalfd in reactor");
+            goto srv_start_close_sig;
+        }
+    }
+    srv->running = true;
+    if (wrk_start(&srv->workers, srv->plan.workers) < 0) {
+        srv_stop(srv);
+        return (-1);
+    }
+    for (i = 0; i < srv->nrctr; ++i) {
+        if (rctr_start(&srv->rctrs[i]) < 0) {
+            srv_stop(srv);
+            return (-1);
+        }
+    }
+    if (srv->adm != NULL) {
+        srv_adm_pin(srv);
+    }
+    log_info("Telnet Server runs ", n, " reactor(s)",
+             admin ? " and the admin reactor" : "");
+    return 0;
+
+srv_start_close_sig:
+    if (srv->sigfd >= 0) {
+        close(srv->sigfd);
+        srv->sigfd = (-1);
+    }
+srv_start_close_adm:
+    if (srv->admsocket >= 0) {
+        close(srv->admsocket);
+        srv->admsocket = (-1);
+        if (srv->cfg.admpath != NULL) {
+            unlink(srv->cfg.admpath);
+        }
+    }
+    srv->adm = NULL;
+srv_start_close_srv:
+    if (srv->srvsocket >= 0) {
+        close(srv->srvsocket);
+        srv->srvsocket = (-1);
+        srv->inherited = false;
+    }
+srv_start_fini:
+    for (i = 0; i < srv->nrctr; ++i) {
+        rctr_fini(&srv->rctrs[i]);
+    }
+    delete[] srv->rctrs;
+    srv->rctrs = NULL;
+    srv->nrctr = 0;
+    return (-1);
+}
+
+void srv_stop(struct srv *const srv) {
+    if ((srv == NULL) || (!srv->running.exchange(false))) {
+        return;
+    }
+    /* Workers finish the queued requests, reactors take the results */
+    wrk_stop(&srv->workers);
+    /* Reactors disconnect their sessions on the way out */
+    for (unsigned i = 0; i < srv->nrctr; ++i) {
+        rctr_stop(&srv->rctrs[i]);
+    }
+    /* A profile still running is dropped with the admin wheel */
+    if constexpr (tlnt_policy::feat::prof) {
+        if ((srv->adm != NULL) && tmr_armed(&srv->profend)) {
+            tmr_cancel(&srv->adm->wheel, &srv->profend);
+            prof_stop(NULL, NULL);
+        }
+    }
+    for (unsigned i = 0; i < srv->nrctr; ++i) {
+        rctr_fini(&srv->rctrs[i]);
+    }
+    delete[] srv->rctrs;
+    srv->rctrs = NULL;
+    srv->nrctr = 0;
+    srv->adm = NULL;
+    /* Listener and signals (a passed listener stays open in the parent
+     * and keeps queueing connections for the next start) */
+    if (srv->srvsocket >= 0) {
+        if (!srv->inherited) {
+            shutdown(srv->srvsocket, SHUT_RDWR);
+        }
+        close(srv->srvsocket);
+        srv->srvsocket = (-1);
+        srv->inherited = false;
+    }
+    if (srv->admsocket >= 0) {
+        close(srv->admsocket);
+        srv->admsocket = (-1);
+        if (srv->cfg.admpath != NULL) {
+            unlink(srv->cfg.admpath);
+        }
+    }
+    if (srv->sigfd >= 0) {
+        close(srv->sigfd);
+        srv->sigfd = (-1);
+    }
+}
+
+int srv_wait(struct srv *const srv) {
+    srv->stopsig.wait(0);
+    return srv->stopsig.load();
+}
+
+int srv_reload(struct srv *const srv) {
+    /* Variables */
+    struct cfg conf;
+    std::shared_ptr<const struct cfg> prev;
+    /* One at a time: prev and next of proc_sync() and the backlog */
+    std::lock_guard<std::mutex> lock(srv->reloadmutex);
+    prev = cfg_hold(&srv->conf);
+    /* Load and publish */
+    if (srv->cfg.cfgfile == NULL) {
+        log_error("Error: no config file to reload");
+        return (-1);
+    }
+    if ((srv_conf_load(srv, &conf) < 0) ||
+        (cfg_publish(&srv->conf, &conf) < 0)) {
+        return (-1);
+    }
+    /* Settings that live outside the snapshot (credentials may have
+     * changed with the backend, programs are commands) */
+    log_set_level(conf.log_level);
+    if constexpr (tlnt_policy::feat::proc) {
+        if (proc_sync(srv, prev.get(), cfg_hold(&srv->conf).get()) < 0) {
+            log_error("Error: program commands");
+        }
+    }
+    if constexpr (tlnt_policy::feat::auth) {
+        auth_cache_clear(&srv->authcache);
+    }
+    if (conf.backlog > 0) {
+        srv->plan.backlog = conf.backlog;
+    }
+    if ((srv->srvsocket >= 0) &&
+        (listen(srv->srvsocket, srv->plan.backlog) < 0)) {
+        log_error("Error: listen backlog ", srv->plan.backlog);
+    }
+    log_info("Config reloaded: ", srv->cfg.cfgfile);
+    return 0;
+}
+
+void srv_signal(struct srv *const srv) {
+    /* Variables */
+    struct signalfd_siginfo si;
+    /* Drain */
+    while (read(srv->sigfd, &si, sizeof(si)) == sizeof(si)) {
+        log_info(" - Get signal: ", si.ssi_signo);
+        if (si.ssi_signo == SIGHUP) {
+            srv_reload(srv);
+            continue;
+        }
+        srv->stopsig = static_cast<int>(si.ssi_signo);
+        srv->stopsig.notify_all();
+    }
+}
+
+int srv_cmd_register(struct srv *const srv, const std::string_view name,
+                     const cmd_handler handler, void *const user,
+                     const std::string_view help) {
+    return cmd_register(&srv->cmds, name, handler, user, help);
+}
+
+void srv_auth(struct srv *const srv, const struct auth_backend *const be) {
+    srv->auth = {};
+    if (be != NULL) {
+        srv->auth = *be;
+    }
+    if constexpr (tlnt_policy::feat::auth) {
+        auth_cache_clear(&srv->authcache);
+    }
+}
+
+int srv_cmd_unregister(struct srv *const srv, const std::string_view name) {
+    return cmd_unregister(&srv->cmds, name);
+}
+
+int srv_attach(struct srv *const srv, struct trns *const t) {
+    /* Assertion */
+    if ((srv == NULL) || (t == NULL)) {
+        log_error("Error: srv_attach arguments == NULL");
+        return (-1);
+    }
+    if (!srv->running) {
+        trns_destroy(t);
+        return (-1);
+    }
+    /* Round robin over the reactors (the admin one takes its own only) */
+    unsigned idx = srv->rr.fetch_add(1, std::memory_order_relaxed) %
+                   (srv->nrctr - ((srv->adm != NULL) ? 1 : 0));
+    if (rctr_adopt(&srv->rctrs[idx], t) < 0) {
+        trns_destroy(t);
+        return (-1);
+    }
+    return 0;
+}
+
+struct trns *srv_connect_loopback(struct srv *const srv) {
+    /* Variables */
+    struct trns *srvend;
+    struct trns *clntend;
+    /* Sockets only */
+    if constexpr (!tlnt_policy::trns::dynamic) {
+        errno = ENOTSUP;
+        return NULL;
+    }
+    /* Connect */
+    if (trns_loopback_pair(&srvend, &clntend) < 0) {
+        return NULL;
+    }
+    if (srv_attach(srv, srvend) < 0) {
+        trns_destroy(clntend);
+        return NULL;
+    }
+    return clntend;
+}
+
+size_t srv_session_count(struct srv *const srv) {
+    size_t count = 0;
+    for (unsigned i = 0; i < srv->nrctr; ++i) {
+        std::lock_guard<std::mutex> lock(srv->rctrs[i].mutex);
+        count += srv->rctrs[i].sessions.size();
+    }
+    return count;
+}
+
+unsigned srv_sessions_max(struct srv *const srv) {
+    /* Variables */
+    const unsigned max = cfg_hold(&srv->conf)->sessions_max;
+    /* The setting wins, also after a reload */
+    return (max != 0) ? max : srv->plan.sessions;
+}
+
+uint64_t srv_mtrc(struct srv *const srv, const enum mtrc_id id) {
+    uint64_t value = 0;
+    for (unsigned i = 0; i < srv->nrctr; ++i) {
+        value += tlnt_policy::mtrc::get(&srv->rctrs[i].mtrc, id);
+    }
+    return value;
+}
+
+void srv_mtrc_hist(struct srv *const srv, const enum mtrc_hist_id id,
+                   uint64_t *const buckets) {
+    for (size_t b = 0; b < MTRC_H_BUCKETS; ++b) {
+        buckets[b] = 0;
+        for (unsigned i = 0; i < srv->nrctr; ++i) {
+            buckets[b] += tlnt_policy::mtrc::bucket(&srv->rctrs[i].mtrc, id, b);
+        }
+    }
+}
+
+void srv_accept(struct srv *const srv) {
+    /* Variables */
+    int clntsocket; /**< Client socket (accepted connection) */
+    struct trns *t;
+    /* Accept until the backlog is empty */
+    for (;;) {
+        clntsocket = tlnt_accept_clnt(srv->srvsocket);
+        if (clntsocket < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        t = trns_socket_create(clntsocket);
+        if (t == NULL) {
+            close(clntsocket);
+            continue;
+        }
+        srv_attach(srv, t);
+    }
+}
+
+void srv_accept_admin(struct srv *const srv) {
+    /* Variables */
+    struct rctr *r = srv->adm;
+    int clntsocket;
+    struct trns *t;
+    /* Accept while a slot is free (its held descriptor is released) */
+    while (rctr_slot_take(r) == 0) {
+        clntsocket = tlnt_accept_clnt(srv->admsocket);
+        if (clntsocket < 0) {
+            rctr_slot_refill(r);
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return;
+            }
+            break;
+        }
+        t = trns_socket_create(clntsocket);
+        if (t == NULL) {
+            close(clntsocket);
+        } else {
+            rctr_sess_open(r, t);
+        }
+        rctr_slot_refill(r);
+    }
+    /* Full: clients wait in the backlog, the listener rests meanwhile */
+    if (r->io.mod(srv->admsocket, 0, &srv->admsocket) == 0) {
+        tmr_arm(&r->wheel, &srv->admrest, SRV_ADM_REST_MS);
+    }
+}
+
+int srv_exec(struct srv *const srv, struct sess *const s,
+             const std::string_view line, std::string *const out,
+             struct pgr_src **const src) {
+    /* Variables */
+    struct cmd_call call = {
+        .srv = srv,
+        .sess = s,
+        .argv = {},
+        .out = out,
+        .src = src,
+        .user = NULL
+    };
+    /* Execute */
+    try {
+        if (s->block != NULL) {
+            return scr_collect(srv, s, line, out);
+        }
+        cmd_split(line, &call.argv);
+        rctr_sess_account(s, 0, 0, 1);
+        return srv_exec_call(srv, &call, line);
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+}
+
+int srv_exec_call(struct srv *const srv, struct cmd_call *const call,
+                  const std::string_view line) {
+    /* Variables */
+    struct sess *s = call->sess;
+    /* Execute */
+    if (srv->cbs.on_command != NULL) {
+        srv->cbs.on_command(srv, s, line, srv->cbs.user);
+    }
+    mtrc_add(&s->rctr->mtrc, MTRC_COMMANDS, 1);
+    if constexpr (tlnt_policy::mtrc::enabled) {
+        const auto start = std::chrono::steady_clock::now();
+        const int result = cmd_run(&srv->cmds, call, line);
+        mtrc_observe(&s->rctr->mtrc, MTRC_H_CMD_US,
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start).count());
+        return result;
+    } else {
+        return cmd_run(&srv->cmds, call, line);
+    }
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int srv_conf_load(struct srv *const srv, struct cfg *const c) {
+    /* Variables */
+    std::string err;
+    /* Defaults, then the file */
+    cfg_defaults(c);
+    if ((srv->cfg.cfgfile != NULL) &&
+        (cfg_parse(srv->cfg.cfgfile, c, &err) < 0)) {
+        log_error("Error: config: ", err);
+        return (-1);
+    }
+    return 0;
+}
+
+static int srv_register_features(struct srv *const srv) {
+    if constexpr (tlnt_policy::feat::watch) {
+        if (wtch_register(srv) < 0) {
+            return (-1);
+        }
+    }
+    if constexpr (tlnt_policy::feat::proc) {
+        if (proc_sync(srv, NULL, cfg_hold(&srv->conf).get()) < 0) {
+            return (-1);
+        }
+    }
+    return 0;
+}
+
+static int srv_signals_open(struct srv *const srv) {
+    /* Variables */
+    sigset_t sigset;
+    /* Blocked here, so reactor and worker threads inherit the mask */
+    sigemptyset(&sigset);
+    sigaddset(&sigset, SIGINT); /* Ctrl+C */
+    sigaddset(&sigset, SIGTERM); /* kill <pid> */
+    sigaddset(&sigset, SIGHUP); /* reload */
+    if (pthread_sigmask(SIG_BLOCK, &sigset, NULL) != 0) {
+        return (-1);
+    }
+    srv->sigfd = signalfd(-1, &sigset, SFD_NONBLOCK | SFD_CLOEXEC);
+    return (srv->sigfd < 0) ? (-1) : 0;
+}
+
+static void srv_adm_pin(struct srv *const srv) {
+    /* Variables */
+    cpu_set_t set;
+    cpu_set_t own;
+    int cpu = CPU_SETSIZE - 1;
+    /* Last allowed CPU */
+    if (sched_getaffinity(0, sizeof(set), &set) < 0) {
+        return;
+    }
+    while ((cpu > 0) && !CPU_ISSET(cpu, &set)) {
+        --cpu;
+    }
+    CPU_ZERO(&own);
+    CPU_SET(cpu, &own);
+    rctr_pin(srv->adm, &own);
+    /* The data plane keeps the rest */
+    if (CPU_COUNT(&set) > 1) {
+        CPU_CLR(cpu, &set);
+        for (unsigned i = 0; i < srv->nrctr; ++i) {
+            if (&srv->rctrs[i] != srv->adm) {
+                rctr_pin(&srv->rctrs[i], &set);
+            }
+        }
+    }
+}
+
+static void srv_adm_resume(struct tmr *const t) {
+    /* Variables */
+    struct srv *srv = static_cast<struct srv *>(t->arg);
+    /* Pending clients show up as a new accept event */
+    if (srv->admsocket >= 0) {
+        srv->adm->io.mod(srv->admsocket, IO_IN, &srv->admsocket);
+    }
+}
@@ -0,0 +1,317 @@
+/**
+ * @file srv.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Embeddable Telnet server object (start/stop, commands, callbacks).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef SRV_HPP
+#define SRV_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <mutex>
+#include <netinet/in.h>
+#include "policy.hpp"
+#include "auth.hpp"
+#include "cmd.hpp"
+#include "scr.hpp"
+#include "wrk.hpp"
+#include "cfg.hpp"
+#include "plan.hpp"
+#include "shp.hpp"
+#include "tmr.hpp"
+#include "trns.hpp"
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr unsigned SRV_ADM_SLOTS = 4; /**< Sessions of the admin listener */
+constexpr uint64_t SRV_ADM_REST_MS = 100; /**< Admin listener pause while
+                                               its slots are in use */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct sess;
+struct rctr;
+
+/**
+ * @brief Server configuration.
+ */
+struct srv_config {
+    in_port_t port; /**< TCP port, 0 - no TCP listener (embedded use) */
+    int lqueue; /**< Listen queue size (backlog) */
+    const char *cfgfile; /**< Tunables file (cfg.hpp), NULL - defaults */
+    bool signals; /**< Consume SIGINT/SIGTERM (stop) and SIGHUP (reload)
+                       through a signalfd in reactor 0, see srv_wait() */
+    bool inherit; /**< Use a listener passed by the parent (LISTEN_FDS)
+                       instead of opening the port */
+    in_port_t admport; /**< Admin listener TCP port on 127.0.0.1 (no
+                            login: any local user is an admin), 0 - none */
+    const char *admpath; /**< Admin listener UNIX socket (instead of
+                              admport), NULL - none */
+};
+
+/**
+ * @brief Application callbacks (any of them may be NULL).
+ *
+ * Callbacks run in the reactor thread of the session and must not block,
+ * except on_command of RPC requests, which runs on a worker thread.
+ */
+struct srv_callbacks {
+    void (*on_connect)(struct srv *const srv, struct sess *const s,
+                       void *user); /**< Session started */
+    void (*on_disconnect)(struct srv *const srv, struct sess *const s,
+                          void *user); /**< Session is about to be freed */
+    void (*on_command)(struct srv *const srv, struct sess *const s,
+                       const std::string_view line,
+                       void *user); /**< Line entered (before execution) */
+    void *user; /**< Passed back to every callback */
+};
+
+/**
+ * @brief Server object.
+ */
+struct srv {
+    struct srv_config cfg; /**< Configuration */
+    struct srv_callbacks cbs; /**< Application callbacks */
+    struct cmd_registry cmds; /**< Command registry */
+    struct scr_cache scripts; /**< Compiled scripts */
+    struct wrk_pool workers; /**< Executes RPC requests and login hashes */
+    struct cfg_store conf; /**< Tunables, reloaded on SIGHUP */
+    std::mutex reloadmutex; /**< Serializes reloads (SIGHUP on reactor 0,
+                                 "reload" on the admin reactor) */
+    struct plan plan; /**< Sizes derived on start */
+    std::atomic<unsigned> nsess; /**< Live sessions (channels included) */
+    std::mutex shpmutex; /**< Protects shp */
+    struct shp shp; /**< Output token bucket of the server (rate_global) */
+    struct auth_backend auth; /**< Credentials of the application, lookup
+                                   NULL - the "auth" setting */
+    struct auth_cache authcache; /**< Recently verified logins */
+    int sigfd; /**< signalfd (watched by reactor 0), or -1 */
+    std::atomic<int> stopsig; /**< Stop signal received, 0 - none */
+    int srvsocket; /**< Listening socket (watched by reactor 0), or -1 */
+    bool inherited; /**< srvsocket came from the parent (never shut down,
+                         the parent may keep listening on it) */
+    int admsocket; /**< Admin listener (watched by adm), or -1 */
+    struct rctr *adm; /**< Admin reactor: own thread, pinned, reserved
+                           session slots (last of rctrs), or NULL */
+    struct tmr admrest; /**< Resumes the admin listener */
+    struct tmr profend; /**< Ends a running profile ("prof", adm wheel) */
+    std::string profpath; /**< Output file of the running profile */
+    std::string proflast; /**< Summary of the last profile */
+    std::atomic<bool> running; /**< srv_start() called, no srv_stop() yet */
+    struct rctr *rctrs; /**< Reactors (tlnt_policy::reactors of them, then
+                             adm) */
+    unsigned nrctr; /**< Number of reactors (adm included) */
+    std::atomic<unsigned> rr; /**< Round robin reactor selection */
+    std::atomic<unsigned long> next_id; /**< Next session identifier */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Creates a server object with the built-in and administrative
+ * commands registered.
+ *
+ * @param cfg Server configuration.
+ * @param cbs Application callbacks, may be NULL.
+ * @return struct srv* Server on success, or NULL on failure.
+ */
+struct srv *srv_create(const struct srv_config *const cfg,
+                       const struct srv_callbacks *const cbs);
+
+/**
+ * @brief Frees a stopped server object.
+ *
+ * @param srv The server (stopped).
+ */
+void srv_destroy(struct srv *const srv);
+
+/**
+ * @brief Starts the server (opens the listener if a port is configured,
+ * or takes the passed one with srv_config::inherit).
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+int srv_start(struct srv *const srv);
+
+/**
+ * @brief Stops the server: stops the reactors (disconnecting all
+ * sessions) and closes the listener.
+ *
+ * @param srv The server.
+ */
+void srv_stop(struct srv *const srv);
+
+/**
+ * @brief Waits until a stop signal arrives (srv_config::signals).
+ *
+ * @param srv The server (started).
+ * @return int The signal number.
+ */
+int srv_wait(struct srv *const srv);
+
+/**
+ * @brief Reloads the tunables file and publishes the new snapshot
+ * (log level and listen backlog are applied at once).
+ *
+ * On failure the current configuration stays in effect. Concurrent
+ * reloads (a signal and an admin command) run one after the other.
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+int srv_reload(struct srv *const srv);
+
+/**
+ * @brief Handles pending signals of the signalfd (reactor 0 only).
+ *
+ * @param srv The server.
+ */
+void srv_signal(struct srv *const srv);
+
+/**
+ * @brief Registers (or replaces) a command.
+ *
+ * @return int 0 on success, or -1 on failure.
+ */
+int srv_cmd_register(struct srv *const srv, const std::string_view name,
+                     const cmd_handler handler, void *const user,
+                     const std::string_view help);
+
+/**
+ * @brief Requires a login checked against an application backend
+ * (instead of the "auth" setting), set before srv_start(); builds without
+ * the login stage (policy.hpp) refuse every session then.
+ *
+ * @param srv The server.
+ * @param be The backend, NULL - back to the setting.
+ */
+void srv_auth(struct srv *const srv, const struct auth_backend *const be);
+
+/**
+ * @brief Removes a command.
+ *
+ * @return int 0 on success, or -1 if the command is unknown.
+ */
+int srv_cmd_unregister(struct srv *const srv, const std::string_view name);
+
+/**
+ * @brief Starts a new session over an already connected transport.
+ *
+ * The server takes ownership of the transport.
+ *
+ * @param srv The server (started).
+ * @param t Transport of the client.
+ * @return int 0 on success, or -1 on failure (the transport is destroyed).
+ */
+int srv_attach(struct srv *const srv, struct trns *const t);
+
+/**
+ * @brief Opens an in-memory loopback session.
+ *
+ * The returned transport is the client end: bytes sent on it are parsed
+ * by a new session, and the session output can be received from it.
+ * The caller destroys it with trns_destroy(). Not available with the
+ * trns_static transport policy (the minimal profile).
+ *
+ * @param srv The server (started).
+ * @return struct trns* Client end on success, or NULL on failure (always
+ * with trns_static, errno ENOTSUP).
+ */
+struct trns *srv_connect_loopback(struct srv *const srv);
+
+/**
+ * @brief Returns the number of live sessions.
+ */
+size_t srv_session_count(struct srv *const srv);
+
+/**
+ * @brief Returns the session limit: the sessions_max setting, or the
+ * planned one.
+ *
+ * @param srv The server (started).
+ * @return unsigned Most sessions at a time.
+ */
+unsigned srv_sessions_max(struct srv *const srv);
+
+/**
+ * @brief Returns a metric counter summed over all reactors.
+ *
+ * @param srv The server.
+ * @param id Counter.
+ * @return uint64_t Value (always 0 with the mtrc_none policy).
+ */
+uint64_t srv_mtrc(struct srv *const srv, const enum mtrc_id id);
+
+/**
+ * @brief Returns a histogram summed over all reactors.
+ *
+ * @param srv The server.
+ * @param id Histogram.
+ * @param buckets Receives MTRC_H_BUCKETS counts (all 0 with mtrc_none).
+ */
+void srv_mtrc_hist(struct srv *const srv, const enum mtrc_hist_id id,
+                   uint64_t *const buckets);
+
+/**
+ * @brief Accepts all pending clients of the listener (reactor 0 only).
+ *
+ * @param srv The server.
+ */
+void srv_accept(struct srv *const srv);
+
+/**
+ * @brief Accepts pending clients of the admin listener into its free
+ * session slots (admin reactor only), the listener rests while the
+ * slots are in use.
+ *
+ * @param srv The server.
+ */
+void srv_accept_admin(struct srv *const srv);
+
+/**
+ * @brief Executes an entered line on behalf of a session.
+ *
+ * Lines of a pending "batch <<TAG" block are collected instead.
+ * Calls on_command and then the registered command handler.
+ *
+ * @param srv The server.
+ * @param s The calling session.
+ * @param line The input line.
+ * @param out Receives the command output.
+ * @param src Receives the lazy rest of the output (see cmd_call::src),
+ * NULL - all of it goes to out.
+ * @return int Handler result (see cmd_handler).
+ */
+int srv_exec(struct srv *const srv, struct sess *const s,
+             const std::string_view line, std::string *const out,
+             struct pgr_src **const src);
+
+/**
+ * @brief Executes an already split command (script steps).
+ *
+ * Calls on_command and then the registered command handler.
+ *
+ * @param srv The server.
+ * @param call Call context (sess, argv and out set).
+ * @param line The command line.
+ * @return int Handler result (see cmd_handler).
+ */
+int srv_exec_call(struct srv *const srv, struct cmd_call *const call,
+                  const std::string_view line);
+
+#endif /* SRV_HPP */
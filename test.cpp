@@ -0,0 +1,626 @@
+/**
+ * @file test.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Functional tests (ctest): sessions over the in-memory loopback,
+ * output encoding, JSON strings, mailboxes, RPC and channel framing.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include "srv.hpp"
+#include "trns.hpp"
+#include "enc.hpp"
+#include "rec.hpp"
+#include "mbox.hpp"
+#include "rpc.hpp"
+#include "mux.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief Mailbox message of the ordering test.
+ */
+struct test_msg : public mbox_msg {
+    unsigned producer; /**< Posting thread */
+    unsigned seq; /**< Position in the posts of that thread */
+};
+
+/**
+ * @brief A frame received from the server (RPC response or channel frame).
+ */
+struct test_frame {
+    uint32_t id; /**< Request id or channel */
+    uint32_t kind; /**< RPC status or channel frame type */
+    std::string payload; /**< Output */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Counts a check, reports it when it fails.
+ *
+ * @param ok Result of the check.
+ * @param name What was checked.
+ * @param got What was seen (shown escaped on failure).
+ */
+static void test_check(const bool ok, const std::string_view name,
+                       const std::string_view got);
+
+/**
+ * @brief Escapes control and non-ASCII bytes for a failure report.
+ */
+static std::string test_show(const std::string_view data);
+
+/**
+ * @brief Reads from a client end until the output ends with a suffix,
+ * the peer closes or the time is up.
+ *
+ * @param t Client end (non-blocking).
+ * @param got Receives the bytes.
+ * @param until Wanted suffix, empty - read until the peer closes.
+ * @param ms Timeout.
+ * @return int 0 - suffix seen, 1 - closed by the peer, -1 - timeout.
+ */
+static int test_read(struct trns *const t, std::string *const got,
+                     const std::string_view until, const int ms);
+
+/**
+ * @brief Sends bytes in pieces of a given size (frames and lines split
+ * across reads of the server).
+ *
+ * @param t Client end.
+ * @param data Bytes.
+ * @param piece Bytes per send.
+ * @return int 0 on success, or -1 on failure.
+ */
+static int test_send(struct trns *const t, const std::string_view data,
+                     const size_t piece);
+
+/**
+ * @brief Opens a loopback session and reads its first prompt.
+ *
+ * @param srv The server.
+ * @return struct trns* Client end (non-blocking), or NULL on failure.
+ */
+static struct trns *test_connect(struct srv *const srv);
+
+/**
+ * @brief Appends a big endian u32.
+ */
+static void test_put32(std::string *const out, const uint32_t v);
+
+/**
+ * @brief Reads a big endian u32.
+ */
+static uint32_t test_get32(const char *const p);
+
+/**
+ * @brief Parser: echo, line edits, Telnet commands inside a line,
+ * commands and the close on Ctrl + D.
+ */
+static void test_parser(struct srv *const srv);
+
+/**
+ * @brief Output encoding against a byte by byte reference, fed in pieces
+ * of every size so that "\r" | "\n" and 0xFF meet chunk and call
+ * boundaries.
+ */
+static void test_enc();
+
+/**
+ * @brief JSON strings: escapes and invalid UTF-8 (U+FFFD per byte).
+ */
+static void test_rec();
+
+/**
+ * @brief Mailbox: posting order of every producer survives concurrent
+ * posts, no message is lost.
+ */
+static void test_mbox();
+
+/**
+ * @brief RPC: mode switch and request frames split across reads, several
+ * in one read.
+ */
+static void test_rpc(struct srv *const srv);
+
+/**
+ * @brief Channels: frames split across reads, two channels interleaved,
+ * a channel closed by its session.
+ */
+static void test_mux(struct srv *const srv);
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+static constexpr int TEST_WAIT_MS = 5000; /**< Longest wait for output */
+static unsigned test_checks = 0; /**< Checks run */
+static unsigned test_failed = 0; /**< Checks failed */
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int main() {
+    /* Variables */
+    struct srv_config srvcfg = {};
+    struct srv *srv;
+    /* Unit parts */
+    log_set_level(LOG_ERROR);
+    test_enc();
+    test_rec();
+    test_mbox();
+    /* Sessions of an embedded server (no listener) */
+    srvcfg.port = 0;
+    srvcfg.lqueue = 5;
+    srv = srv_create(&srvcfg, NULL);
+    if ((srv == NULL) || (srv_start(srv) < 0)) {
+        std::cout << "Error: server start" << std::endl;
+        return 1;
+    }
+    if constexpr (tlnt_policy::trns::dynamic) {
+        test_parser(srv);
+    } else {
+        errno = 0;
+        test_check((srv_connect_loopback(srv) == NULL) && (errno == ENOTSUP),
+                   "loopback refused with trns_static", "");
+    }
+    if constexpr (tlnt_policy::feat::rpc) {
+        test_rpc(srv);
+    }
+    if constexpr (tlnt_policy::feat::mux) {
+        test_mux(srv);
+    }
+    srv_stop(srv);
+    srv_destroy(srv);
+    /* Report */
+    std::cout << "checks=" << test_checks << " failed=" << test_failed
+              << std::endl;
+    std::cout << ((test_failed > 0) ? "FAIL" : "PASS") << std::endl;
+    return (test_failed > 0) ? 1 : 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void test_check(const bool ok, const std::string_view name,
+                       const std::string_view got) {
+    ++test_checks;
+    if (!ok) {
+        ++test_failed;
+        std::cout << "FAIL " << name << ": " << test_show(got) << std::endl;
+    }
+}
+
+static std::string test_show(const std::string_view data) {
+    /* Variables */
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    /* Printable as they are, the rest as \xNN */
+    for (const char ch : data) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if ((c >= 0x20) && (c < 0x7f) && (c != '\\')) {
+            out.push_back(ch);
+        } else {
+            out.append("\\x").push_back(hex[c >> 4]);
+            out.push_back(hex[c & 0xf]);
+        }
+    }
+    return out;
+}
+
+static int test_read(struct trns *const t, std::string *const got,
+                     const std::string_view until, const int ms) {
+    /* Variables */
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(ms);
+    struct pollfd pfd = { .fd = t->fd, .events = POLLIN, .revents = 0 };
+    char buf[4096];
+    ssize_t n;
+    /* Until the suffix, EOF or the deadline */
+    while (until.empty() || !got->ends_with(until)) {
+        n = trns_recv(t, buf, sizeof(buf));
+        if (n == 0) {
+            return 1;
+        }
+        if (n > 0) {
+            got->append(buf, n);
+            continue;
+        }
+        if (errno != EAGAIN) {
+            return 1;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            return (-1);
+        }
+        poll(&pfd, 1, 50);
+    }
+    return 0;
+}
+
+static int test_send(struct trns *const t, const std::string_view data,
+                     const size_t piece) {
+    /* Variables */
+    size_t n;
+    /* One read of the server per piece (the reactor drains in between) */
+    for (size_t pos = 0; pos < data.size(); pos += n) {
+        n = std::min(piece, data.size() - pos);
+        if (trns_send(t, data.data() + pos, n) != static_cast<ssize_t>(n)) {
+            return (-1);
+        }
+        if (n < data.size()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    return 0;
+}
+
+static struct trns *test_connect(struct srv *const srv) {
+    /* Variables */
+    struct trns *t = srv_connect_loopback(srv);
+    std::string got;
+    /* The session greets with the prompt */
+    if (t == NULL) {
+        return NULL;
+    }
+    if ((trns_nonblock(t) < 0) ||
+        (test_read(t, &got, "> ", TEST_WAIT_MS) != 0) || (got != "> ")) {
+        trns_destroy(t);
+        return NULL;
+    }
+    return t;
+}
+
+static void test_put32(std::string *const out, const uint32_t v) {
+    out->push_back(static_cast<char>(v >> 24));
+    out->push_back(static_cast<char>(v >> 16));
+    out->push_back(static_cast<char>(v >> 8));
+    out->push_back(static_cast<char>(v));
+}
+
+static uint32_t test_get32(const char *const p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) |
+           (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+static void test_parser(struct srv *const srv) {
+    /* Variables */
+    static const struct {
+        const char *name;
+        std::string_view in;
+        size_t piece;
+        std::string_view out;
+    } cases[] = {
+        { "command", "Pinata\r\n", 64, "Pinata\r\nTequila! \r\n> " },
+        { "command split", "Pinata\r\n", 1, "Pinata\r\nTequila! \r\n> " },
+        { "command after CR NUL", "Pinata\r\0", 64,
+          "Pinata\r\nTequila! \r\n> " },
+        { "backspace", "ab\x7f" "c\r\n", 1,
+          "ab\b \bc\r\nReceived command: ac\r\n> " },
+        { "IAC NOP inside a line", "Pi\xff\xf1nata\r\n", 3,
+          "Pinata\r\nTequila! \r\n> " },
+        { "unknown command", "nope\r\n", 2,
+          "nope\r\nReceived command: nope\r\n> " },
+        { "empty line", "\r\n", 1, "\r\n> " }
+    };
+    struct trns *t = test_connect(srv);
+    std::string got;
+    /* Echo and output of each line */
+    test_check(t != NULL, "parser: connect and prompt", "");
+    if (t == NULL) {
+        return;
+    }
+    for (const auto &c : cases) {
+        got.clear();
+        if ((test_send(t, c.in, c.piece) < 0) ||
+            (test_read(t, &got, "> ", TEST_WAIT_MS) != 0)) {
+            test_check(false, std::string("parser: ") + c.name, got);
+            continue;
+        }
+        test_check(got == c.out, std::string("parser: ") + c.name, got);
+    }
+    /* Registered commands are listed */
+    got.clear();
+    test_check((test_send(t, "help\r\n", 64) == 0) &&
+               (test_read(t, &got, "> ", TEST_WAIT_MS) == 0) &&
+               (got.find("Pinata") != std::string::npos) &&
+               (got.find("format") != std::string::npos),
+               "parser: help", got);
+    /* Ctrl + D closes the session */
+    got.clear();
+    test_check((test_send(t, "\x04", 1) == 0) &&
+               (test_read(t, &got, "", TEST_WAIT_MS) == 1),
+               "parser: Ctrl + D closes", got);
+    trns_destroy(t);
+}
+
+static void test_enc() {
+    /* Variables */
+    static const unsigned flagsets[] = { ENC_CRLF, ENC_CRLF | ENC_IAC };
+    oq_arena a;
+    std::string in;
+    std::string want;
+    std::string got;
+    struct oq q;
+    bool ok;
+    char prev;
+    /* Lines, lone "\n", "\r\n", 0xFF runs, across several chunks; a "\r"
+     * as the last byte of a full chunk */
+    for (size_t i = 0; i < 3 * OQ_CHUNK_SIZE; ++i) {
+        in.push_back(((i % 97) == 0) ? '\n' : ((i % 89) == 0) ? '\xff' :
+                     ((i % 61) == 0) ? '\r' : static_cast<char>('a' + i % 26));
+    }
+    in.append("\r\n\xff\xff\n\n\r\r\n");
+    tlnt_policy::alloc::init(&a, sizeof(struct oq_chunk));
+    for (const unsigned flags : flagsets) {
+        /* Reference: byte by byte */
+        want.clear();
+        prev = 0;
+        for (const char c : in) {
+            if ((c == '\n') && (prev != '\r')) {
+                want.push_back('\r');
+            }
+            if ((c == '\xff') && ((flags & ENC_IAC) != 0)) {
+                want.push_back('\xff');
+            }
+            want.push_back(c);
+            prev = c;
+        }
+        /* Every piece size from 1 to 17, then one call */
+        for (size_t piece = 1; piece <= 18; ++piece) {
+            const size_t step = (piece == 18) ? in.size() : piece;
+            ok = true;
+            for (size_t pos = 0; ok && (pos < in.size()); pos += step) {
+                ok = enc_append(&q, &a, in.data() + pos,
+                                std::min(step, in.size() - pos), flags) == 0;
+            }
+            got.clear();
+            for (const struct oq_chunk *c = q.head; c != NULL; c = c->next) {
+                got.append(c->data + c->rd, c->wr - c->rd);
+            }
+            test_check(ok && (got == want) && (q.bytes == want.size()),
+                       "enc: flags " + std::to_string(flags) + " pieces of " +
+                       std::to_string(step), got.substr(0, 64));
+            oq_clear(&q, &a);
+        }
+    }
+    /* "\r" last in a full chunk, its "\n" in the next call */
+    in.assign(sizeof(oq_chunk::data) - 1, 'x');
+    in.push_back('\r');
+    ok = (enc_append(&q, &a, in.data(), in.size(), ENC_CRLF) == 0) &&
+         (enc_append(&q, &a, "\nz", 2, ENC_CRLF) == 0);
+    got.clear();
+    for (const struct oq_chunk *c = q.head; c != NULL; c = c->next) {
+        got.append(c->data + c->rd, c->wr - c->rd);
+    }
+    test_check(ok && (q.head != q.tail) && (got == in + "\nz"),
+               "enc: CR at the end of a chunk", got.substr(in.size() - 2));
+    oq_clear(&q, &a);
+    tlnt_policy::alloc::fini(&a);
+}
+
+static void test_rec() {
+    /* Variables */
+    static const struct {
+        const char *name;
+        std::string_view in;
+        std::string_view out;
+    } cases[] = {
+        { "plain", "ok", "\"ok\"" },
+        { "escapes", "a\"b\\c\n\r\t\x01", "\"a\\\"b\\\\c\\n\\r\\t\\u0001\"" },
+        { "valid 2, 3 and 4 bytes", "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80",
+          "\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\"" },
+        { "lone 0xFF", "\xff", "\"\\ufffd\"" },
+        { "lone continuation", "a\x80z", "\"a\\ufffdz\"" },
+        { "truncated at the end", "a\xe2\x82", "\"a\\ufffd\\ufffd\"" },
+        { "overlong", "\xc0\xaf", "\"\\ufffd\\ufffd\"" },
+        { "overlong 3 bytes", "\xe0\x80\xaf", "\"\\ufffd\\ufffd\\ufffd\"" },
+        { "surrogate", "\xed\xa0\x80", "\"\\ufffd\\ufffd\\ufffd\"" },
+        { "over U+10FFFF", "\xf4\x90\x80\x80",
+          "\"\\ufffd\\ufffd\\ufffd\\ufffd\"" },
+        { "after 16 bytes", "0123456789abcdef\x80\"\x01",
+          "\"0123456789abcdef\\ufffd\\\"\\u0001\"" },
+        { "valid across 16 bytes", "aaaaaaaaaaaaaa\xf0\x9f\x98\x80z",
+          "\"aaaaaaaaaaaaaa\xf0\x9f\x98\x80z\"" }
+    };
+    std::string got;
+    /* One string per case */
+    for (const auto &c : cases) {
+        got.clear();
+        rec_json_str(&got, c.in);
+        test_check(got == c.out, std::string("rec: ") + c.name, got);
+    }
+}
+
+static void test_mbox() {
+    /* Variables */
+    constexpr unsigned PRODUCERS = 4;
+    constexpr unsigned MSGS = 100000;
+    std::vector<struct test_msg> msgs(PRODUCERS * MSGS);
+    std::vector<unsigned> next(PRODUCERS, 0);
+    std::vector<std::thread> threads;
+    struct mbox m;
+    struct test_msg *msg;
+    size_t taken = 0;
+    bool ordered = true;
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::seconds(30);
+    /* Producers post their own messages in order */
+    mbox_init(&m);
+    for (unsigned p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&m, &msgs, p] {
+            for (unsigned i = 0; i < MSGS; ++i) {
+                struct test_msg *x = &msgs[(p * MSGS) + i];
+                x->producer = p;
+                x->seq = i;
+                mbox_push(&m, x);
+            }
+        });
+    }
+    /* One consumer: every message once, each producer in order */
+    while ((taken < msgs.size()) &&
+           (std::chrono::steady_clock::now() < deadline)) {
+        mbox_arm(&m);
+        while ((msg = static_cast<struct test_msg *>(mbox_pop(&m))) != NULL) {
+            ordered = ordered && (msg->seq == next[msg->producer]);
+            ++next[msg->producer];
+            ++taken;
+        }
+        std::this_thread::yield();
+    }
+    for (std::thread &th : threads) {
+        th.join();
+    }
+    test_check(ordered, "mbox: order of each producer", "");
+    test_check(taken == msgs.size(), "mbox: every message taken",
+               std::to_string(taken));
+    test_check(mbox_pop(&m) == NULL, "mbox: empty after the last", "");
+}
+
+static void test_rpc(struct srv *const srv) {
+    /* Variables */
+    static const char *const lines[] = { "Pinata", "nope", "help" };
+    struct trns *t = test_connect(srv);
+    std::vector<struct test_frame> rsp;
+    std::string req;
+    std::string got;
+    size_t pos = 0;
+    uint32_t len;
+    std::chrono::steady_clock::time_point deadline;
+    /* Mode switch, the magic split */
+    test_check(t != NULL, "rpc: connect", "");
+    if (t == NULL) {
+        return;
+    }
+    test_check((test_send(t, RPC_MAGIC, 3) == 0) &&
+               (test_read(t, &got, RPC_MAGIC, TEST_WAIT_MS) == 0) &&
+               (got == RPC_MAGIC), "rpc: magic answered", got);
+    /* Three requests: the first a byte per read, the rest in one */
+    for (uint32_t id = 0; id < 3; ++id) {
+        test_put32(&req, static_cast<uint32_t>(strlen(lines[id])));
+        test_put32(&req, 100 + id);
+        req.append(lines[id]);
+    }
+    got.clear();
+    if ((test_send(t, std::string_view(req).substr(0, 14), 1) < 0) ||
+        (test_send(t, std::string_view(req).substr(14), req.size()) < 0)) {
+        test_check(false, "rpc: send", "");
+    }
+    /* Responses in any order, frames cut wherever the reads end */
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::milliseconds(TEST_WAIT_MS);
+    while (rsp.size() < 3) {
+        if ((got.size() - pos) >= RPC_RSP_HDR) {
+            len = test_get32(got.data() + pos);
+            if ((got.size() - pos - RPC_RSP_HDR) >= len) {
+                rsp.push_back({ test_get32(got.data() + pos + 4),
+                                test_get32(got.data() + pos + 8),
+                                got.substr(pos + RPC_RSP_HDR, len) });
+                pos += RPC_RSP_HDR + len;
+                continue;
+            }
+        }
+        if ((std::chrono::steady_clock::now() > deadline) ||
+            (test_read(t, &got, "", 50) == 1)) {
+            break;
+        }
+    }
+    test_check(rsp.size() == 3, "rpc: three responses", got);
+    for (const struct test_frame &f : rsp) {
+        const bool ok = (f.id == 100) ?
+                (f.kind == 0) &&
+                (f.payload.find("Tequila") != std::string::npos) :
+            (f.id == 101) ?
+                (f.payload.find("Received command: nope") !=
+                 std::string::npos) :
+            (f.id == 102) &&
+                (f.payload.find("Pinata") != std::string::npos);
+        test_check(ok, "rpc: response " + std::to_string(f.id), f.payload);
+    }
+    trns_destroy(t);
+}
+
+static void test_mux(struct srv *const srv) {
+    /* Variables */
+    struct trns *t = test_connect(srv);
+    std::string frames;
+    std::string got;
+    std::string out[2];
+    bool closed = false;
+    size_t pos = 0;
+    uint32_t id;
+    uint32_t len;
+    uint8_t type;
+    const auto frame = [&frames](const uint32_t chan, const uint8_t kind,
+                                 const std::string_view payload) {
+        test_put32(&frames, chan);
+        frames.push_back(static_cast<char>(kind));
+        test_put32(&frames, static_cast<uint32_t>(payload.size()));
+        frames.append(payload);
+    };
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(TEST_WAIT_MS);
+    /* Mode switch */
+    test_check(t != NULL, "mux: connect", "");
+    if (t == NULL) {
+        return;
+    }
+    test_check((test_send(t, MUX_MAGIC, 5) == 0) &&
+               (test_read(t, &got, MUX_MAGIC, TEST_WAIT_MS) == 0) &&
+               (got == MUX_MAGIC), "mux: magic answered", got);
+    /* Two channels interleaved, headers cut in the middle; channel 9
+     * ends its session with Ctrl + D */
+    frame(7, MUX_OPEN, "");
+    frame(9, MUX_OPEN, "");
+    frame(7, MUX_DATA, "Pin");
+    frame(9, MUX_DATA, "help\r\n");
+    frame(7, MUX_DATA, "ata\r\n");
+    frame(9, MUX_DATA, "\x04");
+    got.clear();
+    test_check(test_send(t, frames, 5) == 0, "mux: send", "");
+    /* Output per channel until both are complete */
+    while ((!out[0].ends_with("Tequila! \r\n> ") || !closed) &&
+           (std::chrono::steady_clock::now() < deadline)) {
+        if ((got.size() - pos) >= MUX_HDR) {
+            id = test_get32(got.data() + pos);
+            type = static_cast<uint8_t>(got[pos + 4]);
+            len = test_get32(got.data() + pos + 5);
+            if ((got.size() - pos - MUX_HDR) >= len) {
+                if ((type == MUX_DATA) && ((id == 7) || (id == 9))) {
+                    out[(id == 7) ? 0 : 1].append(got, pos + MUX_HDR, len);
+                }
+                closed = closed || ((type == MUX_CLOSE) && (id == 9));
+                pos += MUX_HDR + len;
+                continue;
+            }
+        }
+        if (test_read(t, &got, "", 50) == 1) {
+            break;
+        }
+    }
+    test_check(out[0] == "> Pinata\r\nTequila! \r\n> ", "mux: channel 7",
+               out[0]);
+    test_check((out[1].find("Pinata") != std::string::npos) &&
+               out[1].starts_with("> help\r\n"), "mux: channel 9", out[1]);
+    test_check(closed, "mux: channel 9 closed", "");
+    trns_destroy(t);
+}
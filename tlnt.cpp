@@ -13,10 +13,24 @@
 //==============================================================================
 // Includes
 //==============================================================================
-#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include "tlnt.hpp"
+#include "policy.hpp"
+
+//==============================================================================
+// Definitions
+//==============================================================================
+constexpr int TLNT_LISTEN_FDS_START = 3; /**< First passed socket */
 
 //==============================================================================
 // Static Function Declarations
@@ -31,24 +45,26 @@
  * @param srvsocket The socket file descriptor to bind.
  * @param family The address family (e.g., AF_INET for IPv4).
  * @param port The port number (not network byte order (use htons)).
+ * @param ip The local address (host byte order).
  *
  * @return int Returns >0 on successful bind, -1 on failure.
  */
 static int tlnt_bind_srv(const int srvsocket,
                          const sa_family_t family,
-                         const in_port_t port);
+                         const in_port_t port,
+                         const in_addr_t ip);
 
 //==============================================================================
 // Global Function Definitions
 //==============================================================================
-int tlnt_init_srv(const in_port_t port, int lqueue) {
+int tlnt_init_srv(const in_port_t port, int lqueue, const in_addr_t addr) {
     /* Assertion */
     if (port < 1) {
-        std::cout << "Error: port 0 is invalid for server socket" << std::endl;
+        log_error("Error: port 0 is invalid for server socket");
         return (-1);
     }
     if (lqueue < 1) {
-        std::cout << "Error: lqueue must be more than 1" << std::endl;
+        log_error("Error: lqueue must be more than 1");
         return (-1);
     }
     /* Variables */
@@ -56,19 +72,19 @@ int tlnt_init_srv(const in_port_t port, int lqueue) {
     /* Init Server Socket */
     srvsocket = socket(AF_INET, SOCK_STREAM, 0);
     if (srvsocket < 0) {
-        std::cout << "Error: get server socket" << std::endl;
+        log_error("Error: get server socket");
         return (-1);
     }
-    if (tlnt_bind_srv(srvsocket, AF_INET, port) < 0) {
-        std::cout << "Error: bind addr to srvsocket" << std::endl;
+    if (tlnt_bind_srv(srvsocket, AF_INET, port, addr) < 0) {
+        log_fatal("Error: bind port ", port, ": ", strerror(errno));
         goto tlnt_init_srv_close_srv;
     }
     if (listen(srvsocket, lqueue) < 0) {
-        std::cout << "Error: init listen srvsocket" << std::endl;
+        log_fatal("Error: listen on port ", port, ": ", strerror(errno));
         goto tlnt_init_srv_close_srv;
     }
     /* Success */
-    std::cout << "Telnet Server started on port " << port << std::endl;
+    log_info("Telnet Server started on port ", port);
     return srvsocket;
 
 tlnt_init_srv_close_srv:
@@ -77,10 +93,60 @@ tlnt_init_srv_close_srv:
     return (-1);
 }
 
+int tlnt_init_srv(const char *const path, int lqueue) {
+    /* Assertion */
+    if ((path == NULL) || (strlen(path) >= sizeof(sockaddr_un::sun_path))) {
+        log_error("Error: wrong socket path");
+        return (-1);
+    }
+    if (lqueue < 1) {
+        log_error("Error: lqueue must be more than 1");
+        return (-1);
+    }
+    /* Variables */
+    int srvsocket; /**< Server socket (listening) */
+    struct sockaddr_un addr{}; /**< Socket address, local */
+    struct stat st; /**< Stale socket file */
+    mode_t old; /**< File mode mask of the process */
+    int rc;
+    /* Init Server Socket */
+    srvsocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (srvsocket < 0) {
+        log_error("Error: get server socket");
+        return (-1);
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if ((lstat(path, &st) == 0) && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+    old = umask(S_IRWXG | S_IRWXO | S_IXUSR); /* 0600 from the start */
+    rc = bind(srvsocket, (sockaddr *)&addr, sizeof(addr));
+    umask(old);
+    if (rc < 0) {
+        log_fatal("Error: bind ", path, ": ", strerror(errno));
+        goto tlnt_init_srv_close_unix;
+    }
+    if ((chmod(path, S_IRUSR | S_IWUSR) < 0) ||
+        (listen(srvsocket, lqueue) < 0)) {
+        log_fatal("Error: listen on ", path, ": ", strerror(errno));
+        goto tlnt_init_srv_unlink;
+    }
+    /* Success */
+    log_info("Telnet Server started on ", path);
+    return srvsocket;
+
+tlnt_init_srv_unlink:
+    unlink(path);
+tlnt_init_srv_close_unix:
+    close(srvsocket);
+    return (-1);
+}
+
 int tlnt_accept_clnt(int srvsocket) {
     /* Assertion */
     if (srvsocket < 0) {
-        std::cout << "Error: wrong socket value" << std::endl;
+        log_error("Error: wrong socket value");
         return (-1);
     }
     /* Variables */
@@ -91,19 +157,92 @@ int tlnt_accept_clnt(int srvsocket) {
     return (accept(srvsocket, (sockaddr *)&client_addr, &client_size));
 }
 
+int tlnt_tcp_stat(const int socket, struct tlnt_tcp_stat *const stat) {
+    /* Variables */
+    struct tcp_info info{};
+    socklen_t size = sizeof(info);
+    /* Sample */
+    if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &size) < 0) {
+        return (-1);
+    }
+    stat->rtt = info.tcpi_rtt;
+    stat->rttvar = info.tcpi_rttvar;
+    stat->retrans = info.tcpi_total_retrans;
+    stat->cwnd = info.tcpi_snd_cwnd;
+    stat->unacked = info.tcpi_unacked * info.tcpi_snd_mss;
+    stat->ack_age = info.tcpi_last_ack_recv;
+    return 0;
+}
+
+int tlnt_listen_fds() {
+    /* Variables */
+    const char *pid = getenv("LISTEN_PID");
+    const char *fds = getenv("LISTEN_FDS");
+    long npid;
+    long nfds;
+    int type = 0;
+    int accepting = 0;
+    socklen_t len = sizeof(int);
+    /* Passed to this process? */
+    if ((pid == NULL) || (fds == NULL)) {
+        return (-1);
+    }
+    npid = strtol(pid, NULL, 10);
+    nfds = strtol(fds, NULL, 10);
+    unsetenv("LISTEN_PID");
+    unsetenv("LISTEN_FDS");
+    unsetenv("LISTEN_FDNAMES");
+    if ((npid != static_cast<long>(getpid())) || (nfds < 1)) {
+        return (-1);
+    }
+    for (long i = 1; i < nfds; ++i) {
+        log_error("Error: passed socket ", TLNT_LISTEN_FDS_START + i,
+                  " is not used");
+        close(static_cast<int>(TLNT_LISTEN_FDS_START + i));
+    }
+    /* A listening stream socket */
+    if ((getsockopt(TLNT_LISTEN_FDS_START, SOL_SOCKET, SO_TYPE, &type,
+                    &len) < 0) || (type != SOCK_STREAM) ||
+        (getsockopt(TLNT_LISTEN_FDS_START, SOL_SOCKET, SO_ACCEPTCONN,
+                    &accepting, &len) < 0) || (accepting == 0)) {
+        log_error("Error: passed fd ", TLNT_LISTEN_FDS_START,
+                  " is not a listening stream socket");
+        return (-1);
+    }
+    fcntl(TLNT_LISTEN_FDS_START, F_SETFD, FD_CLOEXEC);
+    log_info("Telnet Server inherited listener fd ", TLNT_LISTEN_FDS_START);
+    return TLNT_LISTEN_FDS_START;
+}
+
+int tlnt_peer_name(const int socket, char *const buf, const size_t size) {
+    /* Variables */
+    sockaddr_in addr{}; /**< Socket address, internet style */
+    socklen_t addr_size = sizeof(addr);
+    char ip[INET_ADDRSTRLEN];
+    /* Peer */
+    if ((getpeername(socket, (sockaddr *)&addr, &addr_size) < 0) ||
+        (addr.sin_family != AF_INET) ||
+        (inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip)) == NULL)) {
+        return (-1);
+    }
+    snprintf(buf, size, "%s:%u", ip, ntohs(addr.sin_port));
+    return 0;
+}
+
 //==============================================================================
 // Static Function Definitions
 //==============================================================================
 static int tlnt_bind_srv(const int srvsocket,
                          const sa_family_t family,
-                         const in_port_t port) {
+                         const in_port_t port,
+                         const in_addr_t ip) {
     /* Assertion */
     if (srvsocket < 0) {
-        std::cout << "Error: wrong socket value" << std::endl;
+        log_error("Error: wrong socket value");
         return (-1);
     }
     if (port < 1) {
-        std::cout << "Error: port 0 is invalid for server socket" << std::endl;
+        log_error("Error: port 0 is invalid for server socket");
         return (-1);
     }
     /* Variables */
@@ -111,7 +250,7 @@ static int tlnt_bind_srv(const int srvsocket,
     int opt = 1;
     /* Init Sockaddr */
     addr.sin_family = family;
-    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_addr.s_addr = htonl(ip);
     addr.sin_port = htons(port);
     /* Bind */
     setsockopt(srvsocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
@@ -16,8 +16,40 @@
 //=============================================================================
 // Includes
 //=============================================================================
+#include <cstddef>
+#include <cstdint>
 #include <netinet/in.h>
 
+//=============================================================================
+// Definitions
+//=============================================================================
+/* Telnet commands (RFC 854) and options */
+constexpr unsigned char TLNT_IAC = 255; /**< Interpret as command */
+constexpr unsigned char TLNT_DONT = 254;
+constexpr unsigned char TLNT_DO = 253;
+constexpr unsigned char TLNT_WONT = 252;
+constexpr unsigned char TLNT_WILL = 251;
+constexpr unsigned char TLNT_SB = 250; /**< Subnegotiation begin */
+constexpr unsigned char TLNT_SE = 240; /**< Subnegotiation end */
+constexpr unsigned char TLNT_NOP = 241; /**< No operation */
+constexpr unsigned char TLNT_IP = 244; /**< Interrupt process */
+constexpr unsigned char TLNT_OPT_NAWS = 31; /**< Window size (RFC 1073) */
+
+//=============================================================================
+// Structures
+//=============================================================================
+/**
+ * @brief Network health of a TCP connection (a TCP_INFO sample).
+ */
+struct tlnt_tcp_stat {
+    uint32_t rtt; /**< Smoothed round trip time, us */
+    uint32_t rttvar; /**< Round trip time variance, us */
+    uint32_t retrans; /**< Retransmitted segments since connect */
+    uint32_t cwnd; /**< Congestion window, segments */
+    uint32_t unacked; /**< Sent, not yet acknowledged bytes */
+    uint32_t ack_age; /**< Time since the last ACK received, ms */
+};
+
 //=============================================================================
 // Global Function Declarations
 //=============================================================================
@@ -25,14 +57,41 @@
  * @brief Initializes a TCP socket for the Telnet server
  *
  * This function creates a socket using the IPv4 address family (AF_INET),
- * binds it to the specified port on all available interfaces (INADDR_ANY),
- * and puts it into a listening state with a specified listen queue size.
+ * binds it to the specified port on the given interface (INADDR_ANY for
+ * all of them), and puts it into a listening state with a specified
+ * listen queue size.
  *
  * @param port The port number on which the Telnet server will listen.
  * @param lqueue The maximum number of pending connections (backlog).
+ * @param addr Local address (host byte order, e.g. INADDR_LOOPBACK).
+ * @return int Socket on success, or -1 on failure.
+ */
+int tlnt_init_srv(const in_port_t port, int lqueue, const in_addr_t addr);
+
+/**
+ * @brief Initializes a UNIX domain socket for the Telnet server
+ *
+ * A stale socket file left at the path is replaced, the new one is
+ * accessible to the owner only (access is the file permission).
+ *
+ * @param path Path of the socket file.
+ * @param lqueue The maximum number of pending connections (backlog).
  * @return int Socket on success, or -1 on failure.
  */
-int tlnt_init_srv(const in_port_t port, int lqueue);
+int tlnt_init_srv(const char *const path, int lqueue);
+
+/**
+ * @brief Takes a listening socket passed by the parent process
+ * (socket activation: LISTEN_PID/LISTEN_FDS, the first socket is fd 3).
+ *
+ * The variables are removed from the environment, so children of the
+ * server do not see them. Only the first passed socket is used, the
+ * others are closed.
+ *
+ * @return int Listening socket (close-on-exec), or -1 if none was passed
+ * (or it is not a listening stream socket).
+ */
+int tlnt_listen_fds();
 
 /**
  * @brief Accepts a new client connection from the listening Telnet server socket.
@@ -48,4 +107,23 @@ int tlnt_init_srv(const in_port_t port, int lqueue);
  */
 int tlnt_accept_clnt(int srvsocket);
 
+/**
+ * @brief Samples TCP_INFO of a connected socket.
+ *
+ * @param socket Connected TCP socket.
+ * @param stat Receives the sample.
+ * @return int 0 on success, or -1 on failure (not a TCP socket).
+ */
+int tlnt_tcp_stat(const int socket, struct tlnt_tcp_stat *const stat);
+
+/**
+ * @brief Formats the peer address of a connected socket as "ip:port".
+ *
+ * @param socket Connected socket.
+ * @param buf Receives the text (NUL terminated).
+ * @param size Size of buf.
+ * @return int 0 on success, or -1 on failure (not an inet socket).
+ */
+int tlnt_peer_name(const int socket, char *const buf, const size_t size);
+
 #endif /* TLNT_HPP */
@@ -0,0 +1,141 @@
+/**
+ * @file tmr.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Hashed timer wheel of a reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <ctime>
+#include "tmr.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Current tick of the wheel.
+ */
+static uint64_t tmr_tick_now(const struct tmr_wheel *const w);
+
+/**
+ * @brief Unlinks a timer from its slot.
+ */
+static void tmr_unlink(struct tmr *const t);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+uint64_t tmr_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000) +
+           (static_cast<uint64_t>(ts.tv_nsec) / 1000000);
+}
+
+void tmr_wheel_init(struct tmr_wheel *const w) {
+    for (struct tmr &slot : w->slots) {
+        slot.next = &slot;
+        slot.prev = &slot;
+    }
+    w->origin = tmr_now_ms();
+    w->tick = 0;
+    w->count = 0;
+}
+
+void tmr_arm(struct tmr_wheel *const w, struct tmr *const t,
+             const uint64_t delay) {
+    /* Variables */
+    struct tmr *slot;
+    /* Re-arm */
+    tmr_cancel(w, t);
+    t->expires = tmr_tick_now(w) + ((delay + TMR_TICK_MS - 1) / TMR_TICK_MS);
+    if (t->expires <= w->tick) {
+        t->expires = w->tick + 1;
+    }
+    slot = &w->slots[t->expires % TMR_SLOTS];
+    t->next = slot;
+    t->prev = slot->prev;
+    slot->prev->next = t;
+    slot->prev = t;
+    ++w->count;
+}
+
+void tmr_cancel(struct tmr_wheel *const w, struct tmr *const t) {
+    if (!tmr_armed(t)) {
+        return;
+    }
+    tmr_unlink(t);
+    --w->count;
+}
+
+int tmr_timeout(const struct tmr_wheel *const w) {
+    /* Variables */
+    uint64_t next = w->tick + TMR_SLOTS; /* At worst, one turn */
+    uint64_t now;
+    uint64_t at;
+    const struct tmr *slot;
+    const struct tmr *t;
+    /* Nothing armed - sleep until an event */
+    if (w->count == 0) {
+        return (-1);
+    }
+    /* Nearest slot holding a timer of the current turn */
+    for (uint64_t tick = w->tick + 1; tick < next; ++tick) {
+        slot = &w->slots[tick % TMR_SLOTS];
+        for (t = slot->next; t != slot; t = t->next) {
+            if (t->expires <= tick) {
+                next = tick;
+                break;
+            }
+        }
+    }
+    now = tmr_now_ms();
+    at = w->origin + (next * TMR_TICK_MS);
+    return (at > now) ? static_cast<int>(at - now) : 0;
+}
+
+void tmr_advance(struct tmr_wheel *const w) {
+    /* Variables */
+    const uint64_t now = tmr_tick_now(w);
+    struct tmr *slot;
+    struct tmr *t;
+    struct tmr *next;
+    /* Walk the slots passed since the last call */
+    while ((w->tick < now) && (w->count > 0)) {
+        ++w->tick;
+        slot = &w->slots[w->tick % TMR_SLOTS];
+        for (t = slot->next; t != slot; t = next) {
+            next = t->next;
+            if (t->expires > w->tick) {
+                continue; /* Later turn of the wheel */
+            }
+            tmr_unlink(t);
+            --w->count;
+            t->cb(t);
+            /* The callback may have re-armed or freed timers of this slot */
+            next = slot->next;
+        }
+    }
+    w->tick = now;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static uint64_t tmr_tick_now(const struct tmr_wheel *const w) {
+    return (tmr_now_ms() - w->origin) / TMR_TICK_MS;
+}
+
+static void tmr_unlink(struct tmr *const t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->next = NULL;
+    t->prev = NULL;
+}
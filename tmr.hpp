@@ -0,0 +1,114 @@
+/**
+ * @file tmr.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Hashed timer wheel of a reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef TMR_HPP
+#define TMR_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr uint64_t TMR_TICK_MS = 10; /**< Wheel resolution */
+constexpr size_t TMR_SLOTS = 256; /**< Slots (one turn = 2.56 s) */
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct tmr;
+
+/**
+ * @brief Timer callback (runs in the reactor thread, may re-arm).
+ */
+typedef void (*tmr_cb)(struct tmr *const t);
+
+/**
+ * @brief Timer, embedded into the object it belongs to.
+ */
+struct tmr {
+    struct tmr *next = NULL; /**< Slot list (NULL - not armed) */
+    struct tmr *prev = NULL;
+    uint64_t expires = 0; /**< Tick of expiry */
+    tmr_cb cb = NULL; /**< Callback */
+    void *arg = NULL; /**< Callback argument */
+};
+
+/**
+ * @brief Timer wheel, one per reactor (not thread-safe).
+ */
+struct tmr_wheel {
+    struct tmr slots[TMR_SLOTS]; /**< Slot list heads (sentinels) */
+    uint64_t origin; /**< Monotonic ms of tick 0 */
+    uint64_t tick; /**< Last processed tick */
+    size_t count; /**< Armed timers */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Monotonic clock in milliseconds.
+ */
+uint64_t tmr_now_ms();
+
+/**
+ * @brief Initializes a wheel.
+ *
+ * @param w The wheel.
+ */
+void tmr_wheel_init(struct tmr_wheel *const w);
+
+/**
+ * @brief Arms (or re-arms) a timer.
+ *
+ * @param w The wheel.
+ * @param t The timer (cb and arg set).
+ * @param delay Milliseconds from now (rounded up to a tick).
+ */
+void tmr_arm(struct tmr_wheel *const w, struct tmr *const t,
+             const uint64_t delay);
+
+/**
+ * @brief Disarms a timer (no-op if it is not armed).
+ *
+ * @param w The wheel.
+ * @param t The timer.
+ */
+void tmr_cancel(struct tmr_wheel *const w, struct tmr *const t);
+
+/**
+ * @brief Tells whether a timer is armed.
+ */
+static inline bool tmr_armed(const struct tmr *const t) {
+    return t->next != NULL;
+}
+
+/**
+ * @brief Milliseconds the reactor may sleep before the nearest expiry.
+ *
+ * @param w The wheel.
+ * @return int -1 if no timer is armed, otherwise milliseconds (>= 0).
+ */
+int tmr_timeout(const struct tmr_wheel *const w);
+
+/**
+ * @brief Runs the callbacks of all expired timers.
+ *
+ * @param w The wheel.
+ */
+void tmr_advance(struct tmr_wheel *const w);
+
+#endif /* TMR_HPP */
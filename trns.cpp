@@ -0,0 +1,315 @@
+/**
+ * @file trns.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Pluggable session transports (socket, in-memory loopback).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trns.hpp"
+#include "gc.hpp"
+
+//==============================================================================
+// Structures
+//==============================================================================
+/**
+ * @brief One direction of a loopback connection.
+ */
+struct lpbk_chan {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string data; /**< Bytes written but not yet read */
+    bool closed = false; /**< Writer side is gone */
+    int evfd = (-1); /**< Readable while data or EOF is pending */
+};
+
+/**
+ * @brief Both directions of a loopback connection (shared by the ends).
+ */
+struct lpbk_link {
+    struct lpbk_chan chan[2];
+    ~lpbk_link() {
+        for (struct lpbk_chan &c : chan) {
+            if (c.evfd >= 0) {
+                close(c.evfd);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Loopback end: reads from one channel, writes into the other.
+ */
+struct lpbk_trns : public trns {
+    std::shared_ptr<struct lpbk_link> link;
+    struct lpbk_chan *rx;
+    struct lpbk_chan *tx;
+    bool nonblock; /**< recv() returns EAGAIN instead of waiting */
+};
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Socket transport operations (thin recv/send wrappers).
+ */
+static ssize_t trns_sock_recv(struct trns *const t, void *buf,
+                              const size_t len);
+static ssize_t trns_sock_send(struct trns *const t, const void *buf,
+                              const size_t len);
+static void trns_sock_shutdown(struct trns *const t);
+static int trns_sock_nonblock(struct trns *const t);
+static void trns_sock_destroy(struct trns *const t);
+
+/**
+ * @brief Loopback transport operations (in-process queues).
+ */
+static ssize_t trns_lpbk_recv(struct trns *const t, void *buf,
+                              const size_t len);
+static ssize_t trns_lpbk_send(struct trns *const t, const void *buf,
+                              const size_t len);
+static void trns_lpbk_shutdown(struct trns *const t);
+static int trns_lpbk_nonblock(struct trns *const t);
+static void trns_lpbk_destroy(struct trns *const t);
+
+/**
+ * @brief Makes the channel eventfd readable (channel mutex held).
+ *
+ * @param chan The channel.
+ */
+static void trns_lpbk_signal(struct lpbk_chan *const chan);
+
+/**
+ * @brief Marks a loopback channel closed and wakes its reader.
+ *
+ * @param chan The channel to close.
+ */
+static void trns_lpbk_close_chan(struct lpbk_chan *const chan);
+
+//==============================================================================
+// Static Variables
+//==============================================================================
+static const struct trns_ops trns_sock_ops = {
+    .recv = trns_sock_recv,
+    .send = trns_sock_send,
+    .shutdown = trns_sock_shutdown,
+    .nonblock = trns_sock_nonblock,
+    .destroy = trns_sock_destroy,
+    .interest = NULL
+};
+
+static const struct trns_ops trns_lpbk_ops = {
+    .recv = trns_lpbk_recv,
+    .send = trns_lpbk_send,
+    .shutdown = trns_lpbk_shutdown,
+    .nonblock = trns_lpbk_nonblock,
+    .destroy = trns_lpbk_destroy,
+    .interest = NULL
+};
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+struct trns *trns_socket_create(const int socket) {
+    /* Assertion */
+    if (socket < 0) {
+        log_error("Error: wrong socket value");
+        return NULL;
+    }
+    /* Variables */
+    struct trns *t = new (std::nothrow) struct trns;
+    if (t == NULL) {
+        return NULL;
+    }
+    t->ops = &trns_sock_ops;
+    t->fd = socket;
+    gc_register_socket(socket);
+    return t;
+}
+
+int trns_loopback_pair(struct trns **const srvend,
+                       struct trns **const clntend) {
+    /* Assertion */
+    if ((srvend == NULL) || (clntend == NULL)) {
+        log_error("Error: loopback ends == NULL");
+        return (-1);
+    }
+    if constexpr (!tlnt_policy::trns::dynamic) {
+        /* Direct socket calls only: a loopback end has no socket */
+        *srvend = NULL;
+        *clntend = NULL;
+        errno = ENOTSUP;
+        return (-1);
+    }
+    /* Variables */
+    std::shared_ptr<struct lpbk_link> link;
+    struct lpbk_trns *a;
+    struct lpbk_trns *b;
+    /* Allocate */
+    try {
+        link = std::make_shared<struct lpbk_link>();
+        a = new struct lpbk_trns;
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    b = new (std::nothrow) struct lpbk_trns;
+    if (b == NULL) {
+        delete a;
+        return (-1);
+    }
+    for (struct lpbk_chan &c : link->chan) {
+        c.evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (c.evfd < 0) {
+            delete a;
+            delete b;
+            return (-1);
+        }
+    }
+    /* Cross the channels */
+    a->ops = &trns_lpbk_ops;
+    a->link = link;
+    a->rx = &link->chan[0];
+    a->tx = &link->chan[1];
+    a->fd = a->rx->evfd;
+    a->nonblock = false;
+    b->ops = &trns_lpbk_ops;
+    b->link = link;
+    b->rx = &link->chan[1];
+    b->tx = &link->chan[0];
+    b->fd = b->rx->evfd;
+    b->nonblock = false;
+    *srvend = a;
+    *clntend = b;
+    return 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static ssize_t trns_sock_recv(struct trns *const t, void *buf,
+                              const size_t len) {
+    return recv(t->fd, buf, len, 0);
+}
+
+static ssize_t trns_sock_send(struct trns *const t, const void *buf,
+                              const size_t len) {
+    return send(t->fd, buf, len, MSG_NOSIGNAL);
+}
+
+static void trns_sock_shutdown(struct trns *const t) {
+    shutdown(t->fd, SHUT_RDWR);
+}
+
+static int trns_sock_nonblock(struct trns *const t) {
+    int flags = fcntl(t->fd, F_GETFL, 0);
+    if (flags < 0) {
+        return (-1);
+    }
+    return fcntl(t->fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static void trns_sock_destroy(struct trns *const t) {
+    gc_unregister_socket(t->fd);
+    delete t;
+}
+
+static ssize_t trns_lpbk_recv(struct trns *const t, void *buf,
+                              const size_t len) {
+    /* Variables */
+    struct lpbk_trns *lt = static_cast<struct lpbk_trns *>(t);
+    struct lpbk_chan *rx = lt->rx;
+    std::unique_lock<std::mutex> lock(rx->mutex);
+    uint64_t cnt;
+    size_t n;
+    /* Wait for data or EOF */
+    if (lt->nonblock) {
+        if (rx->data.empty() && (!rx->closed)) {
+            errno = EAGAIN;
+            return (-1);
+        }
+    } else {
+        rx->cv.wait(lock, [rx] { return (!rx->data.empty()) || rx->closed; });
+    }
+    if (rx->data.empty()) {
+        return 0;
+    }
+    n = std::min(len, rx->data.size());
+    memcpy(buf, rx->data.data(), n);
+    rx->data.erase(0, n);
+    /* Not readable any more */
+    if (rx->data.empty() && (!rx->closed)) {
+        if (read(rx->evfd, &cnt, sizeof(cnt)) < 0) {
+            cnt = 0;
+        }
+    }
+    return static_cast<ssize_t>(n);
+}
+
+static ssize_t trns_lpbk_send(struct trns *const t, const void *buf,
+                              const size_t len) {
+    /* Variables */
+    struct lpbk_chan *tx = static_cast<struct lpbk_trns *>(t)->tx;
+    std::lock_guard<std::mutex> lock(tx->mutex);
+    /* Peer is gone */
+    if (tx->closed) {
+        errno = EPIPE;
+        return (-1);
+    }
+    try {
+        tx->data.append(static_cast<const char *>(buf), len);
+    } catch (const std::bad_alloc& e) {
+        errno = ENOMEM;
+        return (-1);
+    }
+    trns_lpbk_signal(tx);
+    tx->cv.notify_one();
+    return static_cast<ssize_t>(len);
+}
+
+static void trns_lpbk_shutdown(struct trns *const t) {
+    struct lpbk_trns *lt = static_cast<struct lpbk_trns *>(t);
+    trns_lpbk_close_chan(lt->rx);
+    trns_lpbk_close_chan(lt->tx);
+}
+
+static int trns_lpbk_nonblock(struct trns *const t) {
+    static_cast<struct lpbk_trns *>(t)->nonblock = true;
+    return 0;
+}
+
+static void trns_lpbk_destroy(struct trns *const t) {
+    trns_lpbk_shutdown(t);
+    delete static_cast<struct lpbk_trns *>(t);
+}
+
+static void trns_lpbk_close_chan(struct lpbk_chan *const chan) {
+    std::lock_guard<std::mutex> lock(chan->mutex);
+    chan->closed = true;
+    trns_lpbk_signal(chan);
+    chan->cv.notify_all();
+}
+
+static void trns_lpbk_signal(struct lpbk_chan *const chan) {
+    const uint64_t one = 1;
+    if (write(chan->evfd, &one, sizeof(one)) < 0) {
+        /* Counter is already non-zero (readable) */
+    }
+}
@@ -0,0 +1,136 @@
+/**
+ * @file trns.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Pluggable session transports (socket, in-memory loopback).
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef TRNS_HPP
+#define TRNS_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "policy.hpp"
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct trns;
+
+/**
+ * @brief Transport operations table.
+ *
+ * Every transport implementation provides the same set of operations,
+ * so the session code never needs to know what is below it.
+ * Semantics follow recv(2)/send(2): >0 bytes, 0 end of stream, -1 error.
+ */
+struct trns_ops {
+    ssize_t (*recv)(struct trns *const t, void *buf, const size_t len);
+    ssize_t (*send)(struct trns *const t, const void *buf, const size_t len);
+    void (*shutdown)(struct trns *const t); /**< Wake up blocked recv() */
+    int (*nonblock)(struct trns *const t); /**< recv/send return EAGAIN */
+    void (*destroy)(struct trns *const t); /**< Close and free */
+    int (*interest)(struct trns *const t,
+                    const uint32_t events); /**< Virtual transports (fd < 0,
+                                                 no readiness backend): IO_*
+                                                 interest after every flush */
+};
+
+/**
+ * @brief Transport handle (one end of a connection).
+ */
+struct trns {
+    const struct trns_ops *ops; /**< Operations of the implementation */
+    int fd; /**< Pollable descriptor (readable when recv won't block),
+                 -1 for virtual transports */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Wraps an accepted client socket into a transport.
+ *
+ * The socket is registered in the garbage collector and is closed
+ * when the transport is destroyed.
+ *
+ * @param socket Connected socket descriptor.
+ * @return struct trns* Transport on success, or NULL on failure.
+ */
+struct trns *trns_socket_create(const int socket);
+
+/**
+ * @brief Creates an in-memory loopback connection.
+ *
+ * Both ends behave like a connected stream socket, but bytes are moved
+ * between two in-process queues and never touch the network stack.
+ * The descriptor of each end is an eventfd that is readable while data
+ * (or end of stream) is pending. Sending never blocks.
+ * Requires the trns_dynamic transport policy.
+ *
+ * @param srvend Receives the server end of the connection.
+ * @param clntend Receives the client end of the connection.
+ * @return int 0 on success, or -1 on failure (always with trns_static,
+ * errno ENOTSUP).
+ */
+int trns_loopback_pair(struct trns **const srvend,
+                       struct trns **const clntend);
+
+/**
+ * @brief Receives bytes from a transport.
+ */
+static inline ssize_t trns_recv(struct trns *const t,
+                                void *buf, const size_t len) {
+    if constexpr (tlnt_policy::trns::dynamic) {
+        return t->ops->recv(t, buf, len);
+    } else {
+        return recv(t->fd, buf, len, 0);
+    }
+}
+
+/**
+ * @brief Sends bytes over a transport.
+ */
+static inline ssize_t trns_send(struct trns *const t,
+                                const void *buf, const size_t len) {
+    if constexpr (tlnt_policy::trns::dynamic) {
+        return t->ops->send(t, buf, len);
+    } else {
+        return send(t->fd, buf, len, MSG_NOSIGNAL);
+    }
+}
+
+/**
+ * @brief Shuts a transport down, blocked receivers return 0.
+ */
+static inline void trns_shutdown(struct trns *const t) {
+    t->ops->shutdown(t);
+}
+
+/**
+ * @brief Switches a transport to non-blocking mode (reactor use).
+ *
+ * @return int 0 on success, or -1 on failure.
+ */
+static inline int trns_nonblock(struct trns *const t) {
+    return t->ops->nonblock(t);
+}
+
+/**
+ * @brief Closes a transport and releases its memory.
+ */
+static inline void trns_destroy(struct trns *const t) {
+    t->ops->destroy(t);
+}
+
+#endif /* TRNS_HPP */
@@ -0,0 +1,113 @@
+/**
+ * @file wrk.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Worker thread pool, completions go back to a reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <system_error>
+#include "wrk.hpp"
+#include "rctr.hpp"
+#include "prof.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief Worker thread: runs jobs until the pool stops and drains.
+ *
+ * @param p The pool.
+ */
+static void wrk_loop(struct wrk_pool *const p);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int wrk_start(struct wrk_pool *const p, unsigned n) {
+    /* Variables */
+    if (n == 0) {
+        n = std::thread::hardware_concurrency();
+        n = (n > 0) ? n : 1;
+    }
+    p->stop = false;
+    /* Workers */
+    try {
+        for (unsigned i = 0; i < n; ++i) {
+            p->threads.emplace_back(wrk_loop, p);
+        }
+    } catch (const std::exception& e) {
+        log_error("Error: worker thread");
+        wrk_stop(p);
+        return (-1);
+    }
+    return 0;
+}
+
+void wrk_stop(struct wrk_pool *const p) {
+    {
+        std::lock_guard<std::mutex> lock(p->mutex);
+        p->stop = true;
+    }
+    p->cv.notify_all();
+    for (std::thread &t : p->threads) {
+        t.join();
+    }
+    p->threads.clear();
+}
+
+int wrk_submit(struct wrk_pool *const p, struct wrk_job *const j) {
+    {
+        std::lock_guard<std::mutex> lock(p->mutex);
+        if (p->stop) {
+            return (-1);
+        }
+        j->next = NULL;
+        if (p->tail != NULL) {
+            p->tail->next = j;
+        } else {
+            p->head = j;
+        }
+        p->tail = j;
+    }
+    p->cv.notify_one();
+    return 0;
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static void wrk_loop(struct wrk_pool *const p) {
+    /* Variables */
+    struct wrk_job *j;
+    /* Run until stopped and drained */
+    if constexpr (tlnt_policy::feat::prof) {
+        prof_thread_enter("wrk");
+    }
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(p->mutex);
+            p->cv.wait(lock, [p] { return p->stop || (p->head != NULL); });
+            j = p->head;
+            if (j == NULL) {
+                break;
+            }
+            p->head = j->next;
+            if (p->head == NULL) {
+                p->tail = NULL;
+            }
+        }
+        j->run(j);
+        rctr_post(j->rctr, j);
+    }
+    if constexpr (tlnt_policy::feat::prof) {
+        prof_thread_leave();
+    }
+}
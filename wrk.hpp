@@ -0,0 +1,91 @@
+/**
+ * @file wrk.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief Worker thread pool, completions go back to a reactor.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef WRK_HPP
+#define WRK_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "mbox.hpp"
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct rctr;
+struct wrk_job;
+
+/**
+ * @brief Job callback.
+ */
+typedef void (*wrk_fn)(struct wrk_job *const j);
+
+/**
+ * @brief Job, embedded (as a base) into the request it belongs to.
+ *
+ * Without run it is a message to a reactor (rctr_post()): done runs on
+ * the reactor thread, e.g. an operation on one of its sessions.
+ */
+struct wrk_job : public mbox_msg {
+    struct wrk_job *next; /**< Queue link */
+    wrk_fn run; /**< Runs on a worker thread */
+    wrk_fn done; /**< Runs afterwards on the thread of rctr */
+    struct rctr *rctr; /**< Reactor receiving the completion */
+};
+
+/**
+ * @brief Worker pool (FIFO queue shared by all workers).
+ */
+struct wrk_pool {
+    std::mutex mutex; /**< Protects the queue and stop */
+    std::condition_variable cv; /**< Signals queued jobs and stop */
+    struct wrk_job *head = NULL; /**< Queue */
+    struct wrk_job *tail = NULL;
+    bool stop = false; /**< No new jobs, leave when the queue is empty */
+    std::vector<std::thread> threads; /**< Workers */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Starts the workers.
+ *
+ * @param p The pool.
+ * @param n Number of workers (0 - one per CPU).
+ * @return int 0 on success, or -1 on failure.
+ */
+int wrk_start(struct wrk_pool *const p, unsigned n);
+
+/**
+ * @brief Runs the queued jobs to the end and stops the workers.
+ *
+ * Completions are posted to their reactors, which must still run.
+ *
+ * @param p The pool.
+ */
+void wrk_stop(struct wrk_pool *const p);
+
+/**
+ * @brief Queues a job (any thread).
+ *
+ * @param p The pool.
+ * @param j The job (run, done and rctr set).
+ * @return int 0 on success, or -1 if the pool is stopping.
+ */
+int wrk_submit(struct wrk_pool *const p, struct wrk_job *const j);
+
+#endif /* WRK_HPP */
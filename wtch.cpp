@@ -0,0 +1,302 @@
+/**
+ * @file wtch.cpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief "watch": a command re-run on a session timer, the terminal gets
+ * only the lines that changed since the previous screen.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+//==============================================================================
+// Includes
+//==============================================================================
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "wtch.hpp"
+#include "rctr.hpp"
+#include "sess.hpp"
+#include "srv.hpp"
+
+//==============================================================================
+// Static Function Declarations
+//==============================================================================
+/**
+ * @brief "watch <seconds> <command>" - re-runs a command until a key is
+ * pressed.
+ *
+ * @param call Call context.
+ * @return int 0 on success, or -1 on a wrong argument.
+ */
+static int wtch_cmd(struct cmd_call *const call);
+
+/**
+ * @brief Timer callback: runs the command and sends the changes.
+ *
+ * @param t The timer of a watch.
+ */
+static void wtch_tick(struct tmr *const t);
+
+/**
+ * @brief Lays out a screen: a header, a blank line and as much of the
+ * output as fits, lines cut at the terminal width.
+ *
+ * @param w The watch.
+ * @param out Command output.
+ * @param cols Terminal width.
+ * @param rows Terminal height.
+ * @param lines Receives the lines.
+ */
+static void wtch_layout(const struct wtch *const w, const std::string_view out,
+                        const uint16_t cols, const uint16_t rows,
+                        std::vector<std::string> *const lines);
+
+/**
+ * @brief Escape sequences turning the screen the terminal shows into the
+ * new one: changed tails of changed lines only (everything after a size
+ * change).
+ *
+ * @param w The watch (its screen is replaced by lines).
+ * @param lines New screen.
+ * @param cols Terminal width.
+ * @param rows Terminal height.
+ * @param frame Receives the sequences (empty - nothing changed).
+ */
+static void wtch_diff(struct wtch *const w,
+                      std::vector<std::string> *const lines,
+                      const uint16_t cols, const uint16_t rows,
+                      std::string *const frame);
+
+/**
+ * @brief Appends a cursor move (1-based row and column).
+ */
+static void wtch_goto(std::string *const frame, const size_t row,
+                      const size_t col);
+
+//==============================================================================
+// Global Function Definitions
+//==============================================================================
+int wtch_register(struct srv *const srv) {
+    return srv_cmd_register(srv, "watch", wtch_cmd, NULL,
+                            "Re-run a command every N seconds, any key"
+                            " stops (watch N command)");
+}
+
+int wtch_key(struct sess *const s, const char key) {
+    /* Variables */
+    std::string frame;
+    /* Leftovers of Enter */
+    if ((key == '\n') || (key == '\0')) {
+        return 0;
+    }
+    /* The last screen stays, the prompt goes below it */
+    try {
+        if (!s->watch->screen.empty()) {
+            wtch_goto(&frame, s->watch->screen.size() + 1, 1);
+            frame.append("\033[J");
+        }
+    } catch (const std::bad_alloc& e) {
+        return (-1);
+    }
+    wtch_stop(s);
+    return (sess_write(s, frame) < 0) ? (-1) : 1;
+}
+
+void wtch_stop(struct sess *const s) {
+    if (s->watch == NULL) {
+        return;
+    }
+    tmr_cancel(&s->rctr->wheel, &s->watch->tmr);
+    s->watch.reset();
+}
+
+//==============================================================================
+// Static Function Definitions
+//==============================================================================
+static int wtch_cmd(struct cmd_call *const call) {
+    /* Variables */
+    struct sess *s = call->sess;
+    std::string arg;
+    std::string_view cmd;
+    char *end;
+    double sec;
+    struct wtch *w;
+    /* Arguments */
+    if (call->argv.size() < 3) {
+        call->out->append("Usage: watch <seconds> <command>\r\n");
+        return (-1);
+    }
+    arg.assign(call->argv[1]);
+    sec = strtod(arg.c_str(), &end);
+    if ((*end != '\0') || !(sec * 1000 >= WTCH_PERIOD_MIN) ||
+        !(sec * 1000 <= WTCH_PERIOD_MAX)) {
+        call->out->append("Error: interval is 0.1 to 86400 seconds\r\n");
+        return (-1);
+    }
+    if ((call->argv[2] == "watch") || (call->argv[2] == "batch")) {
+        call->out->append("Error: cannot watch " +
+                          std::string(call->argv[2]) + "\r\n");
+        return (-1);
+    }
+    /* Terminals only: the screen is redrawn from the reactor timer */
+    if ((s == NULL) || (s->mode != SESS_TEXT)) {
+        call->out->append("Error: watch needs a terminal session\r\n");
+        return (-1);
+    }
+    if (s->watch != NULL) {
+        call->out->append("Error: already watching\r\n"); /* Scripts */
+        return (-1);
+    }
+    /* The rest of the line, as typed (words are views into it) */
+    cmd = std::string_view(call->argv[2].data(),
+                           static_cast<size_t>(call->argv.back().data() +
+                                               call->argv.back().size() -
+                                               call->argv[2].data()));
+    w = new (std::nothrow) struct wtch;
+    if (w == NULL) {
+        return (-1);
+    }
+    s->watch.reset(w);
+    w->cmd.assign(cmd);
+    w->period = static_cast<uint64_t>(sec * 1000);
+    w->tmr.cb = wtch_tick;
+    w->tmr.arg = s;
+    w->cols = 0;
+    w->rows = 0;
+    /* The first screen on the next tick, the parser waits for a key */
+    tmr_arm(&s->rctr->wheel, &w->tmr, 0);
+    return 0;
+}
+
+static void wtch_tick(struct tmr *const t) {
+    /* Variables */
+    struct sess *s = static_cast<struct sess *>(t->arg);
+    struct wtch *w = s->watch.get();
+    const uint16_t cols = (s->cols > 0) ? s->cols : WTCH_COLS;
+    const uint16_t rows = (s->rows > 0) ? s->rows : WTCH_ROWS;
+    std::vector<std::string> lines;
+    std::string out;
+    std::string frame;
+    uint64_t start;
+    int result;
+    /* Next run first: a failing flush below frees the watch */
+    tmr_arm(&s->rctr->wheel, &w->tmr, w->period);
+    /* A client still busy with the last screen skips this one */
+    if (sess_queued(s) > 0) {
+        return;
+    }
+    start = acct_ticks();
+    result = srv_exec(s->srv, s, w->cmd, &out, NULL);
+    rctr_sess_account(s, acct_ticks() - start, 0, 0);
+    if (result > 0) {
+        rctr_sess_close(s);
+        return;
+    }
+    try {
+        wtch_layout(w, out, cols, rows, &lines);
+        wtch_diff(w, &lines, cols, rows, &frame);
+    } catch (const std::bad_alloc& e) {
+        rctr_sess_close(s);
+        return;
+    }
+    if (frame.empty()) {
+        return;
+    }
+    if (sess_text(s, frame) < 0) {
+        rctr_sess_close(s);
+        return;
+    }
+    /* Channel output lands in the queue of its connection */
+    if ((rctr_sess_flush(s) == 0) && (s->parent != NULL)) {
+        rctr_sess_flush(s->parent);
+    }
+}
+
+static void wtch_layout(const struct wtch *const w, const std::string_view out,
+                        const uint16_t cols, const uint16_t rows,
+                        std::vector<std::string> *const lines) {
+    /* Variables */
+    std::string head = "Every " + std::to_string(w->period / 1000);
+    size_t pos = 0;
+    size_t end;
+    size_t len;
+    /* Header (the interval without trailing zeros) */
+    if ((w->period % 1000) != 0) {
+        std::string frac = std::to_string(1000 + (w->period % 1000));
+        frac.erase(frac.find_last_not_of('0') + 1);
+        head.append(".").append(frac, 1);
+    }
+    head.append("s: ").append(w->cmd);
+    lines->push_back(head.substr(0, cols));
+    lines->emplace_back();
+    /* Output lines, the last row stays free (no scrolling) */
+    while ((pos < out.size()) && (lines->size() + 1 < rows)) {
+        end = out.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = out.size();
+        }
+        len = end - pos;
+        if ((len > 0) && (out[pos + len - 1] == '\r')) {
+            --len;
+        }
+        lines->emplace_back(out.substr(pos, std::min<size_t>(len, cols)));
+        pos = end + 1;
+    }
+}
+
+static void wtch_diff(struct wtch *const w,
+                      std::vector<std::string> *const lines,
+                      const uint16_t cols, const uint16_t rows,
+                      std::string *const frame) {
+    /* Variables */
+    const std::vector<std::string> &old = w->screen;
+    const size_t n = std::max(old.size(), lines->size());
+    size_t same;
+    /* New size - the whole screen */
+    if ((cols != w->cols) || (rows != w->rows)) {
+        frame->append("\033[H\033[2J");
+        for (size_t i = 0; i < lines->size(); ++i) {
+            frame->append((i > 0) ? "\r\n" : "").append((*lines)[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            const std::string_view prev = (i < old.size()) ?
+                                          std::string_view(old[i]) : "";
+            const std::string_view next = (i < lines->size()) ?
+                                          std::string_view((*lines)[i]) : "";
+            if (prev == next) {
+                continue;
+            }
+            /* From the first differing column, the rest is erased if the
+             * line got shorter */
+            same = static_cast<size_t>(
+                std::mismatch(prev.begin(), prev.end(), next.begin(),
+                              next.end()).first - prev.begin());
+            wtch_goto(frame, i + 1, same + 1);
+            frame->append(next.substr(same));
+            if (prev.size() > next.size()) {
+                frame->append("\033[K");
+            }
+        }
+    }
+    /* The cursor rests below the screen */
+    if (!frame->empty()) {
+        wtch_goto(frame, lines->size() + 1, 1);
+    }
+    w->screen.swap(*lines);
+    w->cols = cols;
+    w->rows = rows;
+}
+
+static void wtch_goto(std::string *const frame, const size_t row,
+                      const size_t col) {
+    frame->append("\033[").append(std::to_string(row));
+    if (col > 1) {
+        frame->append(";").append(std::to_string(col));
+    }
+    frame->push_back('H');
+}
@@ -0,0 +1,79 @@
+/**
+ * @file wtch.hpp
+ * @author Konstantin Kamyshanov (kkamyshanov)
+ * @brief "watch": a command re-run on a session timer, the terminal gets
+ * only the lines that changed since the previous screen.
+ * @version 0.1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ * @license GPL-3.0-or-later
+ *
+ */
+
+#ifndef WTCH_HPP
+#define WTCH_HPP
+
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "tmr.hpp"
+
+//=============================================================================
+// Definitions
+//=============================================================================
+constexpr uint64_t WTCH_PERIOD_MIN = 100; /**< Shortest interval, ms */
+constexpr uint64_t WTCH_PERIOD_MAX = 24 * 3600 * 1000; /**< Longest, ms */
+constexpr uint16_t WTCH_COLS = 80; /**< Screen of a terminal without NAWS */
+constexpr uint16_t WTCH_ROWS = 24;
+
+//=============================================================================
+// Structures
+//=============================================================================
+struct srv;
+struct sess;
+
+/**
+ * @brief Watched command of a session (sess::watch, set while watching).
+ */
+struct wtch {
+    std::string cmd; /**< Command line re-run */
+    uint64_t period; /**< Interval, ms */
+    struct tmr tmr; /**< Next run (reactor wheel) */
+    std::vector<std::string> screen; /**< Lines the terminal shows now */
+    uint16_t cols; /**< Terminal size the screen was drawn for, */
+    uint16_t rows; /**< 0 - nothing drawn yet */
+};
+
+//=============================================================================
+// Global Function Declarations
+//=============================================================================
+/**
+ * @brief Registers the "watch" command.
+ *
+ * @param srv The server.
+ * @return int 0 on success, or -1 on failure.
+ */
+int wtch_register(struct srv *const srv);
+
+/**
+ * @brief Handles a key pressed while watching: any key but the '\n' or
+ * '\0' following Enter stops, the cursor goes below the last screen.
+ *
+ * @param s The session (watching).
+ * @param key The key.
+ * @return int 0 - still watching, 1 - stopped, -1 - error.
+ */
+int wtch_key(struct sess *const s, const char key);
+
+/**
+ * @brief Stops watching (no-op if the session does not watch).
+ *
+ * @param s The session.
+ */
+void wtch_stop(struct sess *const s);
+
+#endif /* WTCH_HPP */